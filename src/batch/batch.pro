@@ -0,0 +1,16 @@
+TEMPLATE = lib
+
+CONFIG = staticlib c++11 thread
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+	../snapshot \
+
+SOURCES += \
+	batch_config.cpp \
+
+HEADERS += \
+	batch_config.h \
+
+include(../cernjunior.pri)
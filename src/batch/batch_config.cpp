@@ -0,0 +1,515 @@
+#include <algorithm> // for min
+#include <cmath> // for isfinite
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <memory>
+
+#include "batch_config.h"
+
+#include "../physics/accelerator.h"
+#include "../physics/beam.h"
+#include "../snapshot/acceleratorwidgetsnapshot.h"
+#include "../misc/exceptions.h"
+
+using namespace std;
+
+void ElementSpec::build(Accelerator &w) const{
+	const Vector3D stop(has_end ? end : w.getOrigin());
+	switch(kind){
+		case STRAIGHT: w.addStraightSection(radius, stop); break;
+		case DIPOLE: w.addDipole(radius, curvature, B_0, stop); break;
+		case QUADRUPOLE: w.addQuadrupole(radius, b, stop); break;
+		case CAVITY: w.addRadiofrequencyCavity(radius, E_0, omega, kappa, phi, stop); break;
+		case FODO: w.addFodoCell(radius, b, L, stop); break;
+		case POLYGON: w.buildPolygon(end, n, major_radius, radius, b, B_0); break;
+		case DEFAULT_LATTICE: cernjunior::build_default_accelerator(w); break;
+	}
+}
+
+std::unique_ptr<Particle> BeamSpec::model(void) const{
+	return concrete_particle(single ? position : Vector3D(), energy, direction, particle);
+}
+
+void BeamSpec::build(Accelerator &w) const{
+	const std::unique_ptr<Particle> p(model());
+
+	if(single) w.addParticle(*p);
+	else if(distribution == 'u') w.addUniformCircularBeam(*p, N, lambda, position_spread, velocity_spread);
+	else w.addGaussianCircularBeam(*p, N, lambda, position_spread, velocity_spread);
+}
+
+void BatchConfig::build(Accelerator &w) const{
+	if(has_seed) w.setSeed(seed);
+	for(const auto &e : lattice) e.build(w);
+	for(const auto &b : beams) b.build(w);
+	w.setSpace_charge(space_charge);
+	w.setSpace_charge_precision(space_charge_precision);
+	w.setBarnes_hut_theta(barnes_hut_theta);
+	fastmath::select(math); // for the whole program, which runs one configuration at a time
+	w.setBlock_timesteps(block_levels, max_deflection);
+}
+
+void BatchConfig::track_turn(Accelerator &w) const{
+	if(engine == CURVILINEAR) w.integrate(w.element_count(), steps_per_element);
+	else w.track(w.element_count());
+}
+
+std::string SweepAxis::name(Parameter p){
+	switch(p){
+		case QUADRUPOLE_B: return "b";
+		case DIPOLE_B_0: return "B_0";
+		case CAVITY_PHASE: return "phase";
+	}
+	return "";
+}
+
+void SweepAxis::apply(std::vector<ElementSpec> &lattice, double value) const{
+	for(auto &e : lattice){
+		switch(parameter){
+			case QUADRUPOLE_B:
+				if(e.kind == ElementSpec::QUADRUPOLE or e.kind == ElementSpec::FODO or e.kind == ElementSpec::POLYGON){
+					e.b = e.b < 0 ? -value : value;
+				}
+				break;
+			case DIPOLE_B_0:
+				if(e.kind == ElementSpec::DIPOLE or e.kind == ElementSpec::POLYGON){
+					e.B_0 = e.B_0 < 0 ? -value : value;
+				}
+				break;
+			case CAVITY_PHASE:
+				if(e.kind == ElementSpec::CAVITY) e.phi = value;
+				break;
+		}
+	}
+}
+
+namespace{
+	class LineParser{
+		// reads the arguments of a command, reporting errors with the line number
+		private:
+			istringstream tokens;
+			const int line;
+		public:
+			LineParser(const string &text, int my_line) : tokens(text), line(my_line){}
+
+			[[noreturn]] void error(const string &message) const{
+				throw invalid_argument("line " + to_string(line) + ": " + message);
+			}
+
+			bool done(void){
+				tokens >> ws;
+				return tokens.eof();
+			}
+
+			string word(void){
+				string w;
+				if(not (tokens >> w)) error("missing argument");
+				return w;
+			}
+
+			double number(void){
+				double x;
+				if(not (tokens >> x)) error("expected a number");
+				return x;
+			}
+
+			long integer(void){
+				long n;
+				if(not (tokens >> n)) error("expected an integer");
+				return n;
+			}
+
+			// an integer stored in an unsigned int, at least min
+			unsigned int count(long min, const string &what){
+				const long n(integer());
+				if(n < min or n > long(numeric_limits<unsigned int>::max())){
+					error(what + " must be between " + to_string(min) + " and " + to_string(numeric_limits<unsigned int>::max()));
+				}
+				return n;
+			}
+
+			Vector3D point(void){
+				const double x(number());
+				const double y(number());
+				const double z(number());
+				return Vector3D(x, y, z);
+			}
+
+			void optional_end(ElementSpec &e){
+				e.has_end = not done();
+				if(e.has_end) e.end = point();
+			}
+
+			char particle_code(void){
+				const string code(word());
+				try{
+					return species::get(species::find(code)).code;
+				}catch(std::exception&){
+					error("unknown particle type '" + code + "'");
+				}
+			}
+
+			bool on_off(void){
+				const string value(word());
+				if(value != "on" and value != "off") error("expected 'on' or 'off'");
+				return value == "on";
+			}
+
+			void finish(void){
+				if(not done()) error("unexpected argument '" + word() + "'");
+			}
+	};
+}
+
+BatchConfig read_batch_config(istream &input){
+	BatchConfig config;
+
+	string text;
+	for(int line(1); getline(input, text); ++line){
+		text = text.substr(0, text.find('#'));
+		LineParser args(text, line);
+		if(args.done()) continue;
+
+		const string command(args.word());
+
+		if(command == "origin"){
+			config.origin = args.point();
+		}else if(command == "straight"){
+			ElementSpec e(ElementSpec::STRAIGHT);
+			e.radius = args.number();
+			args.optional_end(e);
+			config.lattice.push_back(e);
+		}else if(command == "dipole"){
+			ElementSpec e(ElementSpec::DIPOLE);
+			e.radius = args.number();
+			e.curvature = args.number();
+			e.B_0 = args.number();
+			args.optional_end(e);
+			config.lattice.push_back(e);
+		}else if(command == "quadrupole"){
+			ElementSpec e(ElementSpec::QUADRUPOLE);
+			e.radius = args.number();
+			e.b = args.number();
+			args.optional_end(e);
+			config.lattice.push_back(e);
+		}else if(command == "cavity"){
+			ElementSpec e(ElementSpec::CAVITY);
+			e.radius = args.number();
+			e.E_0 = args.number();
+			e.omega = args.number();
+			e.kappa = args.number();
+			e.phi = args.number();
+			args.optional_end(e);
+			config.lattice.push_back(e);
+		}else if(command == "fodo"){
+			ElementSpec e(ElementSpec::FODO);
+			e.radius = args.number();
+			e.b = args.number();
+			e.L = args.number();
+			args.optional_end(e);
+			config.lattice.push_back(e);
+		}else if(command == "polygon"){
+			ElementSpec e(ElementSpec::POLYGON);
+			e.end = args.point();
+			e.n = args.count(1, "the number of sides of a polygon");
+			e.major_radius = args.number();
+			e.radius = args.number();
+			e.b = args.number();
+			e.B_0 = args.number();
+			config.lattice.push_back(e);
+		}else if(command == "default_lattice"){
+			config.lattice.push_back(ElementSpec(ElementSpec::DEFAULT_LATTICE));
+		}else if(command == "beam"){
+			BeamSpec b;
+			const string distribution(args.word());
+			if(distribution != "gaussian" and distribution != "uniform") args.error("unknown distribution '" + distribution + "'");
+			b.distribution = distribution[0];
+			b.particle = args.particle_code();
+			b.N = args.count(0, "the number of particles");
+			b.lambda = args.number();
+			b.position_spread = args.number();
+			b.velocity_spread = args.number();
+			if(not args.done()) b.energy = args.number();
+			config.beams.push_back(b);
+		}else if(command == "particle"){
+			BeamSpec b;
+			b.single = true;
+			b.particle = args.particle_code();
+			b.position = args.point();
+			b.energy = args.number();
+			b.direction = args.point();
+			config.beams.push_back(b);
+		}else if(command == "timestep"){
+			config.dt = args.number();
+			if(config.dt <= 0) args.error("the timestep must be positive");
+		}else if(command == "steps"){
+			config.steps = args.integer();
+			if(config.steps < -1) args.error("the number of steps must be positive, or -1 to run until the accelerator is empty");
+		}else if(command == "space_charge"){
+			config.space_charge = args.on_off();
+			if(not args.done()){
+				const string precision(args.word());
+				if(precision != "single" and precision != "double") args.error("expected 'single' or 'double'");
+				config.space_charge_precision = precision == "single" ? Precision::SINGLE : Precision::DOUBLE;
+			}
+		}else if(command == "barnes_hut"){
+			config.barnes_hut_theta = args.number();
+			if(not (config.barnes_hut_theta >= 0.0)) args.error("the opening angle must be positive or zero");
+		}else if(command == "math"){
+			const string kernel(args.word());
+			try{
+				config.math = fastmath::find(kernel);
+			}catch(const invalid_argument&){
+				args.error("unknown math kernel '" + kernel + "'");
+			}
+			if(not fastmath::supported(config.math)) args.error("the " + kernel + " math kernel is not supported by this processor");
+		}else if(command == "block_timesteps"){
+			const long n(args.integer());
+			if(n < 0 or n > long(simcst::MAX_BLOCK_LEVELS)) args.error("the number of levels must be between 0 and " + to_string(simcst::MAX_BLOCK_LEVELS));
+			config.block_levels = n;
+			if(not args.done()){
+				config.max_deflection = args.number();
+				if(config.max_deflection <= 0) args.error("the maximum deflection must be positive");
+			}
+		}else if(command == "seed"){
+			const long seed(args.integer());
+			if(seed < 0) args.error("the seed must be positive");
+			config.has_seed = true;
+			config.seed = seed;
+		}else if(command == "engine"){
+			const string engine(args.word());
+			if(engine == "timestep") config.engine = BatchConfig::TIMESTEP;
+			else if(engine == "linear") config.engine = BatchConfig::LINEAR;
+			else if(engine == "analytic") config.engine = BatchConfig::ANALYTIC;
+			else if(engine == "curvilinear"){
+				config.engine = BatchConfig::CURVILINEAR;
+				if(not args.done()){
+					config.steps_per_element = args.count(1, "the number of steps per element");
+				}
+			}
+			else args.error("unknown engine '" + engine + "'");
+		}else if(command == "turns"){
+			const long n(args.integer());
+			if(n < 0) args.error("negative number of turns");
+			config.turns = n;
+		}else if(command == "sweep"){
+			SweepAxis axis;
+			const string parameter(args.word());
+			if(parameter == "b") axis.parameter = SweepAxis::QUADRUPOLE_B;
+			else if(parameter == "B_0") axis.parameter = SweepAxis::DIPOLE_B_0;
+			else if(parameter == "phase") axis.parameter = SweepAxis::CAVITY_PHASE;
+			else args.error("cannot sweep over '" + parameter + "'");
+			do{
+				axis.values.push_back(args.number());
+			}while(not args.done());
+			config.sweeps.push_back(axis);
+		}else if(command == "repeat"){
+			config.repeats = args.count(1, "the number of repetitions");
+		}else if(command == "threads"){
+			config.threads = args.count(0, "the number of threads");
+		}else if(command == "table"){
+			config.table = args.word();
+		}else if(command == "trace"){
+			config.trace = args.word();
+			if(not args.done()){
+				const long n(args.integer());
+				if(n < 1) args.error("a trace keeps at least one event per thread");
+				config.trace_events = n;
+			}
+		}else if(command == "output"){
+			config.output.path = args.word();
+			while(not args.done()){
+				const string option(args.word());
+				if(option == "every"){
+					config.output.step_decimation = args.count(1, "the step decimation");
+				}else if(option == "particles"){
+					config.output.particle_decimation = args.count(1, "the particle decimation");
+				}else if(option == "float32"){
+					config.output.float32 = true;
+				}else if(option == "drop"){
+					config.output.overflow = snapshot::Overflow::DROP;
+				}else if(option == "wait"){
+					config.output.overflow = snapshot::Overflow::WAIT;
+				}else if(option == "compress"){
+					config.output.compress = true;
+					const double position_error(args.number());
+					if(not (position_error > 0.0 and std::isfinite(position_error))) args.error("the position error bound must be positive and finite");
+					const double velocity_error(args.number());
+					if(not (velocity_error > 0.0 and std::isfinite(velocity_error))) args.error("the velocity error bound must be positive and finite");
+					config.output.compression = snapshot::Compression(position_error, velocity_error);
+				}else{
+					args.error("unknown output option '" + option + "'");
+				}
+			}
+		}else if(command == "summary"){
+			if(args.word() != "every") args.error("expected 'summary every n'");
+			config.output.summary_interval = args.count(0, "the summary interval");
+		}else if(command == "trees"){
+			if(args.word() != "every") args.error("expected 'trees every n'");
+			config.output.tree_interval = args.count(0, "the tree statistics interval");
+		}else{
+			args.error("unknown command '" + command + "'");
+		}
+
+		args.finish();
+	}
+
+	if(config.engine == BatchConfig::LINEAR){
+		for(const auto &axis : config.sweeps){
+			if(axis.parameter == SweepAxis::DIPOLE_B_0){
+				throw invalid_argument("sweeping B_0 has no effect with the linear engine, whose dipoles are matched to the reference particle");
+			}
+		}
+	}
+
+	return config;
+}
+
+BatchConfig read_batch_config(const string &path){
+	ifstream file(path);
+	if(not file) throw invalid_argument("could not open '" + path + "'");
+	return read_batch_config(file);
+}
+
+namespace{
+	void print_summary(const Accelerator &w, ostream &log){
+		double energy(0.0);
+		for(size_t i(0); i < w.particle_count(); ++i) energy += w.getParticle(i).getEnergy();
+		if(w.particle_count()) energy /= w.particle_count();
+
+		log << "  particles " << w.particle_count()
+		    << "  mean energy (GeV) " << 1e-9/phcst::E_USI*energy << "\n";
+	}
+
+	void print_trees(const TreeStatistics &s, ostream &log){
+		log << "  nodes " << s.nodes() << "  max depth " << s.max_depth() << "  occupancy " << s.occupancy()
+		    << "  imbalance " << s.imbalance() << "  outside " << s.particles - min(s.particles, s.leaves)
+		    << "  opened per particle " << s.opened_per_particle << "\n";
+	}
+}
+
+namespace{
+	size_t run_linear(const BatchConfig &config, ostream &log){
+		if(not config.output.path.empty()) throw invalid_argument("snapshot output is not available with the linear engine");
+
+		Accelerator w(nullptr, config.origin);
+		config.build(w);
+		w.initialize();
+
+		const ReferenceParticle reference(reference_particle(config));
+		const LinearOptics optics(w, reference);
+
+		log << "One-turn map:\n" << optics.getOne_turn_map();
+
+		const char* planes[2] = {"horizontal", "vertical"};
+		for(int plane(0); plane < 2; ++plane){
+			log << planes[plane] << ": ";
+			if(not optics.is_stable(plane)){
+				log << "unstable\n";
+				continue;
+			}
+			const Twiss t(optics.periodic_twiss(plane));
+			const double mu(optics.twiss().back()[plane].mu);
+			log << "tune " << mu/(2.0*M_PI) << "  beta " << t.beta << " m  alpha " << t.alpha << "\n";
+		}
+
+		if(optics.is_stable(0) and optics.is_stable(1)){
+			const std::vector<std::array<Twiss,2>> twiss(optics.twiss());
+			log << "element\ts\tbeta_x\tbeta_y\n";
+			double s(0.0);
+			for(size_t i(0); i < w.element_count(); ++i){
+				log << i << "\t" << s << "\t" << twiss[i][0].beta << "\t" << twiss[i][1].beta << "\n";
+				s += w.getElement(i).getLength();
+			}
+		}
+
+		std::vector<PhaseSpaceVector> X;
+		X.reserve(w.particle_count());
+		for(size_t i(0); i < w.particle_count(); ++i) X.push_back(LinearOptics::phase_coordinates(w.getParticle(i), reference));
+
+		const std::array<double,2> initial(LinearOptics::rms_emittances(X));
+		optics.track(X, config.turns);
+		const std::array<double,2> final(LinearOptics::rms_emittances(X));
+
+		log << "Tracked " << X.size() << " particles for " << config.turns << " turns\n"
+		    << "rms emittances (m.rad): " << initial[0] << " " << initial[1] << " -> " << final[0] << " " << final[1] << "\n";
+
+		return X.size();
+	}
+}
+
+ReferenceParticle reference_particle(const BatchConfig &config){
+	if(config.beams.empty()) throw invalid_argument("the linear engine takes its reference particle from a beam, but there is none");
+	return ReferenceParticle(*config.beams.front().model());
+}
+
+size_t run_batch(const BatchConfig &config, ostream &log){
+	if(config.engine == BatchConfig::LINEAR) return run_linear(config, log);
+
+	const OutputSpec &output(config.output);
+
+	if(config.is_element_wise()){
+		if(not output.path.empty()) throw invalid_argument("snapshot output is not available with the element-wise engines");
+
+		Accelerator w(nullptr, config.origin);
+		config.build(w);
+		w.initialize();
+
+		unsigned long turn(0);
+		while(turn < config.turns and not w.is_empty()){
+			config.track_turn(w);
+			++turn;
+			if(output.summary_interval and turn % output.summary_interval == 0){
+				log << "turn " << turn;
+				print_summary(w, log);
+			}
+		}
+		log << "Finished after " << turn << " turns with " << w.particle_count() << " particles\n";
+
+		return w.particle_count();
+	}
+	if(config.engine != BatchConfig::TIMESTEP) log << "Space charge is on: using the time-stepping engine\n";
+
+	std::unique_ptr<Accelerator> accelerator;
+	if(output.path.empty()){
+		accelerator.reset(new Accelerator(nullptr, config.origin)); // nothing is ever drawn
+	}else{
+		const uint32_t flags((output.float32 ? uint32_t(snapshot::FLOAT32) : 0) | (output.compress ? uint32_t(snapshot::COMPRESSED) : 0));
+		accelerator.reset(new AcceleratorWidgetSnapshot(config.origin, output.path, flags, output.step_decimation, output.particle_decimation, output.compression, output.overflow));
+	}
+	Accelerator &w(*accelerator);
+
+	config.build(w);
+	w.initialize();
+
+	for(long i(0); i != config.steps and not w.is_empty(); ++i){
+		w.evolve(config.dt);
+		if(not output.path.empty()) w.draw();
+		if(output.summary_interval and w.getStep() % output.summary_interval == 0){
+			log << "step " << w.getStep() << "  time " << w.getTime();
+			if(w.getBlock_levels()){
+				log << "  levels";
+				for(unsigned int l(0); l <= w.getBlock_levels(); ++l) log << " " << w.block_population(l);
+			}
+			print_summary(w, log);
+		}
+		if(output.tree_interval and w.getStep() % output.tree_interval == 0){
+			log << "step " << w.getStep();
+			print_trees(w.tree_statistics(), log);
+		}
+	}
+
+	if(not output.path.empty()){
+		SnapshotView &view(static_cast<AcceleratorWidgetSnapshot&>(w).getView());
+		view.close();
+		log << view.getCommitted() << " snapshots written to " << output.path;
+		if(view.getDropped()) log << " (" << view.getDropped() << " dropped while the disk was busy)";
+		if(view.getWaits()) log << " (tracking waited " << view.getWaits() << " times for the disk)";
+		log << "\n";
+	}
+	log << "Finished after " << w.getStep() << " steps with " << w.particle_count() << " particles\n";
+
+	return w.particle_count();
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <memory>
+
+#include "../vector3d/vector3d.h"
+#include "../vector3d/fast_math.h"
+#include "../misc/constants.h"
+#include "../snapshot/snapshot.h" // for Compression and Overflow
+#include "../physics/transfer_map.h"
+#include "../physics/trace.h"
+
+class Accelerator;
+class Particle;
+
+/*
+ * Declarative description of a run, read from a text file with one command per line.
+ * Everything after a '#' is a comment. Points are given as three coordinates "x y z" (in m).
+ * When an element's end point is omitted, it ends at the origin, i.e. it closes the ring.
+ *
+ * Lattice:
+ *   origin x y z
+ *   straight radius [end]
+ *   dipole radius curvature B_0 [end]
+ *   quadrupole radius b [end]
+ *   cavity radius E_0 omega kappa phi [end]
+ *   fodo radius b L [end]                          (see Accelerator::addFodoCell)
+ *   polygon center n major_radius minor_radius b B_0  (see Accelerator::buildPolygon)
+ *   default_lattice                                (see cernjunior::build_default_accelerator)
+ *
+ * Beams:
+ *   beam gaussian|uniform species N lambda position_spread velocity_spread [energy] (energy in GeV, default 2)
+ *   particle species position energy direction
+ * where species is the code or the name of a registered species (p, e, + or a for protons, electrons, positrons
+ * or alpha particles, see species.h)
+ *
+ * Simulation:
+ *   timestep dt                      (in s)
+ *   steps n                          (-1 to run until the accelerator is empty)
+ *   space_charge on|off [single|double]  (precision of the interactions, double by default)
+ *   barnes_hut theta                 (opening angle of the space charge trees, 0.5 by default, see Accelerator::setBarnes_hut_theta)
+ *   block_timesteps levels [max_deflection]  (see Accelerator::evolve, dt is then the coarsest step)
+ *   math libm|scalar|avx2|avx512|fast  (kernels of the push and force loops, see vector3d/fast_math.h, libm by default;
+ *                                      avx2 and avx512 only differ from scalar in the space charge, in double precision)
+ *   seed n                           (random by default)
+ *   engine timestep|linear|analytic|curvilinear [n]  (see below, timestep by default)
+ *   turns n                          (linear and element-wise engines, 1 by default)
+ *
+ * The analytic engine carries each particle across whole elements in one go (see Element::transport),
+ * one turn at a time. Since it has no space charge, the time-stepping engine is used when space charge is on.
+ * Summaries are then given every n turns, and snapshot output is not available.
+ * The curvilinear engine works the same way, but integrates the fields in n equal steps of s across each
+ * element (16 by default, see Element::integrate).
+ *
+ * The linear engine (see physics/transfer_map.h) reports the tunes and beta functions of the lattice,
+ * then tracks the particles turn by turn with the one-turn map, taking the first beam's particle as the
+ * reference. Each particle starts from its coordinates relative to the ideal orbit where it was created,
+ * as if it were at the origin. Space charge and snapshot output are not available with this engine.
+ *
+ * Ensembles (see ensemble/ensemble.h), one run per combination of the swept values and repetition:
+ *   sweep b|B_0|phase value [value ...]  (b and B_0 keep the sign of each element's own value, default_lattice is not affected;
+ *                                     B_0 cannot be swept with the linear engine, see Element::transfer_map)
+ *   repeat n                         (independent random streams for each repetition)
+ *   threads n                        (all the cores by default)
+ *   table path                       (summary table of the runs, on the log by default)
+ *
+ * Output:
+ *   output path [every n] [particles k] [float32] [compress position_error velocity_error] [drop|wait]
+ *                                    (when the disk is behind, snapshots are dropped and counted by default, so that
+ *                                     tracking never waits for it; wait: every snapshot is written, see SnapshotWriter)
+ *   summary every n                  (one line of statistics on the log every n steps, with the number of
+ *                                     particles at each level when block timesteps are on)
+ *   trees every n                    (one line of statistics of the space charge trees on the log every n steps,
+ *                                     see physics/tree_statistics.h)
+ *   trace path [events]              (timeline of the run in the Chrome trace format, keeping the last events of
+ *                                     each thread, see physics/trace.h)
+ */
+
+struct ElementSpec{
+	enum Kind { STRAIGHT, DIPOLE, QUADRUPOLE, CAVITY, FODO, POLYGON, DEFAULT_LATTICE };
+	Kind kind;
+
+	double radius = 0.0;
+	double curvature = 0.0;
+	double B_0 = 0.0;
+	double b = 0.0;
+	double L = 0.0;
+	double E_0 = 0.0;
+	double omega = 0.0;
+	double kappa = 0.0;
+	double phi = 0.0;
+
+	bool has_end = false;
+	Vector3D end; // end point, or center of a polygon
+
+	unsigned int n = 0; // number of sides of a polygon
+	double major_radius = 0.0;
+
+	explicit ElementSpec(Kind my_kind) : kind(my_kind){}
+
+	void build(Accelerator &w) const; // appends the element(s) to w
+};
+
+struct BeamSpec{
+	bool single = false; // a single particle rather than a beam
+	char distribution = 'g'; // 'g'aussian or 'u'niform
+	char particle = 'p'; // particle code, see concrete_particle
+	unsigned int N = 1;
+	double lambda = 1.0;
+	double position_spread = 0.0;
+	double velocity_spread = 0.0;
+	double energy = 2.0; // in GeV
+	Vector3D position; // single particles only
+	Vector3D direction = vctr::X_VECTOR;
+
+	std::unique_ptr<Particle> model(void) const; // the particle the beam is made of
+	void build(Accelerator &w) const;
+};
+
+struct OutputSpec{
+	std::string path; // no snapshot file if empty
+	unsigned int step_decimation = 1;
+	unsigned int particle_decimation = 1;
+	bool float32 = false;
+	bool compress = false;
+	snapshot::Compression compression;
+	snapshot::Overflow overflow = snapshot::Overflow::DROP;
+
+	unsigned int summary_interval = 0; // no summary if zero
+	unsigned int tree_interval = 0; // no tree statistics if zero
+};
+
+struct SweepAxis{
+	enum Parameter { QUADRUPOLE_B, DIPOLE_B_0, CAVITY_PHASE };
+	Parameter parameter;
+	std::vector<double> values;
+
+	static std::string name(Parameter p);
+	void apply(std::vector<ElementSpec> &lattice, double value) const; // sets the parameter on every concerned element
+};
+
+struct BatchConfig{
+	enum Engine { TIMESTEP, LINEAR, ANALYTIC, CURVILINEAR };
+
+	Vector3D origin = Vector3D(3,2,0);
+	std::vector<ElementSpec> lattice;
+	std::vector<BeamSpec> beams;
+
+	double dt = simcst::DEFAULT_TIMESTEP;
+	long steps = 1000;
+	bool space_charge = true;
+	Precision space_charge_precision = Precision::DOUBLE;
+	double barnes_hut_theta = simcst::BARNES_HUT_THETA;
+	fastmath::Kernel math = fastmath::Kernel::LIBM;
+	unsigned int block_levels = 0;
+	double max_deflection = simcst::DEFAULT_MAX_DEFLECTION;
+	bool has_seed = false;
+	uint64_t seed = 0;
+
+	Engine engine = TIMESTEP;
+	unsigned long turns = 1;
+	unsigned int steps_per_element = 16; // curvilinear engine
+
+	OutputSpec output;
+
+	std::vector<SweepAxis> sweeps;
+	unsigned int repeats = 1;
+	unsigned int threads = 0; // 0 means one per core
+	std::string table;
+
+	std::string trace; // no trace if empty
+	size_t trace_events = trace::DEFAULT_EVENTS_PER_THREAD; // per thread
+
+	bool is_ensemble(void) const{ return not sweeps.empty() or repeats > 1; }
+	bool is_element_wise(void) const{ return (engine == ANALYTIC or engine == CURVILINEAR) and not space_charge; } // see the analytic engine
+
+	void build(Accelerator &w) const; // lattice and beams, ready to be initialized
+	void track_turn(Accelerator &w) const; // one turn with the element-wise engine
+};
+
+BatchConfig read_batch_config(std::istream &input);
+BatchConfig read_batch_config(const std::string &path);
+
+// reference particle of the linear engine, made of the first beam's particle
+ReferenceParticle reference_particle(const BatchConfig &config);
+
+// builds the accelerator described by config and runs it to completion without user interaction
+// returns the number of particles left
+size_t run_batch(const BatchConfig &config, std::ostream &log = std::cout);
@@ -0,0 +1,30 @@
+CONFIG += \
+	c++11 \
+	console \
+
+CONFIG -= app_bundle qt
+
+TARGET = cern-junior-benchmarks
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+
+LIBS += \
+	-L../physics -lphysics \
+	-L../color -lcolor \
+	-L../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../physics/libphysics.a \
+	../color/libcolor.a \
+	../vector3d/libvector3d.a \
+
+HEADERS += \
+	harness.h \
+
+SOURCES += \
+	harness.cpp \
+	main_benchmarks.cpp \
+
+include(../cernjunior.pri)
@@ -0,0 +1,35 @@
+#include <cmath>
+#include <algorithm>
+
+#include "harness.h"
+
+void Harness::record(BenchmarkResult result, const std::vector<double> &times){
+	double sum(0.0);
+	for(double t : times) sum += t;
+	result.mean = sum/times.size();
+
+	double squares(0.0);
+	for(double t : times) squares += (t - result.mean)*(t - result.mean);
+	result.stddev = times.size() > 1 ? std::sqrt(squares/(times.size() - 1)) : 0.0;
+	result.min = *std::min_element(times.begin(), times.end());
+
+	results.push_back(result);
+	if(log){
+		*log << result.name << " (" << result.parameter << "): " << result.mean << " s +- " << result.stddev
+		     << " over " << result.repeats << " repeats, " << 1e9*result.per_item() << " ns per item\n";
+	}
+}
+
+void Harness::print_table(std::ostream &output) const{
+	output << "benchmark\tparameter\titems\trepeats\tmean\tstddev\tmin\tper_item\n";
+	for(const auto &r : results){
+		output << r.name
+		       << "\t" << r.parameter
+		       << "\t" << r.items
+		       << "\t" << r.repeats
+		       << "\t" << r.mean
+		       << "\t" << r.stddev
+		       << "\t" << r.min
+		       << "\t" << r.per_item() << "\n";
+	}
+}
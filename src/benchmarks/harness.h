@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+
+/*
+ * Timing of pieces of code, each run once to warm up and then a given number of times. The results are kept with
+ * their repeat count, mean, standard deviation and minimum, and written as a table with one tab-separated line per
+ * benchmark (see Harness::print_table), so that they can be compared across versions.
+ */
+
+struct BenchmarkResult{
+	std::string name;
+	std::string parameter; // e.g. the number of particles
+	double items = 1.0; // number of operations timed in each repeat, e.g. particles pushed
+	unsigned int repeats = 0;
+	double mean = 0.0; // wall time of a repeat (in s)
+	double stddev = 0.0;
+	double min = 0.0;
+
+	double per_item(void) const{ return mean/items; }
+};
+
+class Harness{
+	private:
+		unsigned int repeats;
+		std::vector<BenchmarkResult> results;
+		std::ostream* log; // one line per benchmark as it finishes, if not null
+
+		void record(BenchmarkResult result, const std::vector<double> &times);
+
+	public:
+		explicit Harness(unsigned int my_repeats, std::ostream* my_log = &std::cout) : repeats(my_repeats ? my_repeats : 1), log(my_log){}
+
+		// times f(), which makes the given number of operations, with the given repeat count (the harness' one by default)
+		template<class F>
+		const BenchmarkResult& run(const std::string &name, const std::string &parameter, double items, F f, unsigned int my_repeats = 0){
+			return run_with_setup(name, parameter, items, [](){}, f, my_repeats);
+		}
+
+		// same, calling setup() untimed before each call to f(), for code that consumes its input (e.g. particles lost)
+		template<class S, class F>
+		const BenchmarkResult& run_with_setup(const std::string &name, const std::string &parameter, double items, S setup, F f, unsigned int my_repeats = 0){
+			BenchmarkResult result;
+			result.name = name;
+			result.parameter = parameter;
+			result.items = items;
+			result.repeats = my_repeats ? my_repeats : repeats;
+
+			setup();
+			f();
+			std::vector<double> times;
+			for(unsigned int k(0); k < result.repeats; ++k){
+				setup();
+				const auto start(std::chrono::steady_clock::now());
+				f();
+				times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+			}
+			record(result, times);
+			return results.back();
+		}
+
+		const std::vector<BenchmarkResult>& getResults(void) const{ return results; }
+
+		void print_table(std::ostream &output) const;
+};
+
+namespace benchmark{
+	// keeps the compiler from optimizing away the computation of value
+	template<class T>
+	inline void keep(const T &value){ asm volatile("" : : "g"(&value) : "memory"); }
+}
@@ -0,0 +1,225 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+
+#include "harness.h"
+#include "../physics/accelerator.h"
+#include "../physics/element_table.h"
+#include "../physics/static_lattice.h"
+
+// Times the building blocks of the time-stepping engine, from the vector algebra to whole steps of the default
+// accelerator, and writes the results as a table (see Harness::print_table). A step of a StaticLattice is timed
+// against one of its runtime counterpart (static_lattice_test only checks that they agree).
+//
+// Usage: cern-junior-benchmarks [--repeats n] [--max-particles N] [--output path]
+// The accelerator steps are timed with 10^3 particles and up to N by factors of 10 (10^5 by default, since 10^6
+// particles need over a GB of memory for their trees), and the Barnes-Hut forces with several opening angles. The table
+// goes to benchmarks.tsv by default.
+
+using namespace std;
+
+namespace{
+	const double DT(1e-11);
+	const double LAMBDA(1000.0); // protons per macro-particle (the beams hold at most 2^32 protons)
+	const double THETAS[] = {0.25, simcst::BARNES_HUT_THETA, 1.0}; // opening angles of the Barnes-Hut benchmarks
+
+	struct Options{
+		unsigned int repeats = 10;
+		unsigned long max_particles = 100000;
+		string output = "benchmarks.tsv";
+	};
+
+	Options parse(int argc, char* argv[]){
+		Options options;
+		for(int i(1); i < argc; ++i){
+			const string option(argv[i]);
+			if(i + 1 == argc) throw invalid_argument("missing value after " + option);
+			const string value(argv[++i]);
+			if(option == "--repeats") options.repeats = stoul(value);
+			else if(option == "--max-particles") options.max_particles = stoul(value);
+			else if(option == "--output") options.output = value;
+			else throw invalid_argument("unknown option " + option);
+		}
+		return options;
+	}
+
+	// n protons around the origin, moving along x
+	vector<unique_ptr<Particle>> cloud(size_t n, double sigma){
+		RandomEngine gen(1);
+		GaussianVector3D offset(sigma);
+		vector<unique_ptr<Particle>> particles;
+		for(size_t i(0); i < n; ++i) particles.push_back(Proton(offset(gen), 2, vctr::X_VECTOR).copy());
+		return particles;
+	}
+
+	void vector_algebra(Harness &harness){
+		const size_t n(100000);
+		RandomEngine gen(2);
+		GaussianVector3D random(1.0);
+		vector<Vector3D> a(n), b(n), c(n);
+		for(size_t i(0); i < n; ++i){
+			a[i] = random(gen);
+			b[i] = random(gen);
+		}
+		const string N(to_string(n));
+
+		harness.run("vector3d_sum", N, n, [&](){ for(size_t i(0); i < n; ++i) c[i] = a[i] + b[i]; benchmark::keep(c); });
+		harness.run("vector3d_cross", N, n, [&](){ for(size_t i(0); i < n; ++i) c[i] = a[i] ^ b[i]; benchmark::keep(c); });
+		harness.run("vector3d_dot", N, n, [&](){ double s(0.0); for(size_t i(0); i < n; ++i) s += a[i] | b[i]; benchmark::keep(s); });
+		harness.run("vector3d_unitary", N, n, [&](){ for(size_t i(0); i < n; ++i) c[i] = a[i].unitary_or(vctr::ZERO_VECTOR); benchmark::keep(c); });
+		harness.run("vector3d_rotated", N, n, [&](){ for(size_t i(0); i < n; ++i) c[i] = a[i].rotated(b[i], 0.1); benchmark::keep(c); });
+	}
+
+	void trees(Harness &harness){
+		const Box domain(nullptr, vctr::ZERO_VECTOR, vctr::X_VECTOR, 1.0);
+		for(size_t n : {1000, 10000, 100000}){
+			const vector<unique_ptr<Particle>> particles(cloud(n, 0.2));
+			const string N(to_string(n));
+
+			bool contained(false);
+			harness.run("box_contains", N, n, [&](){ for(const auto &p : particles) contained ^= domain.contains(*p); benchmark::keep(contained); });
+
+			NodePool pool;
+			Node root(domain);
+			root.setPool(&pool);
+			auto build([&](){
+				pool.rewind();
+				root.reset();
+				for(const auto &p : particles) root.insert(p.get());
+			});
+			harness.run("tree_build", N, n, build);
+
+			// the interactions grow as n.log(n) with a large constant, hence the smaller beams
+			if(n > 10000) continue;
+			build();
+			for(double theta : THETAS){
+				ostringstream parameter;
+				parameter << n << " theta=" << theta;
+				for(Precision precision : {Precision::DOUBLE, Precision::SINGLE}){
+					const string name(precision == Precision::DOUBLE ? "barnes_hut_double" : "barnes_hut_single");
+					harness.run(name, parameter.str(), n, [&](){
+						for(const auto &p : particles){
+							root.apply_electromagnetic_force(*p, precision, theta);
+							p->reset_force();
+						}
+					});
+				}
+			}
+		}
+	}
+
+	// the field of each kind of element record, the geometry being that of the first FODO cell of the default accelerator
+	void fields(Harness &harness, const Accelerator &w, vector<unique_ptr<Particle>> &particles){
+		const ElementTable &table(w.getElement_table());
+		vector<ElementRecord> records;
+		for(const auto &r : table) if(r.kind == ElementRecord::LENSES or r.kind == ElementRecord::DIPOLE) records.push_back(r);
+
+		ElementRecord record(table[0]);
+		record.kind = ElementRecord::STRAIGHT;
+		records.push_back(record);
+		record.kind = ElementRecord::QUADRUPOLE;
+		record.quadrupole.b = 1.2;
+		records.push_back(record);
+		record.kind = ElementRecord::CAVITY;
+		record.cavity = {1e6, 1e9, 1.0, 0.0};
+		records.push_back(record);
+
+		const char* names[] = {"straight", "dipole", "quadrupole", "lenses", "cavity"};
+		bool timed[5] = {};
+		const string N(to_string(particles.size()));
+		for(const auto &r : records){
+			if(timed[r.kind]) continue;
+			timed[r.kind] = true;
+			harness.run(string("field_") + names[r.kind], N, particles.size(), [&](){
+				for(auto &p : particles){
+					r.apply_lorentz_force(*p, DT, 0.0);
+					p->reset_force();
+				}
+			});
+		}
+	}
+
+	void pushes(Harness &harness, const Accelerator &w, vector<unique_ptr<Particle>> &particles){
+		double t(0.0);
+		harness.run("particle_evolve", to_string(particles.size()), particles.size(), [&](){
+			t += DT;
+			for(auto &p : particles) p->evolve(w.getElement_table(), DT, t);
+		});
+	}
+
+	// a step of the same beam, without space charge, in a ring declared as a StaticLattice and in its runtime counterpart
+	void lattices(Harness &harness){
+		const size_t n(1000);
+		const Vector3D origin(6,2,0);
+		unique_ptr<Accelerator> w;
+		unique_ptr<cernjunior::DefaultRing> fixed;
+		auto setup([&](){
+			fixed.reset(new cernjunior::DefaultRing(cernjunior::stable_ring()));
+			w.reset(new Accelerator(nullptr, origin));
+			fixed->build(*w);
+			w->setSeed(5);
+			w->setSpace_charge(false);
+			w->addGaussianCircularBeam(Proton(origin, 2, w->getElement(0).getDir()), n, 1.0, 0.001, 0.0001);
+			w->initialize();
+			fixed->load(*w);
+		});
+
+		harness.run_with_setup("runtime_lattice_evolve", to_string(n), n, setup, [&](){ w->evolve(DT); });
+		harness.run_with_setup("static_lattice_evolve", to_string(n), n, setup, [&](){ fixed->evolve(DT); });
+	}
+
+	void accelerator_steps(Harness &harness, unsigned long max_particles){
+		for(unsigned long n(1000); n <= max_particles; n *= 10){
+			// the beam is rebuilt before each step, since the particles lost during a step would not be pushed in the next
+			unique_ptr<Accelerator> w;
+			auto setup([&](){
+				w.reset(new Accelerator(nullptr, Vector3D(3,2,0)));
+				cernjunior::build_default_accelerator(*w);
+				w->setSeed(3);
+				w->addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), n*LAMBDA, LAMBDA, 0.01, 0.001);
+				w->initialize();
+			});
+
+			// a few repeats for the largest beams, whose steps take seconds
+			harness.run_with_setup("accelerator_evolve", to_string(n), n, setup, [&](){ w->evolve(DT); }, n >= 100000 ? 3 : 0);
+		}
+	}
+}
+
+int main(int argc, char* argv[]){
+	try{
+		const Options options(parse(argc, argv));
+		Harness harness(options.repeats);
+
+		vector_algebra(harness);
+		trees(harness);
+
+		// particles spread along the default accelerator, pushed without space charge
+		Accelerator w(nullptr, Vector3D(3,2,0));
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(4);
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), 10000*LAMBDA, LAMBDA, 0.01, 0.001);
+		w.initialize();
+		vector<unique_ptr<Particle>> particles;
+		for(size_t i(0); i < w.particle_count(); ++i) particles.push_back(w.getParticle(i).copy());
+
+		fields(harness, w, particles);
+		pushes(harness, w, particles);
+		lattices(harness);
+		accelerator_steps(harness, options.max_particles);
+
+		ofstream output(options.output);
+		if(not output) throw invalid_argument("could not open '" + options.output + "'");
+		harness.print_table(output);
+		cout << harness.getResults().size() << " benchmarks written to " << options.output << "\n";
+	}
+	catch(const exception &exc){
+		cerr << argv[0] << ": " << exc.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
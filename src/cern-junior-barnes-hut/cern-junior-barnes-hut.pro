@@ -0,0 +1,26 @@
+CONFIG += \
+	c++11 \
+	console \
+
+CONFIG -= app_bundle qt
+
+TARGET = cern-junior-barnes-hut
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+
+LIBS += \
+	-L../physics -lphysics \
+	-L../color -lcolor \
+	-L../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../physics/libphysics.a \
+	../color/libcolor.a \
+	../vector3d/libvector3d.a \
+
+SOURCES += \
+	main_barnes_hut.cpp \
+
+include(../cernjunior.pri)
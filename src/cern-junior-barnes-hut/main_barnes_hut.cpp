@@ -0,0 +1,183 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+#include "../physics/accelerator.h"
+
+// Measures what the opening angle of the Barnes-Hut trees costs and buys on the beams the simulation runs: for each
+// shape of beam (as drawn by addGaussianCircularBeam and addUniformCircularBeam in the default accelerator), number
+// of particles N and opening angle theta, the space charge of the elements' trees (as computed by
+// Accelerator::evolve) is compared with the exact sum over the particles of the same element. The table gives
+// percentiles of the relative error on the force, the node-particle interactions per particle and the wall time of
+// the force pass (the best of a few), the row "direct" being the time of the exact sums.
+//
+// Usage: cern-junior-barnes-hut [--particles N,N,...] [--theta t,t,...] [--repeats n] [--output path]
+// By default, N is 1000 and 10000, theta goes from 0.1 to 1, and the table goes to barnes_hut.tsv.
+
+using namespace std;
+
+namespace{
+	const double LAMBDA(1000.0); // protons per macro-particle, as in the benchmarks
+	const double SPREAD_X(0.01);
+	const double SPREAD_V(0.001);
+
+	struct Options{
+		vector<unsigned long> particles = {1000, 10000};
+		vector<double> thetas = {0.1, 0.2, 0.3, 0.5, 0.7, 1.0};
+		unsigned int repeats = 3;
+		string output = "barnes_hut.tsv";
+	};
+
+	template<typename T> vector<T> list(const string &value){
+		vector<T> values;
+		istringstream input(value);
+		string item;
+		while(getline(input, item, ',')){
+			istringstream parsed(item);
+			T x;
+			if(not (parsed >> x)) throw invalid_argument("bad list '" + value + "'");
+			values.push_back(x);
+		}
+		return values;
+	}
+
+	Options parse(int argc, char* argv[]){
+		Options options;
+		for(int i(1); i < argc; ++i){
+			const string option(argv[i]);
+			if(i + 1 == argc) throw invalid_argument("missing value after " + option);
+			const string value(argv[++i]);
+			if(option == "--particles") options.particles = list<unsigned long>(value);
+			else if(option == "--theta") options.thetas = list<double>(value);
+			else if(option == "--repeats") options.repeats = max(1ul, stoul(value));
+			else if(option == "--output") options.output = value;
+			else throw invalid_argument("unknown option " + option);
+		}
+		return options;
+	}
+
+	// the particles of a beam, with a tree per element holding those of the element, built as in Accelerator::evolve
+	class Trees{
+		private:
+			vector<unique_ptr<Particle>> particles;
+			NodePool pool;
+			vector<Node> roots;
+			vector<vector<Particle*>> members; // of the trees, by element
+
+		public:
+			Trees(const Accelerator &w){
+				for(size_t i(0); i < w.particle_count(); ++i) particles.push_back(w.getParticle(i).copy());
+				members.resize(w.element_count());
+				roots.reserve(w.element_count());
+				for(size_t e(0); e < w.element_count(); ++e){
+					roots.emplace_back(w.getElement(e).getBox());
+					roots.back().setPool(&pool);
+				}
+				for(auto &p : particles){
+					const size_t e(p->getElement_index());
+					if(roots[e].insert(p.get())) members[e].push_back(p.get());
+				}
+			}
+
+			size_t size(void) const{
+				size_t n(0);
+				for(const auto &m : members) n += m.size();
+				return n;
+			}
+
+			// the forces on the particles of the trees, the exact sums if theta is negative, and the time it took
+			double forces(double theta, vector<Vector3D> &F, unsigned long &interactions){
+				F.clear();
+				pool.interactions = 0;
+				const auto start(chrono::steady_clock::now());
+				for(size_t e(0); e < members.size(); ++e){
+					for(Particle* p : members[e]){
+						if(theta < 0.0){
+							for(const Particle* q : members[e]) p->receive_electromagnetic_force(*q);
+						}else{
+							roots[e].apply_electromagnetic_force(*p, Precision::DOUBLE, theta);
+						}
+						F.push_back(p->getForce());
+						p->reset_force();
+					}
+				}
+				const double seconds(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+				interactions = pool.interactions;
+				if(theta < 0.0){
+					interactions = 0;
+					for(const auto &m : members) interactions += m.size()*(m.size() - 1);
+				}
+				return seconds;
+			}
+	};
+
+	// the value below which a fraction q of the sorted values lie
+	double percentile(const vector<double> &sorted, double q){
+		if(sorted.empty()) return NAN;
+		return sorted[min(sorted.size() - 1, size_t(q*sorted.size()))];
+	}
+
+	void characterise(ostream &table, const string &shape, unsigned long n, const Options &options){
+		Accelerator w(nullptr, Vector3D(3,2,0));
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(8);
+		const Proton model(Vector3D(), 2, Vector3D(1,0,0));
+		if(shape == "gaussian") w.addGaussianCircularBeam(model, n*LAMBDA, LAMBDA, SPREAD_X, SPREAD_V);
+		else w.addUniformCircularBeam(model, n*LAMBDA, LAMBDA, SPREAD_X, SPREAD_V);
+		w.initialize();
+
+		Trees trees(w);
+		const size_t inserted(trees.size());
+		vector<Vector3D> exact, F;
+		unsigned long interactions(0);
+
+		double best(trees.forces(-1.0, exact, interactions));
+		for(unsigned int r(1); r < options.repeats; ++r) best = min(best, trees.forces(-1.0, F, interactions));
+		table << shape << "\t" << inserted << "\tdirect\t0\t0\t0\t0\t" << double(interactions)/inserted << "\t" << best << "\t" << best/inserted << "\n";
+
+		for(double theta : options.thetas){
+			best = trees.forces(theta, F, interactions);
+			for(unsigned int r(1); r < options.repeats; ++r) best = min(best, trees.forces(theta, F, interactions));
+
+			vector<double> errors;
+			for(size_t i(0); i < F.size(); ++i){
+				const double norm(exact[i].norm());
+				if(norm > 0.0) errors.push_back((F[i] - exact[i]).norm()/norm);
+			}
+			sort(errors.begin(), errors.end());
+
+			table << shape << "\t" << inserted << "\t" << theta
+			      << "\t" << percentile(errors, 0.5) << "\t" << percentile(errors, 0.9) << "\t" << percentile(errors, 0.99)
+			      << "\t" << (errors.empty() ? NAN : errors.back())
+			      << "\t" << double(interactions)/inserted << "\t" << best << "\t" << best/inserted << "\n";
+		}
+	}
+}
+
+int main(int argc, char* argv[]){
+	try{
+		const Options options(parse(argc, argv));
+		ofstream output(options.output);
+		if(not output) throw invalid_argument("could not open '" + options.output + "'");
+
+		output << "beam\tparticles\ttheta\terror_p50\terror_p90\terror_p99\terror_max\tinteractions_per_particle\tseconds\tseconds_per_particle\n";
+		for(const string shape : {"gaussian", "uniform"}){
+			for(unsigned long n : options.particles){
+				cout << shape << " beam of " << n << " particles\n";
+				characterise(output, shape, n, options);
+			}
+		}
+		if(not EvolveProfile::ENABLED) cout << "The interactions are not counted (CERNJUNIOR_NO_PROFILE)\n";
+		cout << "Results written to " << options.output << "\n";
+	}
+	catch(const exception &exc){
+		cerr << argv[0] << ": " << exc.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,35 @@
+CONFIG += \
+	c++11 \
+	console \
+	thread \
+
+CONFIG -= app_bundle qt
+
+TARGET = cern-junior-batch
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+	../batch \
+	../ensemble \
+
+LIBS += \
+	-L../ensemble -lensemble \
+	-L../batch -lbatch \
+	-L../snapshot -lsnapshot \
+	-L../physics -lphysics \
+	-L../color -lcolor \
+	-L../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../ensemble/libensemble.a \
+	../batch/libbatch.a \
+	../snapshot/libsnapshot.a \
+	../physics/libphysics.a \
+	../color/libcolor.a \
+	../vector3d/libvector3d.a \
+
+SOURCES += \
+	main_batch.cpp \
+
+include(../cernjunior.pri)
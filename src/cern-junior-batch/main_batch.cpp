@@ -0,0 +1,55 @@
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+
+#include "../batch/batch_config.h"
+#include "../ensemble/ensemble.h"
+
+// Runs each configuration file given as argument without any user interaction (see batch/batch_config.h).
+// Configurations with sweeps or repetitions are run as ensembles (see ensemble/ensemble.h).
+
+int main(int argc, char* argv[]){
+	if(argc < 2){
+		std::cerr << "Usage: " << argv[0] << " configuration-file [configuration-file ...]\n";
+		return 2;
+	}
+
+	for(int i(1); i < argc; ++i){
+		try{
+			std::cout << "Running " << argv[i] << "\n";
+			const BatchConfig config(read_batch_config(argv[i]));
+			if(not config.trace.empty()){
+				trace::start(config.trace_events);
+				trace::name_thread("main");
+			}
+
+			std::vector<RunSummary> runs;
+			if(config.is_ensemble()) runs = ensemble::run(config);
+			else run_batch(config);
+
+			if(not config.trace.empty()){
+				trace::stop();
+				trace::write(config.trace);
+				std::cout << trace::event_count() << " trace events written to " << config.trace;
+				if(trace::overwritten()) std::cout << " (" << trace::overwritten() << " older ones overwritten)";
+				std::cout << "\n";
+			}
+			if(not config.is_ensemble()) continue;
+
+			if(config.table.empty()){
+				ensemble::print_table(config, runs, std::cout);
+			}else{
+				std::ofstream table(config.table);
+				if(not table) throw std::invalid_argument("could not open '" + config.table + "'");
+				ensemble::print_table(config, runs, table);
+				std::cout << runs.size() << " runs summarized in " << config.table << "\n";
+			}
+		}
+		catch(const std::exception &exc){
+			std::cerr << argv[i] << ": " << exc.what() << "\n";
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -1,5 +1,6 @@
 CONFIG += \
 	c++11 \
+	thread \
 
 CONFIG -= app_bundle
 
@@ -11,16 +12,18 @@ INCLUDEPATH += \
 	../textview \
 
 LIBS += \
+	-L../snapshot -lsnapshot \
+	-L../textview -ltextview \
+	-L../physics -lphysics \
 	-L../color -lcolor \
 	-L../vector3d -lvector3d \
-	-L../physics -lphysics \
-	-L../textview -ltextview
 
 PRE_TARGETDEPS +=\
 	../color/libcolor.a \
 	../vector3d/libvector3d.a \
 	../physics/libphysics.a \
-	../textview/libtextview.a
+	../textview/libtextview.a \
+	../snapshot/libsnapshot.a
 
 SOURCES += \
 	main_text.cpp
@@ -29,3 +32,5 @@ SOURCES += \
 HEADERS += \
 	../textview/textview.h
 	../textview/acceleratorwidgetconsole.h
+
+include(../cernjunior.pri)
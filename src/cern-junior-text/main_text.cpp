@@ -1,12 +1,25 @@
 #include <vector>
 #include <cmath>
+#include <memory>
 
 #include "../textview/acceleratorwidgetconsole.h"
+#include "../snapshot/acceleratorwidgetsnapshot.h"
 
 #include "../physics/accelerator_cli.h"
 
-int main(void){
-	AcceleratorWidgetConsole w(Vector3D(3,2,0));
+int main(int argc, char* argv[]){
+	// with a file name as argument, the beam is recorded into a binary snapshot file instead of being printed
+	std::unique_ptr<Accelerator> accelerator;
+	AcceleratorWidgetConsole* console(nullptr);
+	AcceleratorWidgetSnapshot* recorder(nullptr);
+	if(argc > 1){
+		recorder = new AcceleratorWidgetSnapshot(Vector3D(3,2,0), argv[1]);
+		accelerator.reset(recorder);
+	}else{
+		console = new AcceleratorWidgetConsole(Vector3D(3,2,0));
+		accelerator.reset(console);
+	}
+	Accelerator &w(*accelerator);
 
 	cernjunior::build_default_accelerator(w);
 
@@ -32,6 +45,18 @@ int main(void){
 		}else{
 			std::cout << "Accelerator is empty after " << i << " iterations\n";
 		}
+		if(console){
+			console->show_profile();
+			console->show_trees();
+		}
+		if(recorder){
+			// snapshots are dropped rather than waited for when the disk is behind (see SnapshotWriter)
+			SnapshotView &view(recorder->getView());
+			view.close();
+			std::cout << view.getCommitted() << " snapshots written to " << argv[1];
+			if(view.getDropped()) std::cout << " (" << view.getDropped() << " dropped while the disk was busy)";
+			std::cout << "\n";
+		}
 	}
 
 	catch(...){
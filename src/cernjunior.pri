@@ -0,0 +1,6 @@
+# Settings shared by every project of the tree, each .pro including this file.
+#
+# CERNJUNIOR_NO_PROFILE compiles the instrumentation of Accelerator::evolve out (see physics/profile.h). The
+# profile is inlined into the libraries and the programs alike, so the define must be the same for the whole tree:
+# set it here, never in a single project.
+#DEFINES += CERNJUNIOR_NO_PROFILE
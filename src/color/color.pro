@@ -7,3 +7,5 @@ SOURCES += \
 
 HEADERS += \
 	rgb.h \
+
+include(../cernjunior.pri)
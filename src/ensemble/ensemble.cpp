@@ -0,0 +1,149 @@
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <exception>
+
+#include "ensemble.h"
+#include "thread_pool.h"
+
+#include "../physics/accelerator.h"
+
+std::vector<BatchConfig> ensemble::variants(const BatchConfig &config){
+	// base seed of the ensemble, from which every run gets its own
+	const uint64_t base(config.has_seed ? config.seed : std::random_device()());
+
+	size_t combinations(1);
+	for(const auto &axis : config.sweeps) combinations *= axis.values.size();
+
+	std::vector<BatchConfig> runs;
+	runs.reserve(combinations * config.repeats);
+
+	for(size_t c(0); c < combinations; ++c){
+		BatchConfig variant(config);
+		size_t rest(c);
+		for(const auto &axis : config.sweeps){
+			axis.apply(variant.lattice, axis.values[rest % axis.values.size()]);
+			rest /= axis.values.size();
+		}
+
+		variant.sweeps.clear();
+		variant.repeats = 1;
+		variant.output.path.clear(); // runs only report their summary
+		variant.output.summary_interval = 0;
+		variant.has_seed = true;
+
+		for(unsigned int r(0); r < config.repeats; ++r){
+			variant.seed = base + runs.size();
+			runs.push_back(variant);
+		}
+	}
+
+	return runs;
+}
+
+namespace{
+	RunSummary run_one(const BatchConfig &config){
+		RunSummary summary;
+		summary.seed = config.seed;
+
+		const auto start(std::chrono::steady_clock::now());
+		try{
+			Accelerator w(nullptr, config.origin);
+			config.build(w);
+			w.initialize();
+
+			summary.initial_particles = w.particle_count();
+			std::array<double,2> initial;
+			std::array<double,2> final;
+
+			if(config.engine == BatchConfig::LINEAR){
+				const ReferenceParticle reference(reference_particle(config));
+				const LinearOptics optics(w, reference);
+
+				std::vector<PhaseSpaceVector> X;
+				for(size_t i(0); i < w.particle_count(); ++i) X.push_back(LinearOptics::phase_coordinates(w.getParticle(i), reference));
+				initial = LinearOptics::rms_emittances(X);
+				optics.track(X, config.turns);
+				final = LinearOptics::rms_emittances(X);
+
+				if(optics.is_stable(0) and optics.is_stable(1)){
+					const std::array<double,2> tunes(optics.tunes());
+					summary.tunes[0] = tunes[0];
+					summary.tunes[1] = tunes[1];
+				}
+				summary.final_particles = X.size();
+				summary.steps = config.turns;
+			}else if(config.is_element_wise()){
+				initial = w.rms_emittances();
+				for(unsigned long turn(0); turn < config.turns and not w.is_empty(); ++turn) config.track_turn(w);
+				final = w.rms_emittances();
+				summary.final_particles = w.particle_count();
+				summary.steps = config.turns;
+			}else{
+				initial = w.rms_emittances();
+				for(long i(0); i != config.steps and not w.is_empty(); ++i) w.evolve(config.dt);
+				final = w.rms_emittances();
+				summary.final_particles = w.particle_count();
+				summary.steps = w.getStep();
+			}
+			summary.survival = summary.initial_particles ? double(summary.final_particles) / summary.initial_particles : 0.0;
+			for(int k(0); k < 2; ++k){
+				summary.emittance_growth[k] = initial[k] > 0.0 ? final[k] / initial[k] : 0.0;
+			}
+		}
+		catch(const std::exception &exc){
+			summary.error = exc.what();
+		}
+		summary.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return summary;
+	}
+}
+
+std::vector<RunSummary> ensemble::run(const BatchConfig &config){
+	const std::vector<BatchConfig> configs(variants(config));
+	std::vector<RunSummary> runs(configs.size());
+
+	ThreadPool pool(config.threads);
+	for(size_t i(0); i < configs.size(); ++i){
+		pool.submit([&configs, &runs, &config, i](){
+			const trace::Scope scope("run", "ensemble", "run", i);
+			runs[i] = run_one(configs[i]);
+			runs[i].run = i;
+
+			size_t rest(i / config.repeats);
+			for(const auto &axis : config.sweeps){
+				runs[i].parameters.push_back(axis.values[rest % axis.values.size()]);
+				rest /= axis.values.size();
+			}
+		});
+	}
+	pool.wait();
+
+	return runs;
+}
+
+void ensemble::print_table(const BatchConfig &config, const std::vector<RunSummary> &runs, std::ostream &output){
+	output << "run";
+	for(const auto &axis : config.sweeps) output << "\t" << SweepAxis::name(axis.parameter);
+	output << "\tseed\tinitial\tfinal\tsteps\tsurvival\temittance_growth_x\temittance_growth_y\ttune_x\ttune_y\twall_time\terror\n";
+
+	for(const auto &r : runs){
+		output << r.run;
+		for(double p : r.parameters) output << "\t" << p;
+		output << "\t" << r.seed
+		       << "\t" << r.initial_particles
+		       << "\t" << r.final_particles
+		       << "\t" << r.steps
+		       << "\t" << r.survival
+		       << "\t" << r.emittance_growth[0]
+		       << "\t" << r.emittance_growth[1];
+		for(double tune : r.tunes){
+			output << "\t";
+			if(std::isnan(tune)) output << "-";
+			else output << tune;
+		}
+		output << "\t" << r.wall_time
+		       << "\t" << (r.error.empty() ? "-" : r.error) << "\n";
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+
+#include "../batch/batch_config.h"
+
+/*
+ * Runs many variants of one configuration concurrently in the same process:
+ * one run per combination of the swept values (see SweepAxis) and per repetition.
+ * Every run has its own Accelerator (hence its own clock and particles) and its own random seed,
+ * and runs are scheduled on a shared work-stealing ThreadPool.
+ */
+
+struct RunSummary{
+	size_t run = 0;
+	std::vector<double> parameters; // value of each swept parameter
+	uint64_t seed = 0;
+
+	size_t initial_particles = 0;
+	size_t final_particles = 0;
+	unsigned long steps = 0; // turns for the linear and element-wise engines
+
+	double survival = 0.0; // fraction of the particles still in the accelerator at the end
+	double emittance_growth[2] = {0.0, 0.0}; // final over initial rms emittance, horizontal and vertical
+	double tunes[2] = {NAN, NAN}; // linear engine only, NaN for an unstable plane
+	double wall_time = 0.0; // in s
+
+	std::string error; // empty unless the run failed
+};
+
+namespace ensemble{
+	std::vector<BatchConfig> variants(const BatchConfig &config); // one configuration per run, seeds included
+	std::vector<RunSummary> run(const BatchConfig &config);
+
+	void print_table(const BatchConfig &config, const std::vector<RunSummary> &runs, std::ostream &output);
+}
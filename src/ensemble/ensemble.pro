@@ -0,0 +1,18 @@
+TEMPLATE = lib
+
+CONFIG = staticlib c++11 thread
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+	../batch \
+
+SOURCES += \
+	thread_pool.cpp \
+	ensemble.cpp \
+
+HEADERS += \
+	thread_pool.h \
+	ensemble.h \
+
+include(../cernjunior.pri)
@@ -0,0 +1,116 @@
+#include "thread_pool.h"
+
+#include <string>
+
+#include "../physics/trace.h"
+
+namespace{
+	// index of the current thread's queue in its pool, or SIZE_MAX outside of any pool
+	thread_local const ThreadPool* current_pool = nullptr;
+	thread_local size_t current_worker = SIZE_MAX;
+}
+
+ThreadPool::ThreadPool(unsigned int threads) :
+	queued(0),
+	unfinished(0),
+	next_queue(0)
+{
+	if(threads == 0) threads = std::thread::hardware_concurrency();
+	if(threads == 0) threads = 1;
+
+	for(unsigned int i(0); i < threads; ++i) queues.emplace_back(new Queue);
+	for(unsigned int i(0); i < threads; ++i) workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool(void){
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	work_available.notify_all();
+	for(auto &w : workers) w.join();
+}
+
+void ThreadPool::submit(std::function<void(void)> task){
+	const size_t i(current_pool == this ? current_worker : next_queue++ % queues.size());
+
+	// counted before being queued, so that the counters never go below zero
+	++unfinished;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		++queued;
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues[i]->mtx);
+		queues[i]->tasks.push_back(std::move(task));
+	}
+	work_available.notify_one();
+}
+
+bool ThreadPool::pop(size_t worker, std::function<void(void)> &task){
+	{
+		// own queue first, newest task (its data is likely still in cache)
+		Queue &own(*queues[worker]);
+		std::lock_guard<std::mutex> lock(own.mtx);
+		if(not own.tasks.empty()){
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			--queued;
+			return true;
+		}
+	}
+
+	for(size_t k(1); k < queues.size(); ++k){
+		// then steal the oldest task of another worker
+		Queue &other(*queues[(worker + k) % queues.size()]);
+		std::lock_guard<std::mutex> lock(other.mtx);
+		if(not other.tasks.empty()){
+			task = std::move(other.tasks.front());
+			other.tasks.pop_front();
+			--queued;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::run(size_t worker){
+	current_pool = this;
+	current_worker = worker;
+	if(trace::active()) trace::name_thread("worker " + std::to_string(worker));
+
+	std::function<void(void)> task;
+	while(true){
+		if(pop(worker, task)){
+			try{
+				task();
+			}catch(...){
+				std::lock_guard<std::mutex> lock(mtx);
+				if(not failure) failure = std::current_exception();
+			}
+			task = nullptr;
+
+			if(--unfinished == 0){
+				std::lock_guard<std::mutex> lock(mtx);
+				all_done.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mtx);
+		work_available.wait(lock, [this]{ return queued > 0 or stopping; });
+		if(stopping and queued == 0) return;
+	}
+}
+
+void ThreadPool::wait(void){
+	std::unique_lock<std::mutex> lock(mtx);
+	all_done.wait(lock, [this]{ return unfinished == 0; });
+
+	if(failure){
+		std::exception_ptr rethrown(nullptr);
+		std::swap(rethrown, failure);
+		std::rethrow_exception(rethrown);
+	}
+}
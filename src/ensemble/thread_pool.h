@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+
+class ThreadPool{
+	// Work-stealing pool: each worker has its own queue, takes its newest task first,
+	// and when it has nothing left steals the oldest task of another worker.
+	private:
+		struct Queue{
+			std::deque<std::function<void(void)>> tasks;
+			std::mutex mtx;
+		};
+
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+
+		std::atomic<size_t> queued; // tasks waiting in a queue
+		std::atomic<size_t> unfinished; // tasks submitted but not finished yet
+		std::atomic<size_t> next_queue; // round-robin for tasks submitted from outside the pool
+		bool stopping = false;
+
+		std::mutex mtx;
+		std::condition_variable work_available;
+		std::condition_variable all_done;
+		std::exception_ptr failure; // the first exception thrown by a task since the last wait, guarded by mtx
+
+		bool pop(size_t worker, std::function<void(void)> &task);
+		void run(size_t worker);
+
+	public:
+		explicit ThreadPool(unsigned int threads = 0); // 0 means one per core
+		~ThreadPool(void);
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool& operator=(const ThreadPool &) = delete;
+
+		size_t size(void) const{ return workers.size(); }
+
+		void submit(std::function<void(void)> task); // tasks may themselves submit tasks
+		// returns once every submitted task has finished, then rethrows the first exception thrown by one of them, if any
+		// (the other tasks still run)
+		void wait(void);
+};
@@ -1,32 +1,71 @@
 #include <QKeyEvent>
 #include <QTimerEvent>
 #include <QMatrix4x4>
+#include <iostream>
 
 #include "acceleratorwidgetgl.h"
+#include "../physics/trace.h"
 
 AcceleratorWidgetGL::AcceleratorWidgetGL(QWidget* parent, Vector3D origin) :
 	QOpenGLWidget(parent),
-	Accelerator(&view, origin)
+	Accelerator(&recorder, origin),
+	record_boxes(false),
+	timestep(simcst::DEFAULT_TIMESTEP)
 {
 	setMouseTracking(true);
 	timerId = startTimer(20);
-	stopwatch.restart();
+}
+
+void AcceleratorWidgetGL::start(void){
+	if(simulation.joinable()) return;
+	recorder.record(*this, record_boxes.load()); // so that there is something to draw before the first step
+	running = true;
+	simulation = std::thread(&AcceleratorWidgetGL::simulate, this);
+}
+
+void AcceleratorWidgetGL::stop(void){
+	if(not simulation.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(state_mutex);
+		stopping = true;
+	}
+	state_changed.notify_all();
+	simulation.join();
+}
+
+void AcceleratorWidgetGL::simulate(void){
+	trace::name_thread("simulation");
+	while(true){
+		{
+			std::unique_lock<std::mutex> lock(state_mutex);
+			state_changed.wait(lock, [this]{ return running or stopping; });
+			if(stopping) return;
+		}
+
+		const double dt(timestep.load()/simcst::DEPTH_FACTOR);
+		try{
+			for(int i(1); i <= simcst::DEPTH_FACTOR; ++i) evolve(dt);
+		}catch(const std::exception &exc){
+			std::cerr << exc.what() << "\n";
+			std::lock_guard<std::mutex> lock(state_mutex);
+			running = false; // paused, rather than failing again at every step
+		}
+		recorder.record(*this, record_boxes.load());
+
+		if(is_empty()){ // nothing left to simulate
+			std::lock_guard<std::mutex> lock(state_mutex);
+			running = false;
+		}
+	}
 }
 
 void AcceleratorWidgetGL::initializeGL(void){
 	view.init();
+	view.buildLattice(*this); // the lattice is not modified by the simulation thread
 	setWindowTitle("CERN Junior");
 }
 
 void AcceleratorWidgetGL::timerEvent(QTimerEvent*){
-	/* Q_UNUSED(event); */
-	/* double dt(time_factor * stopwatch.restart() / 1000.0); */
-	double dt(timestep/simcst::DEPTH_FACTOR);
-	try{
-		for(int i(1); i <= simcst::DEPTH_FACTOR; ++i) evolve(dt);
-	}catch(std::exception exc){
-		std::cerr << exc.what();
-	}
 	update();
 }
 
@@ -41,28 +80,34 @@ void AcceleratorWidgetGL::resizeGL(int width, int height){
 void AcceleratorWidgetGL::paintGL(void){
 	glClearColor(1.0, 1.0, 1.0, 1.0); // white background color
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	recorder.update();
 	update_pov_matrix();
-	draw();
+	view.draw(recorder.current());
+
+	// for the level of detail of the next frames
+	recorder.setCamera(view.eye());
+	recorder.follow(pov_particle);
 }
 
 void AcceleratorWidgetGL::update_pov_matrix(void){
+	const SceneFrame &frame(recorder.current());
 	if(pov_mode != FREE_POV){
-		if(particles.empty()){
+		if(frame.count == 0){
 			view.initializePosition();
 			pov_mode = FREE_POV;
 			return;
 		}else{
-			pov_particle = pov_particle % particles.size();
+			pov_particle = pov_particle % frame.count;
 		}
 	}
 
 	switch(pov_mode){
 		case THIRD_PERSON:{
-			view.set_third_person_view(*particles[pov_particle]);
+			view.set_third_person_view(frame.followed); // as recorded, when pov_particle was last changed
 			break;
 		}
 		case FIRST_PERSON:{
-			view.set_first_person_view(*particles[pov_particle]);
+			view.set_first_person_view(frame.followed);
 			break;
 		}
 		default: return; // do nothing by default
@@ -126,7 +171,7 @@ void AcceleratorWidgetGL::keyPressEvent(QKeyEvent* event){
 		case Qt::Key_S:
 			-- pov_particle;
 			if(pov_particle < 0){
-				pov_particle += particles.size();
+				pov_particle += recorder.current().count;
 			}
 			break;
 		case Qt::Key_Space:
@@ -140,6 +185,7 @@ void AcceleratorWidgetGL::keyPressEvent(QKeyEvent* event){
 			break;
 		case Qt::Key_M:
 			view.toggle_matrix_mode();
+			record_boxes.store(view.matrix_mode);
 			break;
 		case Qt::Key_1:
 			if(pov_mode == FIRST_PERSON) return;
@@ -180,11 +226,9 @@ void AcceleratorWidgetGL::mouseMoveEvent(QMouseEvent* event){
 }
 
 void AcceleratorWidgetGL::pause(void){
-	if(timerId == 0){
-		timerId = startTimer(20);
-		stopwatch.restart();
-	}else{
-		killTimer(timerId);
-		timerId = 0;
+	{
+		std::lock_guard<std::mutex> lock(state_mutex);
+		running = not running;
 	}
+	state_changed.notify_all();
 }
@@ -2,8 +2,13 @@
 
 #include <QOpenGLWidget>
 #include <QTime>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "opengl_view.h"
+#include "scene.h"
 #include "../general/drawable.h"
 #include "../physics/accelerator.h"
 
@@ -23,11 +28,23 @@ class AcceleratorWidgetGL : public QOpenGLWidget, public Accelerator{
 
 		QPoint lastMousePosition; // for remembering mouse position
 
-		// time control
-		double timestep = simcst::DEFAULT_TIMESTEP;
+		// simulation thread: evolves the accelerator and records it, the GUI thread only drawing the frames recorded
+		SceneRecorder recorder;
+		std::thread simulation;
+		std::mutex state_mutex;
+		std::condition_variable state_changed;
+		bool running = false; // guarded by state_mutex, as is stopping
+		bool stopping = false;
+		std::atomic<bool> record_boxes;
 
-		void increase_speed(void){ timestep *= sqrt(2); }
-		void decrease_speed(void){ timestep /= sqrt(2); }
+		void simulate(void);
+		void stop(void);
+
+		// time control, read by the simulation thread
+		std::atomic<double> timestep;
+
+		void increase_speed(void){ timestep.store(timestep.load()*sqrt(2)); }
+		void decrease_speed(void){ timestep.store(timestep.load()/sqrt(2)); }
 
 		// viewpoint
 		OpenGLView view;
@@ -39,11 +56,13 @@ class AcceleratorWidgetGL : public QOpenGLWidget, public Accelerator{
 		void update_free_pov(QKeyEvent* event);
 		void update_pov_matrix(void);
 
-		// timer
+		// timer, repainting the last frame recorded
 		int timerId;
-		QTime stopwatch;
 	public:
 		AcceleratorWidgetGL(QWidget* parent, Vector3D origin);
 
-		virtual ~AcceleratorWidgetGL(void){}
+		// starts the simulation thread, once the accelerator is initialized: it must not be modified from then on
+		void start(void);
+
+		virtual ~AcceleratorWidgetGL(void){ stop(); }
 };
@@ -5,6 +5,7 @@ CONFIG -= \
 
 CONFIG += \
 	c++11 \
+	thread \
 
 TARGET = cern-junior-graphical
 
@@ -13,9 +14,9 @@ INCLUDEPATH += \
 	../physics \
 
 LIBS += \
+	-L../physics -lphysics \
 	-L../color -lcolor \
 	-L../vector3d -lvector3d \
-	-L../physics -lphysics \
 
 PRE_TARGETDEPS +=\
 	../color/libcolor.a \
@@ -26,13 +27,19 @@ SOURCES += \
 	main_qt_gl.cpp \
 	acceleratorwidgetgl.cpp \
 	glsphere.cpp \
-	opengl_view.cpp
+	opengl_view.cpp \
+	scene.cpp \
+
 
 HEADERS += \
 	acceleratorwidgetgl.h \
 	vertex_shader.h \
 	opengl_view.h \
 	glsphere.h \
+	scene.h \
+	../general/triple_buffer.h \
 
 RESOURCES += \
 	resource.qrc
+
+include(../cernjunior.pri)
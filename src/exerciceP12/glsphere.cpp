@@ -5,9 +5,7 @@
 void GLSphere::initialize(GLuint slices, GLuint stacks){
 	QVector<GLfloat> positions;
 
-	QVector<GLuint> indices0;
-	QVector<GLuint> indices1;
-	QVector<GLuint> indices2;
+	QVector<GLuint> indices;
 
 	GLuint size(2 + slices * (stacks - 1));
 
@@ -31,25 +29,26 @@ void GLSphere::initialize(GLuint slices, GLuint stacks){
 
 	positions << 0.0 << 0.0 << -1.0;
 
-	indices0.reserve(slices+2);
-	for(GLuint i(0); i <= slices; ++i)
-		indices0 << i;
-	indices0 << 1;
+	indices.reserve(3 * 2*slices*(stacks-1));
 
-	indices1.reserve((stacks-2) * 4 * slices);
+	// north cap
+	for(GLuint j(0); j < slices; ++j)
+		indices << 0 << 1+j << 1+(j+1)%slices;
+
+	// each quad of the band between two stacks, as two triangles
 	for(GLuint i(0); i < stacks-2; ++i){
 		for(GLuint j(0); j < slices; ++j){
-			indices1 << 1+i*slices+j;
-			indices1 << 1+(i+1)*slices+j;
-			indices1 << 1+(i+1)*slices+(j+1)%slices;
-			indices1 << 1+i*slices+(j+1)%slices;
+			const GLuint a(1+i*slices+j), b(1+(i+1)*slices+j);
+			const GLuint c(1+(i+1)*slices+(j+1)%slices), d(1+i*slices+(j+1)%slices);
+			indices << a << b << c;
+			indices << a << c << d;
 		}
 	}
 
-	indices2.reserve(slices+2);
-	for(GLuint i(1); i <= slices+1; ++i)
-		indices2 << size-i;
-	indices2 << size-2;
+	// south cap
+	const GLuint last_stack(1+(stacks-2)*slices);
+	for(GLuint j(0); j < slices; ++j)
+		indices << size-1 << last_stack+(j+1)%slices << last_stack+j;
 
 	vbo_sz = 3 * size * sizeof(GLfloat);
 	vbo.create();
@@ -57,33 +56,34 @@ void GLSphere::initialize(GLuint slices, GLuint stacks){
 	vbo.allocate(positions.constData(), vbo_sz);
 	vbo.release();
 
-	ibo_sz[0] = indices0.size() * sizeof(GLuint);
-	ibo_sz[1] = indices1.size() * sizeof(GLuint);
-	ibo_sz[2] = indices2.size() * sizeof(GLuint);
+	ibo_count = indices.size();
 	ibo.create();
 	ibo.bind();
-	ibo.allocate(ibo_sz[0] + ibo_sz[1] + ibo_sz[2]);
-	ibo.write(0                    , indices0.constData(), ibo_sz[0]);
-	ibo.write(ibo_sz[0]            , indices1.constData(), ibo_sz[1]);
-	ibo.write(ibo_sz[0] + ibo_sz[1], indices2.constData(), ibo_sz[2]);
+	ibo.allocate(indices.constData(), ibo_count * sizeof(GLuint));
 	ibo.release();
 }
 
-void GLSphere::draw(QOpenGLShaderProgram& program, int attributeLocation)
+void GLSphere::setup(QOpenGLShaderProgram& program, int attributeLocation)
 {
 	bind();
 
 	program.setAttributeBuffer(attributeLocation, GL_FLOAT, 0, 3);
 	program.enableAttributeArray(attributeLocation);
+}
 
-#define BUFFER_OFFSET(a) ((char*)nullptr + (a))
-
-	glDrawElements(GL_TRIANGLE_FAN, ibo_sz[0] / sizeof(GLuint), GL_UNSIGNED_INT, BUFFER_OFFSET( 0                     ));
-	glDrawElements(GL_QUADS       , ibo_sz[1] / sizeof(GLuint), GL_UNSIGNED_INT, BUFFER_OFFSET( ibo_sz[0]             ));
-	glDrawElements(GL_TRIANGLE_FAN, ibo_sz[2] / sizeof(GLuint), GL_UNSIGNED_INT, BUFFER_OFFSET( ibo_sz[0] + ibo_sz[1] ));
-
+void GLSphere::draw(QOpenGLShaderProgram& program, int attributeLocation)
+{
+	setup(program, attributeLocation);
+	glDrawElements(GL_TRIANGLES, ibo_count, GL_UNSIGNED_INT, nullptr);
 	program.disableAttributeArray(attributeLocation);
+	release();
+}
 
+void GLSphere::drawInstanced(QOpenGLShaderProgram& program, int attributeLocation, QOpenGLExtraFunctions &gl, GLsizei instances)
+{
+	setup(program, attributeLocation);
+	gl.glDrawElementsInstanced(GL_TRIANGLES, ibo_count, GL_UNSIGNED_INT, nullptr, instances);
+	program.disableAttributeArray(attributeLocation);
 	release();
 }
 
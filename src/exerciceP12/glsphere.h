@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QGLBuffer>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
 
+// a unit sphere, as a single list of triangles so that it is drawn by a single call, once or once per instance
 class GLSphere{
 	public:
 		GLSphere() : vbo(QGLBuffer::VertexBuffer), ibo(QGLBuffer::IndexBuffer){}
@@ -10,6 +12,8 @@ class GLSphere{
 		void initialize(GLuint slices = 25, GLuint stacks = 25);
 
 		void draw(QOpenGLShaderProgram& program, int attributeLocation);
+		// the per-instance attributes must already be set up, with their divisors
+		void drawInstanced(QOpenGLShaderProgram& program, int attributeLocation, QOpenGLExtraFunctions &gl, GLsizei instances);
 
 		void bind();
 		void release();
@@ -17,5 +21,7 @@ class GLSphere{
 	private:
 		QGLBuffer vbo, ibo;
 		GLuint vbo_sz;
-		GLuint ibo_sz[3];
+		GLsizei ibo_count;
+
+		void setup(QOpenGLShaderProgram& program, int attributeLocation);
 };
@@ -1,6 +1,7 @@
 #include <QMainWindow>
 #include <QInputDialog> // for dialog boxes
 #include <QApplication>
+#include <QSurfaceFormat>
 #include <vector>
 #include <cmath>
 
@@ -10,6 +11,13 @@
 using namespace std;
 
 int main(int argc, char* argv[]){
+	// OpenGL 3.3 for instancing (see OpenGLView), in the compatibility profile for the quads and glBegin; if the driver
+	// offers less, the particles are drawn one by one
+	QSurfaceFormat format;
+	format.setVersion(3, 3);
+	format.setProfile(QSurfaceFormat::CompatibilityProfile);
+	QSurfaceFormat::setDefaultFormat(format);
+
 	QApplication a(argc, argv);
 
 	AcceleratorWidgetGL w(nullptr, Vector3D(3,2,0));
@@ -20,6 +28,7 @@ int main(int argc, char* argv[]){
 	cli::offer_keybindings();
 
 	w.initialize();
+	w.start();
 	w.show();
 
 	return a.exec();
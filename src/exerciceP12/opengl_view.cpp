@@ -1,4 +1,7 @@
 #include <cmath> // for trig functions
+#include <cstddef> // for offsetof
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
 
 #include "opengl_view.h"
 #include "vertex_shader.h"
@@ -19,9 +22,12 @@ void OpenGLView::setShaderPoint(const Vector3D &point){
 	prog.setAttributeValue(VertexId, point[0], point[1], point[2]);
 }
 
-void OpenGLView::draw(const Box &to_draw){
-	std::array<Vector3D,8> points(to_draw.getVertices());
+void OpenGLView::resetShaderTransform(void){
+	prog.setAttributeValue(OffsetId, 0.0f, 0.0f, 0.0f);
+	prog.setAttributeValue(ScaleId, 1.0f);
+}
 
+void OpenGLView::draw(const std::array<Vector3D,8> &points){
 	prog.setUniformValue("view", pov_matrix);
 	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -32,32 +38,75 @@ void OpenGLView::draw(const Box &to_draw){
 	glEnd();
 }
 
-void OpenGLView::draw(const Beam &){
-	// TODO draw ellipses
-}
+void OpenGLView::draw(const std::vector<ParticleSprite> &particles){
+	if(particles.empty()) return;
 
-void OpenGLView::draw(const Particle &to_draw){
-	setShaderColor(to_draw.getColor());
-	drawSphere(to_draw, to_draw.getRadius());
-}
+	prog.setUniformValue("view", pov_matrix);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-void OpenGLView::draw(const Element &to_draw){
-	if(matrix_mode){
-		setShaderColor(RGB::PURPLE);
-		to_draw.draw_tree();
+	if(not instancing){
+		for(const auto &p : particles){
+			prog.setAttributeValue(ColorId, p.color[0], p.color[1], p.color[2]);
+			prog.setAttributeValue(OffsetId, p.position[0], p.position[1], p.position[2]);
+			prog.setAttributeValue(ScaleId, p.radius);
+			sphere.draw(prog, VertexId);
+		}
+		resetShaderTransform();
+		return;
+	}
+
+	// the frame is uploaded as it is, each sprite being an instance
+	QOpenGLExtraFunctions &gl(*QOpenGLContext::currentContext()->extraFunctions());
+	constexpr int stride(sizeof(ParticleSprite));
+	instances.bind();
+	instances.allocate(particles.data(), particles.size() * stride);
+	prog.setAttributeBuffer(OffsetId, GL_FLOAT, offsetof(ParticleSprite, position), 3, stride);
+	prog.setAttributeBuffer(ColorId, GL_FLOAT, offsetof(ParticleSprite, color), 3, stride);
+	prog.setAttributeBuffer(ScaleId, GL_FLOAT, offsetof(ParticleSprite, radius), 1, stride);
+	for(int id : {OffsetId, ColorId, ScaleId}){
+		prog.enableAttributeArray(id);
+		gl.glVertexAttribDivisor(id, 1);
 	}
+	instances.release();
 
-	setShaderColor(*to_draw.getColor());
-	if(to_draw.is_straight()) drawStraightElement(to_draw);
-	else drawCurvedElement(to_draw);
+	sphere.drawInstanced(prog, VertexId, gl, particles.size());
+
+	for(int id : {OffsetId, ColorId, ScaleId}){
+		gl.glVertexAttribDivisor(id, 0);
+		prog.disableAttributeArray(id);
+	}
+	resetShaderTransform();
 }
 
-void OpenGLView::draw(const Accelerator &to_draw){
-	/* to_draw.draw_beams(); */
+void OpenGLView::drawPoints(const std::vector<ParticleSprite> &sprites, float size){
+	if(sprites.empty()) return;
+
+	constexpr int stride(sizeof(ParticleSprite));
+	prog.setUniformValue("view", pov_matrix);
+	glPointSize(size);
+
+	instances.bind();
+	instances.allocate(sprites.data(), sprites.size() * stride);
+	prog.setAttributeBuffer(VertexId, GL_FLOAT, offsetof(ParticleSprite, position), 3, stride);
+	prog.setAttributeBuffer(ColorId, GL_FLOAT, offsetof(ParticleSprite, color), 3, stride);
+	prog.enableAttributeArray(VertexId);
+	prog.enableAttributeArray(ColorId);
+	glDrawArrays(GL_POINTS, 0, sprites.size());
+	prog.disableAttributeArray(ColorId);
+	prog.disableAttributeArray(VertexId);
+	instances.release();
+}
 
-	to_draw.draw_elements();
-	if(not matrix_mode){
-		to_draw.draw_particles();
+void OpenGLView::draw(const SceneFrame &frame){
+	drawLattice();
+
+	if(matrix_mode){
+		setShaderColor(RGB::PURPLE);
+		for(const auto &box : frame.boxes) draw(box);
+	}else{
+		draw(frame.particles);
+		drawPoints(frame.points, 2.0);
+		drawPoints(frame.density, 4.0);
 	}
 }
 
@@ -78,6 +127,8 @@ void OpenGLView::init(void){
 
 	prog.bindAttributeLocation("vertex", VertexId);
 	prog.bindAttributeLocation("color", ColorId);
+	prog.bindAttributeLocation("offset", OffsetId);
+	prog.bindAttributeLocation("scale", ScaleId);
 
 	// compiles
 	prog.link();
@@ -91,19 +142,41 @@ void OpenGLView::init(void){
 	glEnable(GL_LINE_SMOOTH);
 	glLineWidth(0.1);
 
-	sphere.initialize();
+	resetShaderTransform();
+
+	// instancing is core from OpenGL 3.3 on (see main_qt_gl.cpp for the context requested)
+	instancing = QOpenGLContext::currentContext()->format().version() >= qMakePair(3, 3);
+	instances.setUsagePattern(QGLBuffer::StreamDraw);
+	instances.create();
+
+	sphere.initialize(16, 12); // the particles being small, and possibly many
 	initializePosition();
 }
 
+void OpenGLView::buildLattice(const Accelerator &a){
+	QVector<GLfloat> mesh;
+	for(size_t i(0); i < a.element_count(); ++i){
+		const Element &E(a.getElement(i));
+		if(E.is_straight()) addStraightElement(mesh, E);
+		else addCurvedElement(mesh, E);
+	}
+
+	if(not lattice.isCreated()) lattice.create();
+	lattice.bind();
+	lattice.allocate(mesh.constData(), mesh.size() * sizeof(GLfloat));
+	lattice.release();
+	lattice_vertices = mesh.size() / 6;
+}
+
 void OpenGLView::initializePosition(){
 	pov_matrix.setToIdentity();
 	pov_matrix.translate(0.0, 0.0, -5.0);
 }
 
-void OpenGLView::set_first_person_view(const Particle &p){
+void OpenGLView::set_first_person_view(const ParticleSprite &p){
 	pov_matrix.setToIdentity();
 
-	Vector3D center_point(p + p.getRadius()*(p.getVelocity().unitary() + vctr::Z_VECTOR));
+	Vector3D center_point(p.getPosition() + p.radius*(p.getVelocity().unitary_or(vctr::X_VECTOR) + vctr::Z_VECTOR));
 	Vector3D focal_point(center_point + p.getVelocity());
 
 	QVector3D eye(center_point[0], center_point[1], center_point[2]);
@@ -113,10 +186,15 @@ void OpenGLView::set_first_person_view(const Particle &p){
 	pov_matrix.lookAt(eye, center, up);
 }
 
-void OpenGLView::set_third_person_view(const Particle &p){
+Vector3D OpenGLView::eye(void) const{
+	const QVector3D x(pov_matrix.inverted().map(QVector3D(0.0, 0.0, 0.0)));
+	return Vector3D(x.x(), x.y(), x.z());
+}
+
+void OpenGLView::set_third_person_view(const ParticleSprite &p){
 	initializePosition();
 
-	translate(p);
+	translate(p.getPosition());
 	translate(0,0,4);
 }
 
@@ -143,7 +221,25 @@ void OpenGLView::drawSphere(const Vector3D &x, double r){
 	sphere.draw(prog, VertexId);
 }
 
-void OpenGLView::drawCylinder(const Vector3D &basepoint, const Vector3D &direction, double radius){
+void OpenGLView::drawLattice(void){
+	if(not lattice_vertices) return;
+
+	constexpr int stride(6 * sizeof(GLfloat));
+	prog.setUniformValue("view", pov_matrix);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+	lattice.bind();
+	prog.setAttributeBuffer(VertexId, GL_FLOAT, 0, 3, stride);
+	prog.setAttributeBuffer(ColorId, GL_FLOAT, 3 * sizeof(GLfloat), 3, stride);
+	prog.enableAttributeArray(VertexId);
+	prog.enableAttributeArray(ColorId);
+	glDrawArrays(GL_QUADS, 0, lattice_vertices);
+	prog.disableAttributeArray(ColorId);
+	prog.disableAttributeArray(VertexId);
+	lattice.release();
+}
+
+void OpenGLView::addCylinder(QVector<GLfloat> &mesh, const Vector3D &basepoint, const Vector3D &direction, double radius, const RGB &color){
 	Vector3D u(direction.unitary());
 	Vector3D v(radius*u.orthogonal());
 	u = u^v;
@@ -151,24 +247,20 @@ void OpenGLView::drawCylinder(const Vector3D &basepoint, const Vector3D &directi
 	const double lambda(QUAD_LENGTH/radius);
 	const int num_quads(ceil(2*M_PI/lambda));
 
-	QMatrix4x4 translation;
-	translation.translate(basepoint[0], basepoint[1], basepoint[2]);
-	prog.setUniformValue("view", pov_matrix * translation);
+	auto vertex = [&](const Vector3D &X){ mesh << X[0] << X[1] << X[2] << color[0] << color[1] << color[2]; };
 
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-	glBegin(GL_QUAD_STRIP);
-	for(int i(0); i <= num_quads; ++i){
-		Vector3D P(cos(i*lambda)*u + sin(i*lambda)*v);
-		Vector3D Q(P + direction);
-
-		glVertex3d(P[0], P[1], P[2]);
-		glVertex3d(Q[0], Q[1], Q[2]);
+	Vector3D P(basepoint + u);
+	for(int i(1); i <= num_quads; ++i){
+		const Vector3D next(basepoint + cos(i*lambda)*u + sin(i*lambda)*v);
+		vertex(P);
+		vertex(P + direction);
+		vertex(next + direction);
+		vertex(next);
+		P = next;
 	}
-	glEnd();
 }
 
-void OpenGLView::drawCurvedElement(const Element &E){
+void OpenGLView::addCurvedElement(QVector<GLfloat> &mesh, const Element &E){
 	try{
 		const Vector3D center(E.center());
 		const Vector3D p1(E.getEntry_point());
@@ -187,13 +279,13 @@ void OpenGLView::drawCurvedElement(const Element &E){
 		for(int i(0); i < num_cylinders; i += GAP_RATIO){
 			double alpha(i * theta / num_cylinders);
 			Vector3D base(center + major_radius*(cos(alpha)*u + sin(alpha)*v));
-			drawCylinder(base, TUBE_HEIGHT*(sin(alpha)*u - cos(alpha)*v), minor_radius);
+			addCylinder(mesh, base, TUBE_HEIGHT*(sin(alpha)*u - cos(alpha)*v), minor_radius, *E.getColor());
 		}
 	}
 	catch(std::exception){ throw excptn::ELEMENT_DEGENERATE_GEOMETRY; }
 }
 
-void OpenGLView::drawStraightElement(const Element &E){
+void OpenGLView::addStraightElement(QVector<GLfloat> &mesh, const Element &E){
 	const Vector3D direction(E.getExit_point() - E.getEntry_point());
 	const double d(direction.norm());
 
@@ -204,6 +296,6 @@ void OpenGLView::drawStraightElement(const Element &E){
 	const Vector3D base(E.getEntry_point());
 
 	for(int i(0); i < num_cylinders; i += GAP_RATIO){
-		drawCylinder(base + i*small_direction, small_direction, r);
+		addCylinder(mesh, base + i*small_direction, small_direction, r, *E.getColor());
 	}
 }
@@ -1,40 +1,60 @@
 #pragma once
 
 #include <QOpenGLShaderProgram> // shaders
+#include <QGLBuffer>
 #include <QMatrix4x4>
+#include <QVector>
 
 #include "../color/rgb.h"
 #include "../vector3d/vector3d.h"
 
 #include "glsphere.h"
-#include "canvas.h"
+#include "scene.h"
 
-class OpenGLView : public Canvas{
+class Element;
+class Accelerator;
+
+// draws the frames recorded by a SceneRecorder and the lattice of the accelerator, on the GUI thread
+class OpenGLView{
 	private:
 		// OpenGL shader in Qt class
 		QOpenGLShaderProgram prog;
 		GLSphere sphere;
 
+		// the particles of the frame, uploaded once per frame and drawn by a single instanced call (one call per particle
+		// if the context is older than OpenGL 3.3)
+		QGLBuffer instances;
+		bool instancing = false;
+
+		// the tubes of the elements, built once by buildLattice: positions and colors, 4 vertices per quad
+		QGLBuffer lattice;
+		GLsizei lattice_vertices = 0;
+
 		// Camera
 		QMatrix4x4 pov_matrix;
 	public:
 		// to be a little more efficient
 		void setShaderColor(const RGB &color);
 		void setShaderPoint(const Vector3D &point);// TODO do we need this?
+		void resetShaderTransform(void); // for everything but the particles, which are placed by the instance attributes
 
-		// drawing methods, inherited from Canvas
-		virtual void draw(const Box &to_draw) override;
-		virtual void draw(const Particle &to_draw) override;
-		virtual void draw(const Beam &to_draw) override;
-		virtual void draw(const Element &to_draw) override;
-		virtual void draw(const Accelerator &to_draw) override;
+		OpenGLView(void) : instances(QGLBuffer::VertexBuffer), lattice(QGLBuffer::VertexBuffer){}
+
+		// drawing methods: the lattice does not change once initialized, so it is built once from the accelerator,
+		// whereas the particles and the trees come from the frame
+		void draw(const std::array<Vector3D,8> &box);
+		void draw(const std::vector<ParticleSprite> &particles); // as spheres
+		void drawPoints(const std::vector<ParticleSprite> &sprites, float size); // size in pixels
+		void draw(const SceneFrame &frame); // with the level of detail chosen by the recorder (see SceneRecorder)
 
 		// initalization methods
 		void init(void);
+		void buildLattice(const Accelerator &a); // once initialized, with a current context
 		void initializePosition(void);
 
-		void set_third_person_view(const Particle &p);
-		void set_first_person_view(const Particle &p);
+		void set_third_person_view(const ParticleSprite &p);
+		void set_first_person_view(const ParticleSprite &p);
+		Vector3D eye(void) const; // position of the camera
 
 		// setters
 		void setProjection(QMatrix4x4 const& projection){ prog.setUniformValue("projection", projection); }
@@ -49,9 +69,10 @@ class OpenGLView : public Canvas{
 
 		// drawing
 		void drawSphere(const Vector3D &x, double r);
+		void drawLattice(void);
 
-		void drawCylinder(const Vector3D &basepoint, const Vector3D &direction, double radius);
-
-		void drawStraightElement(const Element &E);
-		void drawCurvedElement(const Element &E);
+		// append the quads of the tubes to mesh (see lattice)
+		void addCylinder(QVector<GLfloat> &mesh, const Vector3D &basepoint, const Vector3D &direction, double radius, const RGB &color);
+		void addStraightElement(QVector<GLfloat> &mesh, const Element &E);
+		void addCurvedElement(QVector<GLfloat> &mesh, const Element &E);
 };
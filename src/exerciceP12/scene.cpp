@@ -0,0 +1,147 @@
+#include "scene.h"
+
+#include <algorithm> // for min, max
+#include <cmath>
+
+#include "../misc/constants.h"
+#include "../physics/accelerator.h"
+
+using namespace simcst;
+
+namespace{
+	ParticleSprite sprite(const Particle &p){
+		const RGB color(p.getColor());
+		const Vector3D v(p.getVelocity());
+		return {
+			{float(p[0]), float(p[1]), float(p[2])},
+			{float(color[0]), float(color[1]), float(color[2])},
+			float(p.getRadius()),
+			{float(v[0]), float(v[1]), float(v[2])}
+		};
+	}
+
+	// from blue (fewest particles) to red, then yellow (most)
+	void heat(double t, float color[3]){
+		t = std::min(std::max(t, 0.0), 1.0);
+		if(t < 0.5){
+			color[0] = 2.0*t;
+			color[1] = 0.0;
+			color[2] = 1.0 - 2.0*t;
+		}else{
+			color[0] = 1.0;
+			color[1] = 2.0*t - 1.0;
+			color[2] = 0.0;
+		}
+	}
+}
+
+void SceneRecorder::record(const Accelerator &a, bool with_boxes){
+	if(counts.empty()) layout_grid(a);
+
+	camera.update();
+	eye = camera.read_buffer();
+
+	frame = &frames.write_buffer();
+	frame->clear();
+	frame->step = a.getStep();
+	frame->time = a.getTime();
+	boxes = with_boxes;
+	target = a.particle_count() ? followed.load(std::memory_order_relaxed) % a.particle_count() : 0;
+
+	draw(a);
+	flush_bins();
+
+	frame = nullptr;
+	frames.publish();
+}
+
+void SceneRecorder::layout_grid(const Accelerator &a){
+	double low[3] = {-1.0, -1.0, -1.0}, high[3] = {1.0, 1.0, 1.0}; // if there is no element
+	for(size_t i(0); i < a.element_count(); ++i){
+		const Element &E(a.getElement(i));
+		std::vector<Vector3D> corners{E.getEntry_point(), E.getExit_point()};
+		double margin(E.getRadius());
+		if(not E.is_straight()){ // the whole circle, which is more than the arc but simpler
+			corners.push_back(E.center());
+			margin += Vector3D::distance(E.center(), E.getEntry_point());
+		}
+		for(const Vector3D &x : corners){
+			for(int k(0); k < 3; ++k){
+				if(i == 0 and &x == &corners.front()) low[k] = high[k] = x[k];
+				low[k] = std::min(low[k], x[k] - margin);
+				high[k] = std::max(high[k], x[k] + margin);
+			}
+		}
+	}
+	lower = Vector3D(low[0], low[1], low[2]);
+
+	cell = DENSITY_CELL;
+	while(true){
+		size_t total(1);
+		for(int k(0); k < 3; ++k){
+			cells[k] = std::max<size_t>(1, std::ceil((high[k] - low[k])/cell));
+			total *= cells[k];
+		}
+		if(total <= DENSITY_MAX_CELLS) break;
+		cell *= 1.25;
+	}
+	counts.assign(cells[0]*cells[1]*cells[2], 0);
+}
+
+void SceneRecorder::bin(const Vector3D &x){
+	size_t index(0);
+	for(int k(2); k >= 0; --k){ // the particles out of the grid are counted in the bins of its border
+		const double c(std::floor((x[k] - lower[k])/cell));
+		index = index*cells[k] + size_t(std::min(std::max(c, 0.0), double(cells[k] - 1)));
+	}
+	if(counts[index]++ == 0) nonempty.push_back(index);
+}
+
+void SceneRecorder::flush_bins(void){
+	unsigned int most(0);
+	for(size_t index : nonempty) most = std::max(most, counts[index]);
+
+	frame->density.reserve(nonempty.size());
+	for(size_t index : nonempty){
+		ParticleSprite s{};
+		size_t rest(index);
+		for(int k(0); k < 3; ++k){
+			s.position[k] = lower[k] + cell*(rest % cells[k] + 0.5);
+			rest /= cells[k];
+		}
+		heat(std::log1p(counts[index])/std::log1p(most), s.color);
+		s.radius = 0.5*cell;
+		frame->density.push_back(s);
+		counts[index] = 0;
+	}
+	nonempty.clear();
+}
+
+void SceneRecorder::draw(const Box &to_draw){
+	if(frame) frame->boxes.push_back(to_draw.getVertices());
+}
+
+void SceneRecorder::draw(const Particle &to_draw){
+	if(not frame) return;
+	if(frame->count++ == target) frame->followed = sprite(to_draw);
+	if(boxes) return; // only counted, the trees being drawn instead
+
+	const double d2(Vector3D::distance2(to_draw, eye));
+	if(d2 < LOD_SPHERE_DISTANCE*LOD_SPHERE_DISTANCE and frame->particles.size() < LOD_MAX_SPHERES){
+		frame->particles.push_back(sprite(to_draw));
+	}else if(d2 < LOD_POINT_DISTANCE*LOD_POINT_DISTANCE and frame->points.size() < LOD_MAX_POINTS){
+		frame->points.push_back(sprite(to_draw));
+	}else{
+		bin(to_draw);
+	}
+}
+
+void SceneRecorder::draw(const Element &to_draw){
+	if(frame and boxes) to_draw.draw_tree();
+}
+
+void SceneRecorder::draw(const Accelerator &to_draw){
+	if(not frame) return;
+	if(boxes) to_draw.draw_elements();
+	to_draw.draw_particles(); // counted in matrix mode too, for the view to follow them
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "../vector3d/vector3d.h"
+#include "../general/triple_buffer.h"
+#include "canvas.h"
+
+// what the view needs of a particle, copied out of the accelerator so that it can be drawn while the simulation goes on;
+// in single precision, as the frame is uploaded as it is to the instance buffer of the view (see OpenGLView)
+struct ParticleSprite{
+	float position[3];
+	float color[3];
+	float radius;
+	float velocity[3];
+
+	Vector3D getPosition(void) const{ return Vector3D(position[0], position[1], position[2]); }
+	Vector3D getVelocity(void) const{ return Vector3D(velocity[0], velocity[1], velocity[2]); }
+};
+
+// the state of the accelerator drawn by a frame, the lattice aside since it does not change once initialized; its size
+// is bounded whatever the number of particles (see SceneRecorder)
+struct SceneFrame{
+	unsigned long step = 0;
+	double time = 0.0;
+	size_t count = 0; // of the particles, however they are drawn
+	ParticleSprite followed; // the particle followed by the view (see SceneRecorder::follow), if count
+
+	std::vector<ParticleSprite> particles; // near the camera, drawn as spheres
+	std::vector<ParticleSprite> points; // further, drawn as points
+	std::vector<ParticleSprite> density; // the other ones, as the centers of the nonempty bins, colored by their count
+	std::vector<std::array<Vector3D,8>> boxes; // of the leaves of the trees, in matrix mode only
+
+	void clear(void){
+		count = 0;
+		particles.clear(); // keeping the capacity, the frames being recycled by the triple buffer
+		points.clear();
+		density.clear();
+		boxes.clear();
+	}
+};
+
+/*
+ * The canvas of an accelerator that runs on a thread of its own (see AcceleratorWidgetGL): drawing the accelerator
+ * on that thread fills the back frame of the triple buffer, which the view then takes from the GUI thread.
+ *
+ * The level of detail is chosen here, from the last position of the camera given by the view, so that the view only
+ * ever gets a bounded frame: the particles closer than LOD_SPHERE_DISTANCE are recorded as spheres, up to
+ * LOD_MAX_SPHERES of them, then the ones closer than LOD_POINT_DISTANCE as points, up to LOD_MAX_POINTS, and all the
+ * others are counted in the bins of a grid over the lattice.
+ */
+class SceneRecorder : public Canvas{
+	private:
+		TripleBuffer<SceneFrame> frames;
+		SceneFrame* frame = nullptr; // being filled, while drawing
+		bool boxes = false;
+
+		// given by the GUI thread
+		TripleBuffer<Vector3D> camera;
+		std::atomic<size_t> followed;
+
+		// while recording
+		Vector3D eye;
+		size_t target = 0; // index of the followed particle
+
+		// density grid, laid out over the lattice at the first record
+		Vector3D lower;
+		double cell = 0.0;
+		size_t cells[3] = {0, 0, 0};
+		std::vector<unsigned int> counts;
+		std::vector<size_t> nonempty; // indices of the bins counted in this frame, to clear them
+
+		void layout_grid(const Accelerator &a);
+		void bin(const Vector3D &x);
+		void flush_bins(void);
+
+	public:
+		SceneRecorder(void) : Canvas(), followed(0){}
+		virtual ~SceneRecorder(void){}
+
+		// simulation thread: records the accelerator (the leaves of its trees as well if with_boxes) and publishes it
+		void record(const Accelerator &a, bool with_boxes);
+
+		// GUI thread: the last frame published (see TripleBuffer)
+		bool update(void){ return frames.update(); }
+		const SceneFrame& current(void) const{ return frames.read_buffer(); }
+
+		// GUI thread: where the camera is, for the level of detail of the next frames, and which particle they follow
+		void setCamera(const Vector3D &position){ camera.write_buffer() = position; camera.publish(); }
+		void follow(size_t index){ followed.store(index, std::memory_order_relaxed); }
+
+		virtual void draw(const Box &to_draw) override;
+		virtual void draw(const Particle &to_draw) override;
+		virtual void draw(const Beam &) override{}
+		virtual void draw(const Element &to_draw) override;
+		virtual void draw(const Accelerator &to_draw) override;
+};
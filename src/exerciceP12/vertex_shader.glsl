@@ -1,5 +1,7 @@
 attribute vec3 vertex;
 attribute vec3 color;
+attribute vec3 offset;
+attribute float scale;
 
 uniform mat4 projection;
 uniform mat4 view;
@@ -7,6 +9,6 @@ uniform mat4 view;
 varying vec3 my_color;
 
 void main(){
-	gl_Position = projection * view * vec4(vertex, 1.0);
+	gl_Position = projection * view * vec4(offset + scale * vertex, 1.0);
 	my_color = color;
 }
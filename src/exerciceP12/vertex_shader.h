@@ -3,4 +3,6 @@
 enum Vertex_Shader_Attribute_Id {
 	VertexId = 0,
 	ColorId,
+	OffsetId, // per instance when drawing the particles, (0,0,0) otherwise
+	ScaleId, // per instance when drawing the particles, 1 otherwise
 };
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * Hands values over from one writer thread to one reader thread without locks or waits: the writer fills the back
+ * buffer and publishes it, the reader takes the latest published buffer as its front buffer, and the third one sits
+ * in between. Neither side ever waits for the other, the writer overwriting the published value if the reader has
+ * not taken it yet, and the reader keeping its front buffer until a newer one is published.
+ */
+template<typename T>
+class TripleBuffer{
+	private:
+		static constexpr unsigned int FRESH = 4; // set on the middle index while the reader has not taken it
+
+		T buffers[3];
+		std::atomic<unsigned int> middle; // index of the buffer in between, with FRESH
+		unsigned int back = 0; // the writer's
+		unsigned int front = 2; // the reader's
+
+	public:
+		TripleBuffer(void) : middle(1){}
+
+		TripleBuffer(const TripleBuffer &to_copy) = delete;
+		TripleBuffer& operator=(const TripleBuffer &to_copy) = delete;
+
+		// writer side: the buffer to fill, which keeps what it held two publications ago so that its memory is reused
+		T& write_buffer(void){ return buffers[back]; }
+		void publish(void){ back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH; }
+
+		// reader side: takes the last published buffer if there is a new one, and tells whether there was
+		bool update(void){
+			if(not (middle.load(std::memory_order_relaxed) & FRESH)) return false;
+			front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+			return true;
+		}
+		const T& read_buffer(void) const{ return buffers[front]; }
+};
+
+template<typename T> constexpr unsigned int TripleBuffer<T>::FRESH;
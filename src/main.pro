@@ -5,6 +5,12 @@ SUBDIRS += \
 	vector3d \
 	physics \
 	textview \
+	snapshot \
+	batch \
+	ensemble \
 #	cern-junior-text \
+	cern-junior-batch \
 	tests \
+	benchmarks \
+	cern-junior-barnes-hut \
 	exerciceP12 \
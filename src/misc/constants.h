@@ -11,6 +11,7 @@ namespace phcst{ // physical constants
 
 	constexpr double MASS_PROTON_GEV_C2(0.938272);
 	constexpr double MASS_ELECTRON_GEV_C2(5.10999e-4);
+	constexpr double MASS_ALPHA_GEV_C2(3.727379); // helium-4 nucleus
 
 	constexpr double EPSILON_0_USI(8.854187e-12);
 	constexpr double K(0.25/(M_PI*EPSILON_0_USI)); // used for calculating electromagnetic interactions between particles
@@ -20,6 +21,9 @@ namespace simcst{ // simulation constants
 	constexpr double DEFAULT_TIMESTEP(1e-11);
 	constexpr int DEPTH_FACTOR(5); // number of intermediate updates between each timestep (higher = more precise)
 
+	constexpr unsigned int MAX_BLOCK_LEVELS(20); // finest block timestep is dt/2^MAX_BLOCK_LEVELS
+	constexpr double DEFAULT_MAX_DEFLECTION(1e-3); // relative error of the momentum allowed in one block timestep (see Accelerator::evolve)
+
 	constexpr double ZERO_CHARGE(1.6e-19);
 
 	constexpr double ZERO_TIME(1e-30);
@@ -33,7 +37,7 @@ namespace simcst{ // simulation constants
 	constexpr double DEFAULT_RADIUS(1.0);
 	constexpr double DEFAULT_CHARGE(1.0);
 
-	constexpr double BARNES_HUT_THETA(0.5);
+	constexpr double BARNES_HUT_THETA(0.5); // default opening angle of the trees, see Accelerator::setBarnes_hut_theta
 
 	constexpr double SMOOTHING_CONSTANT(1e-50);
 
@@ -52,4 +56,15 @@ namespace simcst{ // simulation constants
 	constexpr double REPRESENTED_RADIUS_DEFAULT(0.01);
 	constexpr double REPRESENTED_RADIUS_ELECTRON(0.01);
 	constexpr double REPRESENTED_RADIUS_PROTON(0.01);
+
+	// level of detail of the graphical view (see SceneRecorder): spheres near the camera, points further, density bins
+	// beyond, or for the particles over the counts given
+	constexpr double LOD_SPHERE_DISTANCE(1.0);
+	constexpr double LOD_POINT_DISTANCE(8.0);
+	constexpr unsigned int LOD_MAX_SPHERES(1 << 13);
+	constexpr unsigned int LOD_MAX_POINTS(1 << 16);
+	constexpr double DENSITY_CELL(0.05); // side of the density bins, enlarged if there would be more than DENSITY_MAX_CELLS
+	constexpr unsigned int DENSITY_MAX_CELLS(1 << 20);
+
+	constexpr unsigned int MAX_SPECIES(256); // species ids are stored in one byte
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <stdexcept>
 
 namespace excptn{
 	const std::invalid_argument ZERO_VECTOR_UNITARY("Could not normalize zero-vector");
@@ -8,7 +9,12 @@ namespace excptn{
 	const std::out_of_range BAD_VECTOR3D_ACCESS("Could not access Vector3D's i-th coordinates for i≠0,1,2");
 	const std::out_of_range BAD_RGB_ACCESS("Could not access RGB's i-th value for i≠0,1,2");
 
+	const std::invalid_argument UNKNOWN_MATH_KERNEL("Unknown math kernel (expected libm, scalar, avx2, avx512 or fast)");
+	const std::invalid_argument UNSUPPORTED_MATH_KERNEL("Math kernel not supported by this processor");
+
 	const std::invalid_argument UNRECOGNIZED_PARTICLE_CODE("Unrecognized particle code");
+	const std::invalid_argument DUPLICATE_PARTICLE_CODE("A species with this particle code is already registered");
+	const std::length_error TOO_MANY_SPECIES("At most MAX_SPECIES particle species can be registered");
 
 	const std::invalid_argument ZERO_CURVATURE_CENTER("Center of circle with zero curvature is undefined");
 	const std::invalid_argument ZERO_CURVATURE_DIPOLE("Dipole must have nonzero curvature");
@@ -17,4 +23,17 @@ namespace excptn{
 	const std::invalid_argument ACCELERATOR_DEGENERATE_GEOMETRY("Invalid element geometric parameters");
 	const std::invalid_argument NON_MATCHING_LINK_POINTS("Consectuive elements must have matching link points");
 	const std::invalid_argument ILLEGAL_ACCESS("Attempted illegal deletion of data");
+
+	const std::invalid_argument BAD_REFERENCE_PARTICLE("Reference particle must be charged and moving");
+	const std::invalid_argument PARTICLE_OUTSIDE_LATTICE("Particle is not moving forward in an element");
+	const std::domain_error UNSTABLE_OPTICS("One-turn map has no periodic solution (unstable optics)");
+	const std::length_error TOO_MANY_LENSES("A FODO cell in the element table has at most ElementRecord::MAX_LENSES parts");
+	const std::invalid_argument BAD_BARNES_HUT_THETA("The Barnes-Hut opening angle must be positive or zero");
+	const std::invalid_argument BAD_BLOCK_TIMESTEPS("Block timesteps need a positive deflection and at most MAX_BLOCK_LEVELS levels");
+
+	const std::runtime_error SNAPSHOT_FILE_ERROR("Could not open or write snapshot file");
+	const std::runtime_error SNAPSHOT_BAD_FORMAT("Malformed or truncated snapshot file");
+	const std::logic_error SNAPSHOT_WRITER_CLOSED("Snapshot committed to a closed writer");
+	const std::runtime_error TRACE_FILE_ERROR("Could not open or write trace file");
+	const std::invalid_argument BAD_TRACE_CAPACITY("A trace buffer holds at least one event");
 }
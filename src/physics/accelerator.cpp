@@ -1,6 +1,10 @@
 #include "accelerator.h"
 #include "beam.h"
 
+#include <algorithm> // for max and min
+#include <cmath> // for ceil and log2
+#include <map>
+
 void Accelerator::weld(void){
 	const int N(size());
 	if(N <= 1) return;
@@ -9,13 +13,71 @@ void Accelerator::weld(void){
 		if((*this)[i]->getExit_point() != (*this)[i+1]->getEntry_point()){
 			throw excptn::NON_MATCHING_LINK_POINTS;
 		}
+		(*this)[i]->setIndex(i);
 		(*this)[i]->setSuccessor((*this)[i+1].get());
 		(*this)[i+1]->setPredecessor((*this)[i].get());
 	}
+	back()->setIndex(N-1);
 	back()->setSuccessor(front().get());
 	front()->setPredecessor(back().get());
 }
 
+void Accelerator::compile(void){
+	// Fuses the welded lattice into fewer elements, so that particles cross fewer boundaries:
+	// each focusing quadrupole, straight section, defocusing quadrupole and straight section in a row (as made by
+	// addFodoCell) becomes a FodoCell, and consecutive collinear straight sections become one.
+	// The particles already placed are moved to the element that replaces theirs.
+	// Finally, the element table used by evolve() is made from the compiled lattice.
+	std::vector<std::unique_ptr<Element>> &elements(*this);
+	std::vector<std::unique_ptr<Element>> compiled;
+	std::map<const Element*, Element*> replaced;
+
+	std::vector<const Element*> fused; // the elements before compilation, since those fused into a cell are moved into it
+	for(const auto &e : elements) fused.push_back(e.get());
+
+	const auto is_a = [&elements](size_t i, bool quadrupole){
+		const Element* e(elements[i].get());
+		return quadrupole ? dynamic_cast<const Quadrupole*>(e) != nullptr : dynamic_cast<const StraightSection*>(e) != nullptr;
+	};
+	const auto aligned = [&elements](size_t i, size_t j){ return elements[i]->is_aligned_with(*elements[j]); };
+
+	size_t i(0);
+	while(i < elements.size()){
+		size_t n(1); // number of elements fused into the next compiled one
+		if(i + 3 < elements.size() and is_a(i, true) and is_a(i+1, false) and is_a(i+2, true) and is_a(i+3, false)
+			and aligned(i, i+1) and aligned(i, i+2) and aligned(i, i+3)){
+			n = 4;
+		}else if(is_a(i, false)){
+			while(i + n < elements.size() and is_a(i+n, false) and aligned(i, i+n)) ++n;
+		}
+
+		if(n == 1){
+			compiled.push_back(std::move(elements[i]));
+		}else if(is_a(i, true)){
+			std::vector<std::unique_ptr<Element>> parts;
+			for(size_t k(i); k < i + n; ++k) parts.push_back(std::move(elements[k]));
+			compiled.push_back(std::unique_ptr<Element>(new FodoCell(canvas, std::move(parts), time)));
+		}else{
+			compiled.push_back(std::unique_ptr<Element>(new StraightSection(canvas, elements[i]->getEntry_point(), elements[i+n-1]->getExit_point(), elements[i]->getRadius(), time)));
+		}
+
+		for(size_t k(i); k < i + n and n > 1; ++k) replaced[fused[k]] = compiled.back().get();
+		i += n;
+	}
+
+	elements.swap(compiled);
+	weld();
+
+	for(auto &p : particles){
+		const auto found(replaced.find(p->getElement()));
+		p->setElement(found != replaced.end() ? found->second : (*this)[p->getElement()->getIndex()].get());
+	}
+
+	table.clear();
+	for(auto &e : elements) table.push_back(e->record());
+	for(auto &e : elements) e->setPool(&nodes);
+}
+
 void Accelerator::activate(void){
 	for(auto &b : beams){
 		b->activate();
@@ -24,6 +86,7 @@ void Accelerator::activate(void){
 
 void Accelerator::initialize(void){
 	weld();
+	compile();
 	activate();
 }
 
@@ -43,6 +106,7 @@ void Accelerator::addParticle(const Particle &to_copy){
 	for(auto &E : *this){
 		if(E->contains(to_copy)){
 			particles.push_back(to_copy.copy());
+			particles.back()->setId(next_particle_id++);
 			particles.back()->setElement(E.get());
 			particles.back()->setCanvas(canvas);
 			return;
@@ -50,6 +114,11 @@ void Accelerator::addParticle(const Particle &to_copy){
 	}
 }
 
+RandomEngine Accelerator::random_stream(void){
+	std::seed_seq sequence{uint32_t(seed), uint32_t(seed >> 32), uint32_t(streams++)};
+	return RandomEngine(sequence);
+}
+
 void Accelerator::addGaussianCircularBeam(const Particle &model, uint N, double lambda, double sigma_x, double sigma_v){
 	beams.push_back(new GaussianCircularBeam(*this, model, N, lambda, sigma_x, sigma_v));
 }
@@ -136,29 +205,201 @@ std::ostream& operator<<(std::ostream& output, Accelerator &A){
 	return A.print(output);
 }
 
+void Accelerator::setBlock_timesteps(unsigned int my_levels, double my_max_deflection){
+	if(my_levels > simcst::MAX_BLOCK_LEVELS or my_max_deflection <= 0.0) throw excptn::BAD_BLOCK_TIMESTEPS;
+	block_levels = my_levels;
+	max_deflection = my_max_deflection;
+}
+
+TreeStatistics Accelerator::tree_statistics(size_t element) const{
+	TreeStatistics s;
+	const Element &e(*(*this)[element]);
+	s.trees = 1;
+	if(e.getBox().getVolume_cube_root() <= simcst::ZERO_DISTANCE) s.degenerate = 1;
+	e.statistics(s);
+	return s;
+}
+
+TreeStatistics Accelerator::tree_statistics(void) const{
+	TreeStatistics s;
+	for(size_t i(0); i < size(); ++i) s.merge(tree_statistics(i));
+	s.particles = particles.size();
+	if(last_pushed){
+		s.opened_per_particle = double(nodes.opened)/last_pushed;
+		s.interactions_per_particle = double(nodes.interactions)/last_pushed;
+	}
+	return s;
+}
+
+void Accelerator::setBarnes_hut_theta(double theta){
+	if(not (theta >= 0.0 and std::isfinite(theta))) throw excptn::BAD_BARNES_HUT_THETA;
+	barnes_hut_theta = theta;
+}
+
+unsigned int Accelerator::block_level(const Particle &p, double dt) const{
+	const ElementRecord &e(table[p.getElement_index()]);
+	const Vector3D ahead(p + (dt*phcst::C_USI)*p.getVelocity());
+	const ElementRecord &next(e.is_after(ahead) ? table[e.successor] : e);
+	// the error of a step comes from the change of the force across it (the field gradient times the displacement, or
+	// the edge of a field), so that a particle in a uniform field, e.g. inside a dipole, keeps the coarsest step
+	const Vector3D change(next.momentum_rate(ahead, p, *time) - e.momentum_rate(p, p, *time - dt));
+	const double ratio(change.norm()*dt/max_deflection);
+	if(ratio <= 1.0) return 0;
+
+	return std::min(block_levels, (unsigned int)std::ceil(std::log2(ratio)));
+}
+
 void Accelerator::evolve(double dt){
+	const trace::Scope scope("evolve", "evolve", "step", step + 1);
+	PhaseTimer timer(profile);
+	const double start(*time);
 	*time += dt;
+	++step;
 
+	nodes.rewind();
+	nodes.interactions = nodes.opened = 0; // kept until the next step for tree_statistics()
 	for(auto &e : *this){
 		e->reset();
 	}
+	timer.lap(EvolveProfile::RESET, particles.size());
 
-	int particle_count(particles.size());
+	const size_t present(particles.size());
+	int particle_count(present);
 	for(int i(0); i < particle_count;){
-		if(particles[i]->has_collided()){
+		if(table[particles[i]->getElement_index()].has_collided(*particles[i])){
 			std::swap(particles[i], particles.back());
 			particles.pop_back();
 			--particle_count;
 			// note: this clause is O(1)
 		}else{
-			particles[i]->insert_into_tree();
 			++i;
 		}
 	}
+	timer.lap(EvolveProfile::COLLISIONS, present);
 
-	for(auto &p : particles){
-		if(p) p->evolve(dt);
+	if(space_charge){
+		for(auto &p : particles) p->insert_into_tree();
+	}
+	timer.lap(EvolveProfile::TREES, space_charge ? particles.size() : 0);
+
+	// the pushes, counting the particles that change element
+	unsigned long pushed(0), crossings(0);
+	const auto push = [&](Particle &p, double step_dt){
+		const size_t element(p.getElement_index());
+		p.evolve(table, step_dt, *time, space_charge_precision, barnes_hut_theta);
+		if(EvolveProfile::ENABLED) crossings += p.getElement_index() != element;
+	};
+
+	if(not block_levels){
+		for(auto &p : particles) push(*p, dt);
+		pushed = particles.size();
+	}else{
+		levels.resize(block_levels + 1);
+		for(auto &l : levels){
+			l.clear();
+			l.reserve(particles.size()); // once, so that particles moving between levels never allocate
+		}
+		for(auto &p : particles) levels[block_level(*p, dt)].push_back(p.get());
+
+		// level l is due every 2^(block_levels - l) sub-steps, and the clock reads the end of the step being taken
+		const unsigned long substeps(1ul << block_levels);
+		const double fine(dt/substeps);
+		for(unsigned long k(0); k < substeps; ++k){
+			for(unsigned int l(0); l <= block_levels; ++l){
+				const unsigned long span(substeps >> l);
+				if(k % span or levels[l].empty()) continue;
+
+				const trace::Scope pass("force pass", "evolve", "level", l);
+				*time = start + (k + span)*fine;
+				for(Particle* p : levels[l]) push(*p, span*fine);
+				pushed += levels[l].size();
+			}
+		}
+		*time = start + dt;
+	}
+	timer.lap(EvolveProfile::PUSH, pushed);
+
+	if(EvolveProfile::ENABLED){
+		++profile.steps;
+		profile.pushed += pushed;
+		profile.lost += present - particles.size();
+		profile.nodes += 8*nodes.size();
+		profile.interactions += nodes.interactions;
+		profile.opened += nodes.opened;
+		profile.crossings += crossings;
+	}
+	last_pushed = pushed;
+}
+
+void Accelerator::track(unsigned long crossings){
+	cross_elements(crossings, [](const Element &e, Particle &p){ return e.transport(p); });
+}
+
+void Accelerator::integrate(unsigned long crossings, unsigned int steps_per_element){
+	cross_elements(crossings, [steps_per_element](const Element &e, Particle &p){ return e.integrate(p, steps_per_element); });
+}
+
+void Accelerator::cross_elements(unsigned long crossings, const std::function<bool(const Element&, Particle&)> &carry){
+	for(size_t i(0); i < particles.size();){
+		Particle &p(*particles[i]);
+		bool lost(false);
+		for(unsigned long k(0); k < crossings and not lost; ++k){
+			const Element* e(p.getElement());
+			lost = not carry(*e, p);
+			p.setElement(e->getSuccessor());
+		}
+
+		if(lost){
+			std::swap(particles[i], particles.back());
+			particles.pop_back();
+		}else{
+			++i;
+		}
+	}
+}
+
+std::array<double,2> Accelerator::rms_emittances(void) const{
+	// moments of the offsets (x, y) from the ideal orbit and of the slopes (x', y') = (v_x, v_y)/v_s
+	double moments[2][5] = {}; // sums of x, x', x^2, x'^2, x.x' for both planes
+	size_t n(0);
+
+	for(const auto &p : particles){
+		const Element* e(p->getElement());
+		if(not e) continue;
+
+		const double s(e->curvilinear_coord(*p));
+		const Vector3D t(e->local_trajectory(s));
+		const Vector3D normal(t ^ vctr::Z_VECTOR);
+		const Vector3D offset(*p - e->inverse_curvilinear_coord(s));
+		const Vector3D v(p->getVelocity());
+
+		const double v_s(v|t);
+		if(std::abs(v_s) <= simcst::ZERO_VECTOR_NORM2) continue;
+
+		const double x[2] = {offset|normal, offset[2]};
+		const double slope[2] = {(v|normal)/v_s, v[2]/v_s};
+		for(int k(0); k < 2; ++k){
+			moments[k][0] += x[k];
+			moments[k][1] += slope[k];
+			moments[k][2] += x[k]*x[k];
+			moments[k][3] += slope[k]*slope[k];
+			moments[k][4] += x[k]*slope[k];
+		}
+		++n;
+	}
+
+	std::array<double,2> emittances = {0.0, 0.0};
+	if(n == 0) return emittances;
+
+	for(int k(0); k < 2; ++k){
+		const double mean_x(moments[k][0]/n);
+		const double mean_slope(moments[k][1]/n);
+		const double xx(moments[k][2]/n - mean_x*mean_x);
+		const double ss(moments[k][3]/n - mean_slope*mean_slope);
+		const double xs(moments[k][4]/n - mean_x*mean_slope);
+		emittances[k] = sqrt(std::max(0.0, xx*ss - xs*xs));
 	}
+	return emittances;
 }
 
 std::array<Vector3D,2> Accelerator::position_and_trajectory(double s) const{
@@ -10,13 +10,37 @@ class Accelerator : public Drawable, private std::vector<std::unique_ptr<Element
 		std::shared_ptr<double> time;
 
 		std::vector<std::unique_ptr<Particle>> particles;
+		ElementTable table; // compact copy of the lattice for evolve(), made by compile()
 		std::vector<Beam*> beams;
+		NodePool nodes; // of the elements' trees, set by compile()
+		EvolveProfile profile; // of the calls to evolve()
+		unsigned long last_pushed = 0; // particle pushes in the last call to evolve()
 
 		Vector3D origin;
 
 		double length = 0.0; // geometric length of the accelerator, i.e. length of the ideal orbit
+
+		bool space_charge = true; // whether particles interact with each other (through the elements' trees)
+		Precision space_charge_precision = Precision::DOUBLE; // of the interactions, the orbits being integrated in double precision
+		double barnes_hut_theta = simcst::BARNES_HUT_THETA; // opening angle of the trees, see Node::apply_electromagnetic_force
+
+		uint64_t seed; // beams draw their particles from independent streams derived from this seed
+		unsigned int streams = 0; // number of random streams handed out so far
+
+		unsigned long step = 0; // number of calls to evolve() so far
+		unsigned int next_particle_id = 0;
+
+		// block timesteps: particles at level l take steps of dt/2^l, l <= block_levels (see evolve())
+		unsigned int block_levels = 0;
+		double max_deflection = simcst::DEFAULT_MAX_DEFLECTION;
+		std::vector<std::vector<Particle*>> levels; // particles at each level during the last call to evolve()
+
+		unsigned int block_level(const Particle &p, double dt) const;
+
+		// element-wise engines: carries every particle across that many elements, removing the lost ones
+		void cross_elements(unsigned long crossings, const std::function<bool(const Element&, Particle&)> &carry);
 	public:
-		explicit Accelerator(Canvas* canvas, Vector3D my_origin) : Drawable(canvas), time(std::make_shared<double>(0.0)), origin(my_origin){}
+		explicit Accelerator(Canvas* canvas, Vector3D my_origin) : Drawable(canvas), time(std::make_shared<double>(0.0)), origin(my_origin), seed(std::random_device()()){}
 
 		// Prohibiting copies:
 		Accelerator(const Accelerator &to_copy) = delete;
@@ -28,20 +52,56 @@ class Accelerator : public Drawable, private std::vector<std::unique_ptr<Element
 		void clear(void){ throw excptn::ILLEGAL_ACCESS; }
 
 		void weld(void);
+		void compile(void); // fuses FODO cells and consecutive straight sections, see accelerator.cpp
 		void activate(void);
-		void initialize(void);
+		void initialize(void); // welds and compiles the lattice, then activates the beams
 
 		void draw_elements(void) const;
 		void draw_particles(void) const;
 		void draw_beams(void) const;
 
-		bool is_empty(void) const{ return empty(); }
+		bool is_empty(void) const{ return particles.empty(); } // true iff all the particles are lost
 
 		double getLength(void) const{ return length; }
 		Vector3D getOrigin(void) const{ return origin; }
 
 		Particle* getLastParticle(void) const{ return particles.back().get(); }
 
+		void setSeed(uint64_t my_seed){ seed = my_seed; }
+		uint64_t getSeed(void) const{ return seed; }
+		RandomEngine random_stream(void); // a new generator, independent from the previous ones
+
+		void setSpace_charge(bool enabled){ space_charge = enabled; }
+		bool getSpace_charge(void) const{ return space_charge; }
+		void setSpace_charge_precision(Precision p){ space_charge_precision = p; }
+		Precision getSpace_charge_precision(void) const{ return space_charge_precision; }
+		// smaller is more accurate and slower, 0 summing over every pair (see cern-junior-barnes-hut for measurements)
+		void setBarnes_hut_theta(double theta);
+		double getBarnes_hut_theta(void) const{ return barnes_hut_theta; }
+
+		// 0 levels (the default) gives every particle the same step
+		void setBlock_timesteps(unsigned int my_levels, double my_max_deflection);
+		unsigned int getBlock_levels(void) const{ return block_levels; }
+		size_t block_population(unsigned int level) const{ return level < levels.size() ? levels[level].size() : 0; }
+
+		double getTime(void) const{ return *time; }
+		unsigned long getStep(void) const{ return step; }
+
+		// time spent in each phase of evolve() and counters, since the start or the last clearProfile()
+		const EvolveProfile& getProfile(void) const{ return profile; }
+		void clearProfile(void){ profile.clear(); }
+
+		// of the trees of an element, or of all the elements together with the cost of the last step's space charge,
+		// as built by the last call to evolve() (see tree_statistics.h)
+		TreeStatistics tree_statistics(size_t element) const;
+		TreeStatistics tree_statistics(void) const;
+
+		size_t element_count(void) const{ return size(); }
+		const Element& getElement(size_t i) const{ return *(*this)[i]; }
+		const ElementTable& getElement_table(void) const{ return table; }
+		size_t particle_count(void) const{ return particles.size(); }
+		const Particle& getParticle(size_t i) const{ return *particles[i]; }
+
 		void addParticle(const Particle &to_copy);
 		void addGaussianCircularBeam(const Particle &model, uint N, double lambda, double sigma_x, double sigma_v);
 		void addUniformCircularBeam(const Particle &model, uint N, double lambda, double delta_x, double delta_v);
@@ -64,8 +124,23 @@ class Accelerator : public Drawable, private std::vector<std::unique_ptr<Element
 
 		std::ostream& print(std::ostream& output, bool print_elements = false) const;
 
+		std::array<double,2> rms_emittances(void) const; // horizontal and vertical rms emittances (in m.rad) around the ideal orbit
+
+		// with block timesteps, dt is the coarsest step: each particle takes the finest step that keeps the relative
+		// error of its momentum below max_deflection, i.e. dt times the change of dp/dt/|p| between where it starts and
+		// where a straight step would take it. Only the levels due at each sub-step are pushed, so a beam that is
+		// mostly in drifts and uniform dipoles costs about one push per particle, the edges of the fields alone
+		// taking finer steps. The space-charge trees are built once per call, so that the finer levels feel the
+		// other particles where they were at the start of the coarse step.
 		void evolve(double dt);
 
+		// element-wise engine (see Element::transport): every particle crosses the given number of elements,
+		// each with its own clock. There is no space charge, and the accelerator's clock is left untouched.
+		void track(unsigned long crossings);
+
+		// s-based engine (see Element::integrate), with the same conventions as track()
+		void integrate(unsigned long crossings, unsigned int steps_per_element);
+
 		std::array<Vector3D,2> position_and_trajectory(double s) const; // returns coordinate and local trajectory of point on the ideal orbit with given curvilinear coordinate
 };
 
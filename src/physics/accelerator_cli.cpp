@@ -15,7 +15,7 @@ void cli::try_again(void){
 void cli::add_beams(Accelerator &w){
 	if(std::tolower(cli::getInput<char>("(D)efault configuration or (c)ustom?\n") == 'c')){
 		do{
-			char type(std::tolower(cli::getInput<char>("Type of particle: (p)roton / (e)lectron:\n")));
+			char type(std::tolower(cli::getInput<char>("Type of particle: (p)roton / (e)lectron / (+) positron / (a)lpha particle:\n")));
 
 			int N(cli::getInput<int>("Number of particles:\nN = "));
 			if(N < 0) N = 0;
@@ -49,12 +49,13 @@ class Beam : public Drawable, protected std::vector<Particle*>{
 class CircularBeam : public Beam{
 	// generates a circular beam according to some distribution
 	private:
-		std::random_device gen; // seed generator
+		RandomEngine gen; // seeded from the accelerator's seed and the beam's index, see Accelerator::setSeed
 		RandomVector3D position_offset; // random 3D-offset around ideal positions
 		RandomVector3D velocity_offset; // random 3D-offset around ideal velocities
 	public:
 		explicit CircularBeam(Accelerator& machine, const Particle &p, uint number_of_particles, double my_lambda, const RandomVector3D &my_distr_x, const RandomVector3D &my_distr_v) :
 			Beam(machine, p, number_of_particles, my_lambda),
+			gen(machine.random_stream()),
 			position_offset(my_distr_x),
 			velocity_offset(my_distr_v)
 		{}
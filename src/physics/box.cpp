@@ -15,7 +15,7 @@ std::array<Vector3D,8> Box::getVertices(void) const{
 	};
 }
 
-bool Box::contains(const Particle &x) const{
+bool Box::contains(const Particle &x) const noexcept{
 	Vector3D rel_coords(x - center + width + depth + height);
 
 	double a(0.5*rel_coords|width);
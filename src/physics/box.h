@@ -8,13 +8,14 @@
 
 class Box : public Drawable{
 	private:
-		const Vector3D center;
+		// not const, so that the nodes of the trees can be given other domains (see NodePool)
+		Vector3D center;
 
-		const Vector3D width;
-		const Vector3D depth;
-		const Vector3D height;
+		Vector3D width;
+		Vector3D depth;
+		Vector3D height;
 
-		const double volume_cube_root;
+		double volume_cube_root;
 
 		Box(Canvas* canvas, const Vector3D &my_center, const Vector3D &my_width, const Vector3D &my_depth, const Vector3D &my_height) :
 			Drawable(canvas),
@@ -26,6 +27,8 @@ class Box : public Drawable{
 		{}
 
 	public:
+		Box(void) : Drawable(nullptr), volume_cube_root(0.0){} // empty, until given another domain
+
 		Box(Canvas* canvas, const Vector3D &my_center, const Vector3D &my_width, double length) :
 			Drawable(canvas),
 			center(my_center),
@@ -39,7 +42,7 @@ class Box : public Drawable{
 
 		double getVolume_cube_root(void) const{ return volume_cube_root; };
 
-		bool contains(const Particle &x) const;
+		bool contains(const Particle &x) const noexcept;
 		std::ostream& print(std::ostream& output) const;
 		Box octant(bool right, bool back, bool top) const;
 
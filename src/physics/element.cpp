@@ -19,42 +19,53 @@ Element::Element(
 			0.5*(exit - entry) + (abs(my_curvature) <= simcst::ZERO_CURVATURE ? vctr::ZERO_VECTOR : my_radius*(exit-entry).unitary()),
 			(abs(my_curvature) <= simcst::ZERO_CURVATURE ? my_radius : my_radius + (1.0/my_curvature)*(1.0-sqrt(abs(1.0-0.25*my_curvature*my_curvature*(exit - entry).norm2())))
 	))),
-	entry_point(entry),
-	exit_point(exit),
-	radius(my_radius),
-	curvature(my_curvature),
-	clock(my_clock),
-	dir((exit-entry).unitary()),
-	length(is_straight() ? direction().norm() : 2.0*asin(direction().norm()*curvature/2.0)/curvature)
+	Segment(my_radius, my_curvature, exit),
+	clock(my_clock)
 {
-	// initializing (u,v,w)
+	// initializing (u,v,w), which fails if the element has no length or if its direction is parallel to the z-vector
 	try{
-		if(is_straight()){
-			u = direction().unitary();
-			v = u.orthogonal();
-		}else{
-			Vector3D C(center());
-			u = (entry_point - C).unitary();
-			v = exit_point - C;
-			try{
-				v = (v - (v|u)*u).unitary();
-			}
-			catch(std::exception){
-				v = (u^vctr::Z_VECTOR).unitary();
-			}
-		}
+		place(entry);
 		w = u^v;
 	}
 	catch(std::exception){ throw excptn::ELEMENT_DEGENERATE_GEOMETRY; }
 }
 
-void Element::apply_forces(Particle &p, double dt) const{
-	apply_lorentz_force(p, dt);
-	apply_electromagnetic_force(p);
+FodoCell::FodoCell(Canvas* display, std::vector<std::unique_ptr<Element>> &&my_parts, std::shared_ptr<double> my_clock) :
+	MagneticElement(
+		display,
+		my_parts.empty() ? vctr::ZERO_VECTOR : my_parts.front()->getEntry_point(),
+		my_parts.empty() ? vctr::ZERO_VECTOR : my_parts.back()->getExit_point(),
+		my_parts.empty() ? 0.0 : my_parts.front()->getRadius(),
+		0.0,
+		my_clock
+	),
+	parts(std::move(my_parts))
+{
+	// the parts must be straight, collinear quadrupoles and straight sections of the same aperture
+	double s(0.0);
+	for(const auto &e : parts){
+		const Quadrupole* q(dynamic_cast<const Quadrupole*>(e.get()));
+		if(not is_aligned_with(*e)) throw ELEMENT_DEGENERATE_GEOMETRY;
+		if(not q and not dynamic_cast<const StraightSection*>(e.get())) throw ELEMENT_DEGENERATE_GEOMETRY;
+
+		s += e->getLength();
+		ends.push_back(s);
+		gradients.push_back(q ? q->getB() : 0.0);
+	}
+	ends.back() = length;
+}
+
+ElementRecord Element::record(void){
+	ElementRecord r(*this);
+	r.element = this;
+	r.successor = successor ? successor->index : index;
+	r.predecessor = predecessor ? predecessor->index : index;
+	describe(r);
+	return r;
 }
 
-bool Element::is_straight(void) const{
-	return abs(curvature) <= simcst::ZERO_CURVATURE;
+bool Element::is_aligned_with(const Element &e) const{
+	return is_straight() and e.is_straight() and (dir ^ e.dir).norm() <= simcst::ZERO_DISTANCE and (dir|e.dir) > 0.0 and radius == e.radius;
 }
 
 std::ostream& Element::print(std::ostream& output) const{
@@ -74,81 +85,39 @@ std::ostream& operator<<(std::ostream& output, const Element &E){
 
 Vector3D Element::center(void) const{
 	if(is_straight()) throw ZERO_CURVATURE_CENTER;
-	Vector3D direction(exit_point - entry_point);
-
-	try{
-		return 0.5*(entry_point + exit_point) + (1.0/curvature)*sqrt(abs(1.0-0.25*curvature*curvature*direction.norm2()))*(direction^vctr::Z_VECTOR).unitary();
-	}
-	catch(std::exception){
-		// an exception is thrown if direction is parallel to z-vector which is prohibited
-		throw ELEMENT_DEGENERATE_GEOMETRY;
-	}
+	return curvature_center;
 }
 
-Vector3D Element::direction(void) const{
+Vector3D Element::direction(void) const noexcept{
 	return exit_point - entry_point;
 }
 
-Vector3D Element::relative_coords(const Vector3D &x) const{
+Vector3D Element::relative_coords(const Vector3D &x) const noexcept{
 	return x - entry_point;
 }
 
-Vector3D Element::local_coords(const Vector3D &x) const{
+Vector3D Element::local_coords(const Vector3D &x) const noexcept{
 	Vector3D y(relative_coords(x));
 	return y - (y|u)*u;
 }
 
-double Element::curvilinear_coord(const Vector3D &x) const{
-	double l(relative_coords(x)|dir);
-	return is_straight() ? l : asin(l*curvature) / curvature;
-}
-
-double Element::orthogonal_offset(const Vector3D &r) const{
+double Element::orthogonal_offset(const Vector3D &r) const noexcept{
 	if(is_straight()){
 		return local_coords(r).norm();
 	}else{
-		const Vector3D X(r - center());
-		const Vector3D u((X - r[2]*vctr::Z_VECTOR).unitary());
-		return (X - (1.0/abs(curvature))*u).norm();
-	}
-}
-
-bool Element::has_collided(const Vector3D &r) const{
-	try{
-		return orthogonal_offset(r) >= radius;
-	}
-
-	catch(std::exception){
-			// means that the point is directly over the center
-			return true;
+		const Vector3D X(r - curvature_center);
+		const Vector3D horizontal(X - r[2]*vctr::Z_VECTOR);
+		if(horizontal.is_zero()) return INFINITY; // directly over the center
+		return (X - (1.0/abs(curvature))*horizontal.unitary_or(vctr::X_VECTOR)).norm();
 	}
 }
 
-bool Element::is_after(const Vector3D &r) const{
-	Vector3D rel(relative_coords(r));
-	Vector3D D(direction());
-	return (rel|D) > D.norm2();
-}
-
-bool Element::is_before(const Vector3D &r) const{
-	Vector3D rel(relative_coords(r));
-	return (rel|dir) < 0.0;
-}
-
 std::ostream& StraightSection::print(std::ostream& output) const{
 	output << "Straight section:\n";
 	Element::print(output);
 	return output;
 }
 
-void MagneticElement::apply_lorentz_force(Particle& p, double dt) const{
-	p.add_magnetic_force(B(p, *clock), dt);
-}
-
-void ElectricElement::apply_lorentz_force(Particle& p, double dt) const{
-	p.add_electric_force(E(p, *clock));
-}
-
 // FIELD EQUATIONS
 Vector3D Dipole::B(const Vector3D &x, double) const{
 	return B_0 * vctr::Z_VECTOR;
@@ -160,8 +129,47 @@ Vector3D Quadrupole::B(const Vector3D &x, double) const{
 	return b*((y|u)*vctr::Z_VECTOR + x[2]*u);
 }
 
+Vector3D FodoCell::B(const Vector3D &x, double) const{
+	const double s(relative_coords(x)|dir);
+	size_t k(0);
+	while(k + 1 < ends.size() and s >= ends[k]) ++k;
+
+	Vector3D y(local_coords(x));
+	Vector3D u(vctr::Z_VECTOR ^ dir);
+	return gradients[k]*((y|u)*vctr::Z_VECTOR + x[2]*u);
+}
+
 Vector3D RadiofrequencyCavity::E(const Vector3D &x, double t) const{
-	return E_0*sin(omega*t - kappa*curvilinear_coord(x) + phi) * dir;
+	return E_0*fastmath::sin(omega*t - kappa*curvilinear_coord(x) + phi) * dir;
+}
+
+// RECORDS
+void Dipole::describe(ElementRecord &r) const{
+	r.kind = ElementRecord::DIPOLE;
+	r.dipole.B_0 = B_0;
+}
+
+void Quadrupole::describe(ElementRecord &r) const{
+	r.kind = ElementRecord::QUADRUPOLE;
+	r.quadrupole.b = b;
+}
+
+void FodoCell::describe(ElementRecord &r) const{
+	if(ends.size() > ElementRecord::MAX_LENSES) throw TOO_MANY_LENSES;
+	r.kind = ElementRecord::LENSES;
+	r.lenses.count = ends.size();
+	for(size_t k(0); k < ends.size(); ++k){
+		r.lenses.ends[k] = ends[k];
+		r.lenses.gradients[k] = gradients[k];
+	}
+}
+
+void RadiofrequencyCavity::describe(ElementRecord &r) const{
+	r.kind = ElementRecord::CAVITY;
+	r.cavity.E_0 = E_0;
+	r.cavity.omega = omega;
+	r.cavity.kappa = kappa;
+	r.cavity.phi = phi;
 }
 
 // PRINTING METHODS
@@ -179,6 +187,16 @@ std::ostream& Quadrupole::print(std::ostream& output) const{
 	return output;
 }
 
+std::ostream& FodoCell::print(std::ostream& output) const{
+	output << "FODO cell:\n";
+	Element::print(output);
+	cout << "\n   Quadrupole parameters: b =";
+	for(size_t k(0); k < gradients.size(); ++k){
+		if(gradients[k] != 0.0) cout << " " << gradients[k];
+	}
+	return output;
+}
+
 std::ostream& RadiofrequencyCavity::print(std::ostream& output) const{
 	output << "Radiofrequency cavity:\n";
 	Element::print(output);
@@ -186,20 +204,14 @@ std::ostream& RadiofrequencyCavity::print(std::ostream& output) const{
 	return output;
 }
 
-Vector3D Element::inverse_curvilinear_coord(double s) const{
+Vector3D Element::inverse_curvilinear_coord(double s) const noexcept{
 	if(is_straight())
-		return entry_point + s*direction().unitary();
+		return entry_point + s*dir;
 	if(s*s < simcst::ZERO_DISTANCE)
 		return entry_point;
 	else{
-		double beta(s*curvature);
-		return center() + (1.0/abs(curvature))*(cos(beta)*u + sin(beta)*v);
+		double beta(s*abs(curvature));
+		return curvature_center + (1.0/abs(curvature))*(cos(beta)*u + sin(beta)*v);
 	}
 }
 
-Vector3D Element::local_trajectory(double s) const{
-	if(is_straight()) return dir;
-
-	double beta(s*curvature);
-	return -sin(beta)*u + cos(beta)*v;
-}
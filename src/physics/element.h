@@ -9,29 +9,34 @@
 #include "../misc/exceptions.h"
 
 #include "particle.h"
+#include "element_table.h"
 #include "node.h"
+#include "transfer_map.h"
+#include "segment.h"
 
-class Element : public Drawable, public Node{
+// the geometry (entry and exit points, radius of the vacuum chamber, radial curvature, potentially zero) is that of
+// lattice::Segment, which the element records share
+class Element : public Drawable, public Node, protected lattice::Segment{
 	protected:
-		Vector3D entry_point; // entry position
-		Vector3D exit_point; // exit position
-
-		const double radius; // radius of the vaccum chamber
-		const double curvature; // radial curvature (potentially zero)
-
 		Element* successor = nullptr; // pointer to the following element
 		Element* predecessor = nullptr; // pointer to the previous element
+		size_t index = 0; // position in the lattice, set when welding
 
 		const std::shared_ptr<double> clock;
 
-		Vector3D dir;
-		double length;
-
-		// Orthonormal basis of the plane containing the element. Useful for graphics
-		Vector3D u;
-		Vector3D v;
+		// Orthonormal basis of the plane containing the element (u and v being those of the segment). Useful for graphics
 		Vector3D w;
 
+		bool straight_line(Particle &p) const; // field-free motion to the exit plane
+
+		// paraxial motion from p to the exit of a straight element made of consecutive thick lenses,
+		// lens k ending at ends[k] with gradient gradients[k] (in T/m, zero for a drift)
+		bool thick_lenses(Particle &p, const double* ends, const double* gradients, size_t n) const;
+		virtual void kick(Particle &p, double dt) const = 0; // effect of the element's field on p during dt, at p's own time
+		bool is_lost(const Particle &p, const Vector3D &middle) const; // aperture check at the exit and at an intermediate point
+		bool integrate(Particle &p, double s_from, double s_to, unsigned int steps) const; // see integrate() below
+		virtual void describe(ElementRecord &r) const = 0; // fills in the kind and the field parameters of record()
+
 	public:
 		virtual ~Element(void){}
 
@@ -39,10 +44,11 @@ class Element : public Drawable, public Node{
 
 		void setCanvas(Canvas* c){ canvas = c; }
 
-		Vector3D getEntry_point(void) const{ return entry_point; }
-		Vector3D getExit_point(void) const{ return exit_point; }
-		double getRadius(void) const{ return radius; }
-		double getCurvature(void) const{ return curvature; }
+		using Segment::getEntry_point;
+		using Segment::getExit_point;
+		using Segment::getRadius;
+		using Segment::getCurvature;
+		using Segment::getLength;
 
 		virtual const RGB* getColor(void) const = 0;
 
@@ -51,15 +57,16 @@ class Element : public Drawable, public Node{
 		Vector3D getBasis_vector_w(void) const{ return w; }
 		Vector3D getDir(void) const{ return dir; }
 
-		double getLength(void) const{ return length; };
-
 		Element* getSuccessor(void) const{ return successor; }
 		Element* getPredecessor(void) const{ return predecessor; }
 
 		void setSuccessor(Element* my_successor){ successor = my_successor; }
 		void setPredecessor(Element* my_predecessor){ predecessor = my_predecessor; }
 
-		void apply_forces(Particle &p, double dt) const;
+		size_t getIndex(void) const{ return index; }
+		void setIndex(size_t my_index){ index = my_index; }
+
+		ElementRecord record(void); // compact copy of the element for the time-stepping engine (see element_table.h)
 
 		virtual std::ostream& print(std::ostream& output) const;
 		// Base method prints only basic information (i.e. about its shape)
@@ -67,31 +74,43 @@ class Element : public Drawable, public Node{
 
 		void link(Element &nextElement);
 
-		bool is_straight(void) const;
-		Vector3D center(void) const; // returns the center of circular element assuming curvature is non-zero
+		using Segment::is_straight;
+		bool is_aligned_with(const Element &e) const; // true iff both are straight, in the same direction, with the same chamber radius
+		Vector3D center(void) const; // returns the center of circular element, throws if curvature is zero
 
-		Vector3D direction(void) const; // returns the vector exit_point - entry_point
+		Vector3D direction(void) const noexcept; // returns the vector exit_point - entry_point
 		Vector3D unit_direction(void) const; // returns director().unitary()
 
-		Vector3D relative_coords(const Vector3D &x) const;
-		Vector3D local_coords(const Vector3D &x) const;
+		Vector3D relative_coords(const Vector3D &x) const noexcept;
+		Vector3D local_coords(const Vector3D &x) const noexcept;
 
-		Vector3D inverse_curvilinear_coord(double s) const; // returns point on the trajectory with given curvilinear coordinate
-		Vector3D local_trajectory(double s) const; // returns unit vector in the direciton of the local trajectory of the point with curvilinear coordinate s
+		// the geometry below never throws, so that it can be used in the hot loops
+		Vector3D inverse_curvilinear_coord(double s) const noexcept; // returns point on the trajectory with given curvilinear coordinate
+		using Segment::local_trajectory; // unit vector in the direction of the trajectory at curvilinear coordinate s
+		using Segment::curvilinear_coord;
 
-		double curvilinear_coord(const Vector3D &x) const;
+		double orthogonal_offset(const Vector3D &r) const noexcept; // infinite directly over the center of a curved element
+		using Segment::has_collided; // true iff r has collided with the element's edge (or is not a number)
+		using Segment::is_after; // true iff r has passed to the next element
+		using Segment::is_before; // true iff r has passed to the previous element
+		using Segment::contains;
 
-		double orthogonal_offset(const Vector3D &r) const;
-		bool has_collided(const Vector3D &r) const; // returns true iff r has collided with the element's edge
-		bool is_after(const Vector3D &r) const; // returns true iff r has passed to the next element
-		bool is_before(const Vector3D &r) const; // returns true iff r has passed to the next element
+		void sort(void);
 
-		bool contains(const Vector3D &r) const{ return not is_after(r) and not is_before(r) and not has_collided(r); }// returns true iff r has passed to the next element;
+		virtual TransferMap transfer_map(const ReferenceParticle &reference) const; // linear map from entry to exit (see transfer_map.h)
 
-		void sort(void);
+		// element-wise engine: carries p from its position to the exit plane in one go, advancing its own clock
+		// returns false if p is lost on the way
+		virtual bool transport(Particle &p) const = 0;
+
+		// s-based engine: carries p to the exit plane in the given number of steps of equal length along the ideal orbit,
+		// each one landing exactly on the plane orthogonal to the orbit. Time is a dependent coordinate.
+		// returns false if p is lost on the way
+		// An element with piecewise fields (see FodoCell) is crossed in that many steps per part.
+		bool integrate(Particle &p, unsigned int steps) const;
 
-		virtual void apply_lorentz_force(Particle &, double) const = 0;
-		void evolve(double dt);
+		virtual size_t segment_count(void) const{ return 1; } // number of parts with their own field
+		virtual double segment_end(size_t) const{ return length; } // curvilinear coordinate at the end of part k
 };
 
 std::ostream& operator<<(std::ostream& output, const Element &E);
@@ -108,7 +127,11 @@ class StraightSection : public Element{
 
 		virtual const RGB* getColor(void) const override{ return &RGB::SKY_BLUE; }
 
-		virtual void apply_lorentz_force(Particle&, double) const override{ return; } // no electromagnetic interaction
+		virtual bool transport(Particle &p) const override{ return straight_line(p); }
+
+	protected:
+		virtual void kick(Particle&, double) const override{ return; } // no electromagnetic interaction
+		virtual void describe(ElementRecord&) const override{ return; }
 };
 
 class ElectricElement : public Element{
@@ -117,8 +140,10 @@ class ElectricElement : public Element{
 		virtual ~ElectricElement(void) override{}
 
 		virtual const RGB* getColor(void) const override{ return &RGB::BLUE; }
-		virtual void apply_lorentz_force(Particle& p, double dt) const override;
 		virtual Vector3D E(const Vector3D &x, double t) const = 0;
+
+	protected:
+		virtual void kick(Particle &p, double dt) const override;
 };
 
 class MagneticElement : public Element{
@@ -128,8 +153,10 @@ class MagneticElement : public Element{
 
 		virtual const RGB* getColor(void) const override{ return &RGB::RED; }
 
-		virtual void apply_lorentz_force(Particle& p, double dt) const override;
 		virtual Vector3D B(const Vector3D &x, double t) const = 0;
+
+	protected:
+		virtual void kick(Particle &p, double dt) const override;
 };
 
 class Dipole : public MagneticElement{
@@ -145,6 +172,11 @@ class Dipole : public MagneticElement{
 		virtual void draw(void) override{ canvas->draw(*this); }
 
 		virtual Vector3D B(const Vector3D &x, double dt) const override final;
+
+		virtual bool transport(Particle &p) const override; // exact helix in the uniform field
+
+	protected:
+		virtual void describe(ElementRecord &r) const override;
 };
 
 class Quadrupole : public MagneticElement{
@@ -157,9 +189,43 @@ class Quadrupole : public MagneticElement{
 
 		virtual Vector3D B(const Vector3D &x, double dt) const override final;
 
+		virtual TransferMap transfer_map(const ReferenceParticle &reference) const override;
+		virtual bool transport(Particle &p) const override; // paraxial thick lens
+
 		virtual std::ostream& print(std::ostream& output) const override;
 
 		virtual void draw(void) override{ canvas->draw(*this); }
+
+		double getB(void) const{ return b; }
+
+	protected:
+		virtual void describe(ElementRecord &r) const override;
+};
+
+class FodoCell : public MagneticElement{
+	// collinear quadrupoles and straight sections fused into one element (see Accelerator::compile),
+	// whose field is evaluated piecewise along the cell
+	private:
+		std::vector<double> ends; // curvilinear coordinate at the end of each part
+		std::vector<double> gradients; // b of each part, zero in the straight sections
+		std::vector<std::unique_ptr<Element>> parts; // the fused elements, kept for display only
+	public:
+		FodoCell(Canvas* display, std::vector<std::unique_ptr<Element>> &&my_parts, std::shared_ptr<double> my_clock);
+
+		virtual Vector3D B(const Vector3D &x, double dt) const override final;
+
+		virtual TransferMap transfer_map(const ReferenceParticle &reference) const override;
+		virtual bool transport(Particle &p) const override; // paraxial thick lenses
+
+		virtual size_t segment_count(void) const override{ return ends.size(); }
+		virtual double segment_end(size_t k) const override{ return ends[k]; }
+
+		virtual std::ostream& print(std::ostream& output) const override;
+
+		virtual void draw(void) override{ for(auto &e : parts) e->draw(); }
+
+	protected:
+		virtual void describe(ElementRecord &r) const override; // at most ElementRecord::MAX_LENSES parts
 };
 
 class RadiofrequencyCavity : public ElectricElement{
@@ -179,7 +245,13 @@ class RadiofrequencyCavity : public ElectricElement{
 
 		virtual Vector3D E(const Vector3D &x, double dt) const override final;
 
+		virtual TransferMap transfer_map(const ReferenceParticle &reference) const override;
+		virtual bool transport(Particle &p) const override; // drift, energy kick integrated along the path, drift
+
 		virtual std::ostream& print(std::ostream& output) const override;
 
 		virtual void draw(void) override{ canvas->draw(*this); }
+
+	protected:
+		virtual void describe(ElementRecord &r) const override;
 };
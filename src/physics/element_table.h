@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+
+#include "segment.h"
+#include "particle.h"
+
+class Element;
+
+/*
+ * Compact copy of a compiled lattice for the time-stepping engine (see Accelerator::evolve). Each element is
+ * described by a record holding its geometry and the parameters of its field, the kind of the element selecting
+ * the field in a switch, and the records are stored contiguously in the order of the lattice. A particle knows
+ * the index of its record, so that pushing it and moving it to the next element involve no virtual call.
+ * The records are made by the elements themselves (see Element::record), which remain in charge of drawing,
+ * of the space-charge trees and of the element-wise engines.
+ */
+struct ElementRecord : public lattice::Segment{
+	enum Kind : unsigned char { STRAIGHT, DIPOLE, QUADRUPOLE, LENSES, CAVITY };
+	static constexpr size_t MAX_LENSES = 4; // parts of a FodoCell
+
+	Kind kind = STRAIGHT;
+	union{
+		struct{ double B_0; } dipole;
+		struct{ double b; } quadrupole;
+		struct{ double ends[MAX_LENSES]; double gradients[MAX_LENSES]; size_t count; } lenses; // as in FodoCell
+		struct{ double E_0, omega, kappa, phi; } cavity;
+	};
+
+	Element* element = nullptr; // the element described
+	size_t successor = 0; // indices of the neighbouring records
+	size_t predecessor = 0;
+
+	explicit ElementRecord(const lattice::Segment &geometry) : Segment(geometry){}
+
+	bool is_magnetic(void) const noexcept{ return kind == DIPOLE or kind == QUADRUPOLE or kind == LENSES; }
+
+	Vector3D B(const Vector3D &x) const noexcept{
+		switch(kind){
+			case DIPOLE: return dipole.B_0*vctr::Z_VECTOR;
+			case QUADRUPOLE: return gradient_field(quadrupole.b, x);
+			case LENSES:{
+				const double s((x - entry_point)|dir);
+				size_t k(0);
+				while(k + 1 < lenses.count and s >= lenses.ends[k]) ++k;
+				return gradient_field(lenses.gradients[k], x);
+			}
+			default: return vctr::ZERO_VECTOR;
+		}
+	}
+
+	Vector3D E(const Vector3D &x, double t) const noexcept{
+		if(kind != CAVITY) return vctr::ZERO_VECTOR;
+		return cavity.E_0*fastmath::sin(cavity.omega*t - cavity.kappa*curvilinear_coord(x) + cavity.phi) * dir;
+	}
+
+	// same as the elements' fields at time t
+	void apply_lorentz_force(Particle &p, double dt, double t) const noexcept{
+		if(kind == STRAIGHT) return;
+		if(kind == CAVITY) p.add_electric_force(E(p, t));
+		else p.add_magnetic_force(B(p), dt);
+	}
+
+	// dp/dt/|p| due to the field at time t if p were at x (in 1/s)
+	Vector3D momentum_rate(const Vector3D &x, const Particle &p, double t) const noexcept{
+		if(kind == STRAIGHT) return vctr::ZERO_VECTOR;
+		const double momentum(p.getGamma()*p.getMass()*p.getVelocity().norm()*phcst::C_USI);
+		if(momentum <= 0.0) return vctr::ZERO_VECTOR;
+		if(is_magnetic()) return (p.getCharge()*phcst::C_USI/momentum)*(p.getVelocity() ^ B(x));
+		return (p.getCharge()/momentum)*E(x, t);
+	}
+
+	private:
+		// field of a quadrupole of parameter b along dir
+		Vector3D gradient_field(double b, const Vector3D &x) const noexcept{
+			Vector3D y(x - entry_point);
+			y -= (y|dir)*dir;
+			const Vector3D n(vctr::Z_VECTOR ^ dir);
+			return b*((y|n)*vctr::Z_VECTOR + x[2]*n);
+		}
+};
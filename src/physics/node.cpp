@@ -1,27 +1,80 @@
-#include <cmath> // for pow
+#include <algorithm> // for max
+#include <cmath> // for pow and abs
 
 #include "node.h"
+#include "../vector3d/fast_math.h"
+
+/*
+ * The interactions of a particle with the charges that the tree gives, computed W at a time from their separations
+ * stored coordinate by coordinate (see Vector3DBatch), which the compiler turns into packed instructions. The forces
+ * are then added to the particle in the order in which the charges were gathered, so that the result is the same as
+ * that of PointCharge::electromagnetic_force<double> with the approximations of fastmath, one charge at a time.
+ */
+class ForceBatch{
+	public:
+		static constexpr size_t W = 8;
+
+	private:
+		Particle& P;
+		const PointCharge* sources[W];
+		size_t n = 0;
+
+	public:
+		explicit ForceBatch(Particle& my_P) : P(my_P){}
+
+		void add(const PointCharge &Q) noexcept{
+			sources[n++] = &Q;
+			if(n == W) flush();
+		}
+
+		void flush(void) noexcept{
+			Vector3DBatch<double,W> F;
+			std::array<double,W> coefficient;
+			for(size_t i(0); i < W; ++i) F.set(i, i < n ? Vector3D(*sources[i] - P) : vctr::ZERO_VECTOR);
+
+			std::array<double,W> r2(F.norm2());
+			for(size_t i(0); i < W; ++i) r2[i] += simcst::SMOOTHING_CONSTANT;
+			std::array<double,W> inverse_cube;
+			fastmath::inverse_cube(r2.data(), inverse_cube.data(), W); // with the selected kernel, e.g. AVX-512
+			for(size_t i(0); i < n; ++i){
+				const PointCharge &Q(*sources[i]);
+				coefficient[i] = phcst::K*Q.getCharge()*P.getCharge()/(Q.getGamma()*P.getGamma())*inverse_cube[i];
+			}
+			for(size_t i(n); i < W; ++i) coefficient[i] = 0.0;
+			F *= coefficient;
+
+			for(size_t i(0); i < n; ++i){
+				if(sources[i] != &P and r2[i] > 0.0) P.add_force(F.get(i));
+			}
+			n = 0;
+		}
+};
 
 void Node::subdivide(void){
 	type = INT;
+	children = pool->acquire();
 	for(int i(0); i <= 1; ++i) for(int j(0); j <= 1; ++j) for(int k(0); k <= 1; ++k){
-		children[i + 2*j + 4*k] = std::unique_ptr<Node>(new Node(domain.octant(i,j,k)));
+		children[i + 2*j + 4*k].recycle(domain.octant(i,j,k), pool);
 	}
 }
 
 void Node::reset(void){
-	if(type == INT){
-		/* children.fill(nullptr); */
-	}
+	children = nullptr;
 	type = EMPTY;
 }
 
+void Node::recycle(const Box &my_domain, NodePool* my_pool){
+	domain = my_domain;
+	pool = my_pool;
+	reset();
+}
+
 bool Node::insert(Particle* my_particle){
 	if(not domain.contains(*my_particle)) return false;
 	switch(type){
 		case INT:{
 			total_charge.incorporate(*my_particle);
-			for(const auto &child : children) if(child->insert(my_particle)) return true;
+			for(Node* child(children); child != children + 8; ++child) if(child->insert(my_particle)) return true;
 			return false;
 		}
 		case EXT:{
@@ -31,10 +84,10 @@ bool Node::insert(Particle* my_particle){
 			total_charge.incorporate(*my_particle);
 			subdivide();
 
-			for(const auto &child : children) if(child->insert(tenant)) break;
+			for(Node* child(children); child != children + 8; ++child) if(child->insert(tenant)) break;
 			tenant = nullptr;
 
-			for(const auto &child : children) if(child->insert(my_particle)) return true;
+			for(Node* child(children); child != children + 8; ++child) if(child->insert(my_particle)) return true;
 			return false;
 		}
 		case EMPTY:{
@@ -46,27 +99,74 @@ bool Node::insert(Particle* my_particle){
 	}
 }
 
-void Node::apply_electromagnetic_force(Particle& P) const{
+void Node::apply_electromagnetic_force(Particle& P, Precision precision, double theta) const noexcept{
+	if(precision == Precision::SINGLE){
+		apply_electromagnetic_force<float>(P, theta);
+	}else if(fastmath::is_fast()){
+		ForceBatch batch(P);
+		gather(P, batch, theta);
+		batch.flush();
+	}else{
+		apply_electromagnetic_force<double>(P, theta);
+	}
+}
+
+void Node::gather(const Particle& P, ForceBatch &batch, double theta) const noexcept{
+	if(type == EMPTY) return;
+	if(type == INT and not (domain.getVolume_cube_root() / Vector3D::distance(P, total_charge) <= theta)){
+		if(EvolveProfile::ENABLED and pool) ++pool->opened;
+		for(Node* child(children); child != children + 8; ++child) child->gather(P, batch, theta);
+		return;
+	}
+
+	batch.add(total_charge);
+	if(EvolveProfile::ENABLED and pool) ++pool->interactions;
+}
+
+template<typename T>
+void Node::apply_electromagnetic_force(Particle& P, double theta) const noexcept{
 	if(type == EMPTY) return;
 	if(type == EXT){
-		P.receive_electromagnetic_force(total_charge);
+		P.receive_electromagnetic_force<T>(total_charge);
+		if(EvolveProfile::ENABLED and pool) ++pool->interactions;
 		return;
 	}
 	// else, type == INT
 
 	const double ratio(domain.getVolume_cube_root() / Vector3D::distance(P, total_charge));
 
-	if(ratio <= simcst::BARNES_HUT_THETA){
-		P.receive_electromagnetic_force(total_charge);
+	if(ratio <= theta){
+		P.receive_electromagnetic_force<T>(total_charge);
+		if(EvolveProfile::ENABLED and pool) ++pool->interactions;
 	}else{
-		for(const auto &child : children){
-			child->apply_electromagnetic_force(P);
+		if(EvolveProfile::ENABLED and pool) ++pool->opened;
+		for(Node* child(children); child != children + 8; ++child){
+			child->apply_electromagnetic_force<T>(P, theta);
 		}
 	}
 }
 
+template void Node::apply_electromagnetic_force<double>(Particle& P, double theta) const noexcept;
+template void Node::apply_electromagnetic_force<float>(Particle& P, double theta) const noexcept;
+
+void Node::statistics(TreeStatistics &s, size_t depth) const{
+	s.add_node(depth);
+	s.bytes += sizeof(Node);
+	if(type == EMPTY) ++s.empty;
+	if(type == EXT) ++s.leaves;
+	if(type != INT) return;
+
+	++s.internal;
+	double fullest(0.0);
+	for(Node* child(children); child != children + 8; ++child){
+		child->statistics(s, depth + 1);
+		if(child->type != EMPTY) fullest = std::max(fullest, std::abs(child->total_charge.getCharge()));
+	}
+	s.add_imbalance(std::abs(total_charge.getCharge()), fullest);
+}
+
 void Node::print_elements(void) const{
-	if(type == INT) for(const auto &child : children) child->print_elements();
+	if(type == INT) for(Node* child(children); child != children + 8; ++child) child->print_elements();
 	if(type == EXT){
 		std::cout << *tenant << std::endl;
 		std::cout << " is in\n";
@@ -86,7 +186,7 @@ void Node::draw_tree(void) const{
 	}
 
 	if(type == INT){
-		for(const auto &child : children){
+		for(Node* child(children); child != children + 8; ++child){
 			child->draw_tree();
 		}
 	}
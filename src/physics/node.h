@@ -1,14 +1,20 @@
 #pragma once
 
 #include <array>
+#include <deque>
 
 #include "../vector3d/vector3d.h"
 #include "box.h"
+#include "profile.h"
+#include "tree_statistics.h"
+
+class NodePool;
+class ForceBatch; // see node.cpp
 
 class Node{
 	private:
-		// TODO use unique_ptr
-		std::array<std::unique_ptr<Node>,8> children;
+		Node* children = nullptr; // the first of the 8 children, which the pool holds (see NodePool)
+		NodePool* pool = nullptr;
 		Box domain;
 		Particle* tenant;
 
@@ -21,19 +27,65 @@ class Node{
 
 		void subdivide(void);
 
+		// adds the charges acting on P to the batch, in the order apply_electromagnetic_force<T> applies them
+		void gather(const Particle& P, ForceBatch &batch, double theta) const noexcept;
+
 	public:
-		void reset(void);
+		void reset(void); // empties the tree, whose nodes go back to the pool when it is rewound
+
+		// where the nodes below this one are taken from, which is needed before anything is inserted
+		void setPool(NodePool* my_pool){ pool = my_pool; }
+
+		// reuses the node as an empty node of the given domain
+		void recycle(const Box &my_domain, NodePool* my_pool);
 
 		Box getBox(void) const{ return domain; }
 
-		void apply_electromagnetic_force(Particle& P) const; // recursively increments gravity on P according to Barnes-Hut approximation with parameter THETA
+		// recursively increments gravity on P according to Barnes-Hut approximation with opening angle theta (a cell
+		// acts as a whole if its size is at most theta times its distance to P, so 0 sums over every particle),
+		// each interaction being computed in double or single precision (in double precision with the approximations of
+		// fastmath, the interactions are gathered and computed 8 at a time, see ForceBatch)
+		void apply_electromagnetic_force(Particle& P, Precision precision = Precision::DOUBLE, double theta = simcst::BARNES_HUT_THETA) const noexcept;
+		template<typename T> void apply_electromagnetic_force(Particle& P, double theta) const noexcept;
 
+		Node(void) : Node(Box()){}
 		Node(Box my_Box) : domain(my_Box), type(EMPTY), total_charge(vctr::ZERO_VECTOR, 0.0){}
 
 		bool insert(Particle* my_Point);
 
+		// adds the nodes of the tree below this one, this one being at the given depth
+		void statistics(TreeStatistics &s, size_t depth = 0) const;
+
 		void print_elements(void) const;
 		void print_type(void);
 
 		void draw_tree(void) const;
 };
+
+/*
+ * Storage of the nodes below the roots of the trees, i.e. the elements. The trees are rebuilt at every step, so
+ * the pool hands out the children in groups of 8 from its start after each rewind, and allocates only when it has
+ * handed out all it holds. It then grows by a quarter, so that trees whose size fluctuates from step to step (as
+ * they do with a beam in steady state) are soon built without allocating anything.
+ */
+class NodePool{
+	private:
+		std::deque<std::array<Node,8>> octets; // a deque, so that the nodes stay in place as it grows
+		size_t used = 0;
+
+	public:
+		// node-particle interactions of the trees, and internal nodes opened to compute them, counted if EvolveProfile::ENABLED
+		unsigned long interactions = 0;
+		unsigned long opened = 0;
+
+		Node* acquire(void){
+			if(used == octets.size()) reserve(octets.size() + octets.size()/4 + 16);
+			return octets[used++].data();
+		}
+
+		void rewind(void){ used = 0; }
+		void reserve(size_t n){ while(octets.size() < n) octets.emplace_back(); } // in groups of 8 nodes
+
+		size_t size(void) const{ return used; } // groups of 8 nodes in use since the last rewind
+		size_t capacity(void) const{ return octets.size(); }
+};
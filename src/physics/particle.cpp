@@ -1,20 +1,30 @@
 #include <iostream> // for cout
 #include <iomanip> // for setw
-#include <cmath> // for pow, asin
+#include <cmath> // for pow
 
 #include "particle.h"
 
 #include "element.h"
+#include "element_table.h"
+#include "../vector3d/fast_math.h"
 
 using namespace std;
 using namespace phcst;
 
-Vector3D PointCharge::electromagnetic_force(const PointCharge &Q) const{
-	Vector3D F(*this - Q);
-	F *= K*charge*Q.getCharge()/((gamma*Q.getGamma())*(pow(F.norm2() + simcst::SMOOTHING_CONSTANT, 1.5)));
-	return F;
+template<typename T>
+Vector3D PointCharge::electromagnetic_force(const PointCharge &Q) const noexcept{
+	// the separation is taken in double precision, so that only the (small) relative error of T remains
+	Vector3DT<T> F(*this - Q);
+	const T r2(F.norm2() + T(simcst::SMOOTHING_CONSTANT));
+	if(r2 <= T(0)) return vctr::ZERO_VECTOR; // the smoothing constant underflows in single precision, e.g. for a particle and its own leaf
+	if(fastmath::is_fast()) F *= T(K*charge*Q.getCharge()/(gamma*Q.getGamma())*fastmath::approx::inverse_cube(r2));
+	else F *= T(K*charge*Q.getCharge())/(T(gamma*Q.getGamma())*(pow(r2, T(1.5))));
+	return Vector3D(F);
 }
 
+template Vector3D PointCharge::electromagnetic_force<double>(const PointCharge &Q) const noexcept;
+template Vector3D PointCharge::electromagnetic_force<float>(const PointCharge &Q) const noexcept;
+
 void PointCharge::incorporate(const PointCharge &P){
 	const double q(P.charge);
 
@@ -39,28 +49,44 @@ const RGB Particle::getColor(void) const{
 	return getDefaultColor()->modulate(current_element->orthogonal_offset(*this), current_element->getRadius());
 }
 
-void Particle::scale(double lambda){
-	mass *= lambda;
-	charge *= lambda;
+void Particle::scale(double factor){
+	lambda *= factor;
+	charge *= factor;
 }
 
-void Particle::receive_electromagnetic_force(const PointCharge &Q){
+template<typename T>
+void Particle::receive_electromagnetic_force(const PointCharge &Q) noexcept{
 	// TODO this must be for sufficiently large values of gamma
 	if(this == &Q) return;
 
-	add_force(Q.electromagnetic_force(*this));
+	add_force(Q.electromagnetic_force<T>(*this));
 }
 
-void Particle::add_magnetic_force(const Vector3D &B, double dt){
+template void Particle::receive_electromagnetic_force<double>(const PointCharge &Q) noexcept;
+template void Particle::receive_electromagnetic_force<float>(const PointCharge &Q) noexcept;
+
+void Particle::add_magnetic_force(const Vector3D &B, double dt) noexcept{
 	if(dt <= simcst::ZERO_TIME) return;
 	Vector3D magnetic_force(C_USI*charge*(v^B));
 
 	Vector3D axis(v^magnetic_force);
-	double alpha(asin(dt*magnetic_force.norm()/(2*gamma*mass*C_USI*v.norm())));
+	double alpha(fastmath::asin(dt*magnetic_force.norm()/(2*gamma*getMass()*C_USI*v.norm())));
 	add_force(magnetic_force.rotated(axis, alpha));
 }
 
-void Particle::add_electric_force(const Vector3D &E){
+void Particle::add_momentum(const Vector3D &dp) noexcept{
+	const double mc(getMass()*C_USI);
+	const Vector3D p(gamma*mc*v + dp);
+	v = fastmath::rsqrt(mc*mc + p.norm2()) * p;
+	update_attributes();
+}
+
+void Particle::gyrate(const Vector3D &B, double dt) noexcept{
+	// dv/dt = (q/(gamma.m)) v ^ B, i.e. a rotation around B at the cyclotron frequency
+	v = v.rotated(B, -charge*B.norm()*dt/(gamma*getMass()));
+}
+
+void Particle::add_electric_force(const Vector3D &E) noexcept{
 	add_force(charge*E);
 }
 
@@ -73,8 +99,8 @@ ostream& Particle::print(ostream& output) const{
 	<< setw(indent) << "Position (m)  "; Vector3D::print(output) << "\n"
 	<< setw(indent) << "Velocity (m)  " << C_USI*v << "\n"
 	<< setw(indent) << "Gamma  " << gamma << "\n"
-	<< setw(indent) << "Energy (GeV)  " << 1e-9/E_USI*energy << "\n"
-	<< setw(indent) << "Mass (GeV/c^2)  " << C2_USI*1e-9/E_USI*mass << "\n"
+	<< setw(indent) << "Energy (GeV)  " << 1e-9/E_USI*getEnergy() << "\n"
+	<< setw(indent) << "Mass (GeV/c^2)  " << C2_USI*1e-9/E_USI*getMass() << "\n"
 	<< setw(indent) << "Charge (C)  " << charge << "\n"
 	<< setw(indent) << "Force (N)  " << F  << "\n"
 	<< "\n";
@@ -85,40 +111,49 @@ ostream& operator<<(ostream& output, const Particle &particle){
 	return particle.print(output);
 }
 
-void Particle::move(double dt){
-	v += dt/(gamma*mass*phcst::C_USI) * F;
-	*this += dt * phcst::C_USI * v;
-
-	if(not current_element) return;
+void Particle::setElement(Element* e){
+	current_element = e;
+	if(e) element_index = e->getIndex();
+}
 
-	if(current_element->is_after(*this)){
-		current_element = current_element->getSuccessor();
-	}
+void Particle::setElement(const ElementTable &lattice, size_t i) noexcept{
+	element_index = i;
+	current_element = lattice[i].element;
+}
 
-	if(current_element->is_before(*this)){
-		current_element = current_element->getPredecessor();
-	}
+void Particle::move(double dt) noexcept{
+	add_momentum(dt*F); // the force changes the momentum gamma.m.v, not gamma.m times the velocity
+	*this += dt * phcst::C_USI * v;
 }
 
 void Particle::insert_into_tree(void){
 	current_element->insert(this);
 }
 
-void Particle::evolve(double dt){
-	if(current_element) current_element->apply_forces(*this, dt);
-
+void Particle::evolve(double dt) noexcept{
 	move(dt);
 	reset_force();
 	update_attributes();
+	time += dt;
 }
 
-bool Particle::has_collided(void) const{
+void Particle::evolve(const ElementTable &lattice, double dt, double t, Precision space_charge, double theta) noexcept{
+	lattice[element_index].apply_lorentz_force(*this, dt, t);
+	current_element->apply_electromagnetic_force(*this, space_charge, theta);
+
+	evolve(dt);
+
+	if(lattice[element_index].is_after(*this)) setElement(lattice, lattice[element_index].successor);
+	if(lattice[element_index].is_before(*this)) setElement(lattice, lattice[element_index].predecessor);
+}
+
+bool Particle::has_collided(void) const noexcept{
 	return current_element->has_collided(*this);
 }
 
 Vector3D Particle::radial_vector_calculation(void) const {
 	if (current_element->is_straight()) {return vctr::Z_VECTOR^current_element->direction();}
-	else {Vector3D u = (*this - current_element->center()).unitary(); u -= (vctr::Z_VECTOR|u)*u; return u;}
+	else {Vector3D u = (*this - current_element->center()).unitary_or(vctr::ZERO_VECTOR); u -= (vctr::Z_VECTOR|u)*u; return u;}
 }
 
 double Particle::radial_position(void) const {
@@ -138,9 +173,5 @@ double Particle::vertical_velocity(void) const {
 }
 
 std::unique_ptr<Particle> concrete_particle(const Vector3D &x_0, double E, const Vector3D &dir, char particle_code){
-	switch(particle_code){
-		case 'p': return std::unique_ptr<Particle>(new Proton(x_0, E, dir));
-		case 'e': return std::unique_ptr<Particle>(new Electron(x_0, E, dir));
-		default: throw excptn::UNRECOGNIZED_PARTICLE_CODE;
-	}
+	return std::unique_ptr<Particle>(new Particle(x_0, E, dir, species::find(particle_code)));
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include <cmath>
 #include <memory>
 
@@ -11,9 +12,14 @@
 #include "../misc/exceptions.h"
 
 #include "../vector3d/vector3d.h"
+#include "../vector3d/fast_math.h"
 #include "../misc/constants.h"
 
+#include "species.h"
+
 class Element;
+struct ElementRecord;
+typedef std::vector<ElementRecord> ElementTable; // see element_table.h
 
 class PointCharge : public Vector3D{
 	protected:
@@ -22,7 +28,8 @@ class PointCharge : public Vector3D{
 	public:
 		PointCharge(const Vector3D &x_0, double q) : Vector3D(x_0), charge(q), gamma(1.0){}
 
-		Vector3D electromagnetic_force(const PointCharge &Q) const;
+		// computed in the scalar type T (double or float) from the separation of the two charges, see Precision
+		template<typename T = double> Vector3D electromagnetic_force(const PointCharge &Q) const noexcept;
 
 		double getCharge(void) const{ return charge; }
 		double getGamma(void) const{ return gamma; }
@@ -33,51 +40,50 @@ class PointCharge : public Vector3D{
 class Particle : public Drawable, public PointCharge{
 	friend Beam;// TODO needed?
 
-	protected:
-		explicit Particle(Canvas* vue, const Vector3D &x_0, const Vector3D &v_0, double my_mass, double my_charge) :
-			Drawable(vue),
-			PointCharge(x_0,my_charge),
-			v(Vector3D(v_0)),
-			F(vctr::ZERO_VECTOR),
-			mass(my_mass)
-	{ update_attributes(); }
-
 	private:
 		Vector3D v; // velocity (in c)
 		Vector3D F; // force (in N)
 
-		double mass; // (in kg)
-
-		double energy;
+		double lambda = 1.0; // number of particles represented (see scale())
 
 		Element* current_element = nullptr;
+		size_t element_index = 0; // index of current_element in the element table
+
+		double time = 0.0; // the particle's own clock (in s), advanced by both tracking engines
+
+		// the small fields last, in one word (144 bytes in all, with the energy computed from gamma rather than stored)
+		unsigned int id = 0; // identifier given by the accelerator, stable for the particle's lifetime
+		species::Id species_id;
 
 	public:
-		explicit Particle(const Vector3D &x_0, const Vector3D &v_0, double my_mass, double my_charge) :
+		explicit Particle(const Vector3D &x_0, const Vector3D &v_0, species::Id s) :
 			Drawable(nullptr),
-			PointCharge(x_0,my_charge),
+			PointCharge(x_0, species::get(s).charge),
 			v(Vector3D(v_0)),
-			mass(my_mass)
+			species_id(s)
 		{ update_attributes(); }
 
-		explicit Particle(const Vector3D &x_0, double E_gev, const Vector3D &dir, double mass_gev_c2, double charge_e) :
+		explicit Particle(const Vector3D &x_0, double E_gev, const Vector3D &dir, species::Id s) :
 			Drawable(nullptr),
-			PointCharge(x_0,phcst::E_USI*charge_e),
-			v(dir.is_zero() or E_gev <= simcst::ZERO_ENERGY_GEV ? vctr::ZERO_VECTOR : sqrt(1.0 - (mass_gev_c2*mass_gev_c2)/(E_gev*E_gev))*dir.unitary()),
-			mass(1e9*phcst::E_USI/phcst::C2_USI * mass_gev_c2)
+			PointCharge(x_0, species::get(s).charge),
+			v(dir.is_zero() or E_gev <= simcst::ZERO_ENERGY_GEV ? vctr::ZERO_VECTOR : sqrt(1.0 - (species::get(s).mass_gev_c2*species::get(s).mass_gev_c2)/(E_gev*E_gev))*dir.unitary()),
+			species_id(s)
 		{ update_attributes(); }
 
-		virtual std::string particle_type(void) const{ return "Generic particle"; }
+		const Species& getSpecies(void) const{ return species::get(species_id); }
+		species::Id getSpecies_id(void) const{ return species_id; }
+		std::string particle_type(void) const{ return getSpecies().name; }
 
-		virtual std::unique_ptr<Particle> copy(void) const{ return std::unique_ptr<Particle>(new Particle(*this)); }; // polymorphic copy method
+		std::unique_ptr<Particle> copy(void) const{ return std::unique_ptr<Particle>(new Particle(*this)); }
 
-		void scale(double lambda);
+		void scale(double factor); // makes the particle stand for factor times as many particles of its species
+		double getLambda(void) const{ return lambda; }
 
 		std::ostream& print(std::ostream &stream) const;
 		virtual void draw(void) override{ canvas->draw(*this); }
 
-		double getMass(void) const{ return mass; }
-		virtual double getRadius(void) const{ return simcst::REPRESENTED_RADIUS_DEFAULT; };
+		double getMass(void) const noexcept{ return lambda*species::mass(species_id); }
+		double getRadius(void) const{ return getSpecies().represented_radius; }
 
 		Vector3D getVelocity(void) const{ return v; }
 		Vector3D getForce(void) const{ return F; }
@@ -86,34 +92,47 @@ class Particle : public Drawable, public PointCharge{
 
 		void setVelocity(const Vector3D &x){ v = x; }
 
-		void setElement(Element* e){ current_element = e; }
+		void setElement(Element* e);
+		void setElement(const ElementTable &lattice, size_t i) noexcept;
+		const Element* getElement(void) const{ return current_element; }
+		size_t getElement_index(void) const{ return element_index; }
+
+		unsigned int getId(void) const{ return id; }
+		void setId(unsigned int my_id){ id = my_id; }
+
+		double getTime(void) const{ return time; }
+		void setTime(double t){ time = t; }
 
-		virtual const RGB* getDefaultColor(void) const{ return &RGB::BLACK; }
+		const RGB* getDefaultColor(void) const{ return getSpecies().color; }
 
 		const RGB getColor(void) const;
 
 		void setCanvas(Canvas* c){ canvas = c; }
 
-		void reset_force(void){ F = vctr::ZERO_VECTOR; }
+		void reset_force(void) noexcept{ F = vctr::ZERO_VECTOR; }
 
-		inline void add_force(const Vector3D& my_F){ F += my_F; };
-		void add_magnetic_force(const Vector3D& B, double dt);
-		void add_electric_force(const Vector3D &E);
-		void receive_electromagnetic_force(const PointCharge &Q);
+		inline void add_force(const Vector3D& my_F) noexcept{ F += my_F; };
+		void add_momentum(const Vector3D &dp) noexcept; // changes the momentum gamma.m.v (in kg.m/s), and the velocity accordingly
+		void gyrate(const Vector3D &B, double dt) noexcept; // exact rotation of the velocity in a uniform magnetic field during dt
 
-		double getEnergy(void) const{ return energy; };
+		// the push and the forces never throw: degenerate cases (e.g. a zero axis of rotation) leave the particle unchanged
+		void add_magnetic_force(const Vector3D& B, double dt) noexcept;
+		void add_electric_force(const Vector3D &E) noexcept;
+		template<typename T = double> void receive_electromagnetic_force(const PointCharge &Q) noexcept;
 
-		inline void update_attributes(void){
-			gamma = 1.0/(sqrt(1.0 - v.norm2()));
-			energy = gamma*mass*phcst::C2_USI;
-		}
+		double getEnergy(void) const noexcept{ return gamma*getMass()*phcst::C2_USI; }
 
-		void move(double dt);
+		inline void update_attributes(void) noexcept{ gamma = fastmath::rsqrt(1.0 - v.norm2()); }
+
+		void move(double dt) noexcept;
 
 		void insert_into_tree(void);
-		void evolve(double dt);
+		void evolve(double dt) noexcept; // free motion under the force applied so far
+		// in the element of the lattice it is in, whose fields are taken at time t, the space charge (if any) being computed with the given
+		// precision and Barnes-Hut opening angle (see Node::apply_electromagnetic_force)
+		void evolve(const ElementTable &lattice, double dt, double t, Precision space_charge = Precision::DOUBLE, double theta = simcst::BARNES_HUT_THETA) noexcept;
 
-		bool has_collided(void) const;
+		bool has_collided(void) const noexcept; // true as well for a position that is not a number
 
 		Vector3D radial_vector_calculation(void) const; // returns the vector used to calculate radial position and velocity
 		double radial_position(void) const;
@@ -122,37 +141,18 @@ class Particle : public Drawable, public PointCharge{
 		double vertical_velocity(void) const;
 };
 
+// shorthands for the most common species
 class Electron : public Particle{
 	public:
-		explicit Electron(const Vector3D &x_0, const double E, const Vector3D &dir) :
-			Particle(x_0, E, dir, phcst::MASS_ELECTRON_GEV_C2, -1.0)
-		{}
-
-		virtual double getRadius(void) const override{ return simcst::REPRESENTED_RADIUS_ELECTRON; };
-
-		virtual std::string particle_type(void) const override{ return "Electron"; }
-
-		virtual const RGB* getDefaultColor(void) const override{ return &RGB::GREEN; }
-
-		virtual std::unique_ptr<Particle> copy(void) const override{ return std::unique_ptr<Electron>(new Electron(*this)); }; // polymorphic copy method
+		explicit Electron(const Vector3D &x_0, const double E, const Vector3D &dir) : Particle(x_0, E, dir, species::ELECTRON){}
 };
 
 class Proton : public Particle{
 	public:
-		explicit Proton(const Vector3D &x_0, const double E, const Vector3D &dir) :
-			Particle(x_0, E, dir, phcst::MASS_PROTON_GEV_C2, 1.0)
-		{}
-
-		virtual double getRadius(void) const override{ return simcst::REPRESENTED_RADIUS_PROTON; };
-
-		virtual std::string particle_type(void) const override{ return "Proton"; }
-
-		virtual const RGB* getDefaultColor(void) const override{ return &RGB::BLUE; }
-
-		virtual std::unique_ptr<Particle> copy(void) const override{ return std::unique_ptr<Proton>(new Proton(*this)); }; // polymorphic copy method
+		explicit Proton(const Vector3D &x_0, const double E, const Vector3D &dir) : Particle(x_0, E, dir, species::PROTON){}
 };
 
-// instanciate an instance of a concrete subclasses using a character code ('e' for electron, 'p' for proton etc.)
+// instanciate a particle of the species with the given code ('e' for electron, 'p' for proton etc., see species.cpp)
 std::unique_ptr<Particle> concrete_particle(const Vector3D &x_0, double E, const Vector3D &dir, char particle_code);
 
 std::ostream& operator<<(std::ostream& output, Particle const& particle);
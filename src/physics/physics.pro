@@ -8,18 +8,34 @@ INCLUDEPATH += \
 
 SOURCES += \
 	particle.cpp \
+	species.cpp \
 	box.cpp \
 	node.cpp \
 	beam.cpp \
 	element.cpp \
 	accelerator.cpp \
 	accelerator_cli.cpp \
+	transfer_map.cpp \
+	transport.cpp \
+	profile.cpp \
+	trace.cpp \
+	tree_statistics.cpp \
 
 HEADERS += \
 	particle.h \
+	species.h \
 	box.h \
 	node.h \
 	beam.h \
 	element.h \
 	accelerator.h \
 	accelerator_cli.h \
+	transfer_map.h \
+	segment.h \
+	element_table.h \
+	static_lattice.h \
+	profile.h \
+	trace.h \
+	tree_statistics.h \
+
+include(../cernjunior.pri)
@@ -0,0 +1,38 @@
+#include "profile.h"
+
+#include <iomanip>
+
+constexpr bool EvolveProfile::ENABLED;
+constexpr size_t EvolveProfile::PHASES;
+
+const char* EvolveProfile::name(Phase phase){
+	switch(phase){
+		case RESET: return "element reset";
+		case COLLISIONS: return "collisions";
+		case TREES: return "tree insertion";
+		default: return "push";
+	}
+}
+
+std::ostream& EvolveProfile::print(std::ostream& output) const{
+	output << "PROFILE:\n\n";
+	if(not ENABLED){
+		output << "   compiled out (CERNJUNIOR_NO_PROFILE)\n\n";
+		return output;
+	}
+
+	const double total(total_seconds());
+	output << "   " << steps << " steps in " << total << " s\n";
+	for(size_t i(0); i < PHASES; ++i){
+		output << "   " << std::left << std::setw(16) << name(Phase(i)) << std::right << seconds[i] << " s";
+		if(total > 0.0) output << " (" << std::setprecision(3) << 100.0*seconds[i]/total << std::setprecision(6) << " %)";
+		output << "\n";
+	}
+	output << "   particles pushed: " << pushed << "\n";
+	output << "   particles lost: " << lost << "\n";
+	output << "   tree nodes: " << nodes << "\n";
+	output << "   interactions: " << interactions << "\n";
+	output << "   opened nodes: " << opened << "\n";
+	output << "   element crossings: " << crossings << "\n\n";
+	return output;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+#include "trace.h"
+
+/*
+ * Where the time of Accelerator::evolve goes: the wall time of each phase of a step and a few counters, summed
+ * over the steps since the last clear(). The push phase covers both the fields of the lattice and the space
+ * charge, whose share the number of interactions tells (timing them apart would cost a clock read per particle,
+ * more than the field of most elements).
+ *
+ * Defining CERNJUNIOR_NO_PROFILE compiles the instrumentation out, the profile then staying empty. This header is
+ * inlined into the libraries and the programs alike, which would otherwise disagree on what is counted (and break the
+ * one-definition rule), so the define must be set for the whole tree, in cernjunior.pri, never in a single project.
+ */
+struct EvolveProfile{
+#ifdef CERNJUNIOR_NO_PROFILE
+	static constexpr bool ENABLED = false;
+#else
+	static constexpr bool ENABLED = true;
+#endif
+
+	enum Phase : unsigned char { RESET, COLLISIONS, TREES, PUSH };
+	static constexpr size_t PHASES = 4;
+	static const char* name(Phase phase);
+
+	std::array<double,PHASES> seconds = {{}}; // wall time of each phase
+	unsigned long steps = 0;
+	unsigned long pushed = 0; // particle pushes, of which a particle takes several per step at the finer block levels
+	unsigned long lost = 0; // particles removed after a collision
+	unsigned long nodes = 0; // tree nodes handed out by the pool, roots excluded
+	unsigned long interactions = 0; // node-particle interactions of the space charge
+	unsigned long opened = 0; // internal nodes descended into to compute them
+	unsigned long crossings = 0; // passages of a particle from an element to the next or the previous one
+
+	double total_seconds(void) const{ return seconds[RESET] + seconds[COLLISIONS] + seconds[TREES] + seconds[PUSH]; }
+	void clear(void){ *this = EvolveProfile(); }
+
+	std::ostream& print(std::ostream& output) const;
+};
+
+// adds the time elapsed since the previous lap (or the construction) to a phase, and records it as a trace event
+// if tracing is on (see trace.h), the clock being read once for both
+class PhaseTimer{
+	private:
+		EvolveProfile &profile;
+		const bool tracing;
+		uint64_t last; // see trace::detail::now
+
+	public:
+		explicit PhaseTimer(EvolveProfile &my_profile) :
+			profile(my_profile), tracing(trace::active()), last(EvolveProfile::ENABLED or tracing ? trace::detail::now() : 0){}
+
+		void lap(EvolveProfile::Phase phase, int64_t particles){
+			if(not EvolveProfile::ENABLED and not tracing) return;
+			const uint64_t now(trace::detail::now());
+			if(EvolveProfile::ENABLED) profile.seconds[phase] += 1e-9*(now - last);
+			if(tracing) trace::detail::record({EvolveProfile::name(phase), "evolve", last, now - last, "particles", particles});
+			last = now;
+		}
+};
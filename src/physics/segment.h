@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cmath>
+
+#include "../vector3d/vector3d.h"
+#include "../misc/constants.h"
+
+namespace lattice{
+	class Segment{
+		// geometry of an element: that of Element, and of the compact lattices (see static_lattice.h and element_table.h)
+		protected:
+			Vector3D entry_point;
+			Vector3D exit_point;
+			double radius;
+			double curvature;
+			double length = 0.0;
+
+			Vector3D dir;
+			Vector3D curvature_center; // of curved elements
+			Vector3D u; // from the center to the entry point, or along dir for straight elements
+			Vector3D v;
+
+		public:
+			constexpr Segment(double my_radius, double my_curvature, const Vector3D &exit) : exit_point(exit), radius(my_radius), curvature(my_curvature){}
+
+			void place(const Vector3D &entry){
+				// called by the lattice once the previous element is placed
+				entry_point = entry;
+				const Vector3D d(exit_point - entry_point);
+				dir = d.unitary();
+				if(is_straight()){
+					length = d.norm();
+					u = dir;
+					v = u.orthogonal();
+				}else{
+					length = 2.0*std::asin(d.norm()*curvature/2.0)/curvature;
+					curvature_center = 0.5*(entry_point + exit_point) + (1.0/curvature)*std::sqrt(std::abs(1.0 - 0.25*curvature*curvature*d.norm2()))*(d^vctr::Z_VECTOR).unitary();
+					u = (entry_point - curvature_center).unitary();
+					v = exit_point - curvature_center;
+					v -= (v|u)*u;
+					v = v.is_zero() ? (u^vctr::Z_VECTOR).unitary() : v.unitary();
+				}
+			}
+
+			Vector3D getEntry_point(void) const noexcept{ return entry_point; }
+			Vector3D getExit_point(void) const noexcept{ return exit_point; }
+			double getRadius(void) const noexcept{ return radius; }
+			double getCurvature(void) const noexcept{ return curvature; }
+			double getLength(void) const noexcept{ return length; }
+
+			constexpr bool is_straight(void) const noexcept{ return curvature <= simcst::ZERO_CURVATURE and curvature >= -simcst::ZERO_CURVATURE; }
+
+			Vector3D local_trajectory(double s) const noexcept{
+				if(is_straight()) return dir;
+				const double beta(s*std::abs(curvature));
+				return -std::sin(beta)*u + std::cos(beta)*v;
+			}
+
+			double curvilinear_coord(const Vector3D &x) const noexcept{
+				if(is_straight()) return (x - entry_point)|dir;
+				// angle swept from the entry point, so that this is the inverse of Element::inverse_curvilinear_coord
+				const Vector3D X(x - curvature_center);
+				return std::atan2(X|v, X|u) / std::abs(curvature);
+			}
+
+			bool has_collided(const Vector3D &r) const noexcept{
+				if(is_straight()){
+					const Vector3D y(r - entry_point);
+					return not ((y - (y|u)*u).norm() < radius); // lost if not a number
+				}
+				const Vector3D X(r - curvature_center);
+				const Vector3D horizontal(X - r[2]*vctr::Z_VECTOR);
+				if(horizontal.is_zero()) return true; // directly over the center
+				return not ((X - (1.0/std::abs(curvature))*horizontal.unitary_or(vctr::X_VECTOR)).norm() < radius);
+			}
+
+			// the boundaries are the planes orthogonal to the ideal orbit at the entry and exit points,
+			// so that consecutive elements share them (for curved elements, this is not the plane orthogonal to the chord)
+			bool is_after(const Vector3D &r) const noexcept{ return ((r - exit_point)|local_trajectory(length)) > 0.0; }
+			bool is_before(const Vector3D &r) const noexcept{ return ((r - entry_point)|local_trajectory(0.0)) < 0.0; }
+			bool contains(const Vector3D &r) const noexcept{ return not is_after(r) and not is_before(r) and not has_collided(r); }
+	};
+}
@@ -0,0 +1,73 @@
+#include <vector>
+#include <cctype> // for tolower
+
+#include "species.h"
+#include "../misc/constants.h"
+#include "../misc/exceptions.h"
+
+using namespace std;
+
+Species::Species(const std::string &my_name, char my_code, double my_mass_gev_c2, double charge_e, double my_represented_radius, const RGB* my_color) :
+	name(my_name),
+	code(my_code),
+	mass_gev_c2(my_mass_gev_c2),
+	mass(species::kilograms(mass_gev_c2)),
+	charge(phcst::E_USI*charge_e),
+	represented_radius(my_represented_radius),
+	color(my_color)
+{}
+
+double species::detail::masses[simcst::MAX_SPECIES] = {
+	kilograms(phcst::MASS_PROTON_GEV_C2), kilograms(phcst::MASS_ELECTRON_GEV_C2), kilograms(phcst::MASS_ELECTRON_GEV_C2), kilograms(phcst::MASS_ALPHA_GEV_C2)
+};
+
+namespace{
+	vector<Species>& registry(void){
+		// built on first use, so that particles may be made during static initialization
+		static vector<Species> all = {
+			Species("Proton", 'p', phcst::MASS_PROTON_GEV_C2, 1.0, simcst::REPRESENTED_RADIUS_PROTON, &RGB::BLUE),
+			Species("Electron", 'e', phcst::MASS_ELECTRON_GEV_C2, -1.0, simcst::REPRESENTED_RADIUS_ELECTRON, &RGB::GREEN),
+			Species("Positron", '+', phcst::MASS_ELECTRON_GEV_C2, 1.0, simcst::REPRESENTED_RADIUS_ELECTRON, &RGB::YELLOW),
+			Species("Alpha", 'a', phcst::MASS_ALPHA_GEV_C2, 2.0, simcst::REPRESENTED_RADIUS_DEFAULT, &RGB::PURPLE),
+		};
+		return all;
+	}
+
+	string lower(string s){
+		for(auto &c : s) c = tolower(c);
+		return s;
+	}
+}
+
+const Species& species::get(Id id){
+	return registry()[id];
+}
+
+species::Id species::add(const Species &s){
+	if(registry().size() >= simcst::MAX_SPECIES) throw excptn::TOO_MANY_SPECIES;
+	for(const auto &t : registry()){
+		if(t.code == s.code) throw excptn::DUPLICATE_PARTICLE_CODE;
+	}
+	registry().push_back(s);
+	detail::masses[registry().size() - 1] = s.mass;
+	return registry().size() - 1;
+}
+
+size_t species::count(void){
+	return registry().size();
+}
+
+species::Id species::find(char code){
+	for(size_t i(0); i < registry().size(); ++i){
+		if(registry()[i].code == code) return i;
+	}
+	throw excptn::UNRECOGNIZED_PARTICLE_CODE;
+}
+
+species::Id species::find(const std::string &name){
+	if(name.size() == 1) return find(name[0]);
+	for(size_t i(0); i < registry().size(); ++i){
+		if(lower(registry()[i].name) == lower(name)) return i;
+	}
+	throw excptn::UNRECOGNIZED_PARTICLE_CODE;
+}
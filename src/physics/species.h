@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+#include "../color/rgb.h"
+#include "../misc/constants.h"
+
+/*
+ * Registry of the particle species. A particle only stores the id of its species and its macro weight lambda
+ * (see Particle::scale): its mass and charge are those of the species times lambda. Species other than the
+ * built-in ones are registered at run time with species::add, and need no class of their own.
+ */
+struct Species{
+	std::string name;
+	char code; // one-letter code, as used on the command line and in batch configurations
+	double mass_gev_c2; // rest mass (in GeV/c^2)
+	double mass; // (in kg)
+	double charge; // (in C)
+	double represented_radius; // radius of the spheres drawn for the particles
+	const RGB* color;
+
+	Species(const std::string &my_name, char my_code, double my_mass_gev_c2, double charge_e, double my_represented_radius, const RGB* my_color);
+
+	double charge_to_mass(void) const{ return charge/mass; } // (in C/kg)
+};
+
+namespace species{
+	typedef unsigned char Id;
+
+	constexpr double kilograms(double gev_c2){ return 1e9*phcst::E_USI/phcst::C2_USI * gev_c2; } // a rest mass given in GeV/c^2
+
+	// the built-in species, registered in this order
+	constexpr Id PROTON(0);
+	constexpr Id ELECTRON(1);
+	constexpr Id POSITRON(2);
+	constexpr Id ALPHA(3);
+
+	namespace detail{
+		// rest masses (in kg) by id: constant-initialized for the built-in species, so that particles may be made
+		// during static initialization, and read inline by the push (see Particle::getMass)
+		extern double masses[simcst::MAX_SPECIES];
+	}
+
+	const Species& get(Id id);
+	inline double mass(Id id) noexcept{ return detail::masses[id]; } // same as get(id).mass
+	Id add(const Species &s); // returns the id of the new species, whose code must not be taken yet
+	size_t count(void);
+
+	Id find(char code); // throws UNRECOGNIZED_PARTICLE_CODE if no species has that code
+	Id find(const std::string &name); // by name (in any case) or by code
+}
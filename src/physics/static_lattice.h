@@ -0,0 +1,276 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+#include <memory>
+#include <utility> // for swap
+#include <type_traits> // for integral_constant
+#include <initializer_list>
+#include <cmath>
+
+#include "accelerator.h"
+#include "segment.h"
+
+/*
+ * Lattices fixed at compile time. A StaticLattice is declared as the list of the kinds of its elements, e.g.
+ *   StaticLattice<lattice::Fodo, lattice::Bend, lattice::Fodo, lattice::Bend>
+ * so that the element a particle is in is an index into a tuple rather than a pointer to a polymorphic Element.
+ * Field evaluation and element transitions are then resolved by the compiler for each kind, with no virtual
+ * call on the way. The elements follow the same geometry and the same time-stepping scheme as their runtime
+ * counterparts (without space charge), and build() appends those to an Accelerator so that both can be compared.
+ */
+
+namespace lattice{
+	// the kinds are literal types, so that a lattice can be described by constants (see cernjunior::default_ring): their
+	// constructors and fields are constexpr, the placement alone (see Segment::place) being left to run time, since it
+	// takes square roots and arc sines. Each kind computes once, when placed, what its field needs besides its parameters
+	struct Straight : public Segment{
+		constexpr Straight(double radius, const Vector3D &end) : Segment(radius, 0.0, end){}
+
+		void apply_lorentz_force(Particle&, double, double) const noexcept{}
+		void build(Accelerator &w) const{ w.addStraightSection(radius, exit_point); }
+	};
+
+	struct Bend : public Segment{
+		double B_0;
+
+		constexpr Bend(double radius, double curvature, double my_B_0, const Vector3D &end) : Segment(radius, curvature, end), B_0(my_B_0){}
+
+		constexpr Vector3D B(void) const noexcept{ return B_0*vctr::Z_VECTOR; }
+
+		void apply_lorentz_force(Particle &p, double dt, double) const noexcept{ p.add_magnetic_force(B(), dt); }
+		void build(Accelerator &w) const{ w.addDipole(radius, curvature, B_0, exit_point); }
+	};
+
+	struct Quad : public Segment{
+		double b;
+		Vector3D transverse; // horizontal, orthogonal to the orbit, set by place()
+
+		constexpr Quad(double radius, double my_b, const Vector3D &end) : Segment(radius, 0.0, end), b(my_b){}
+
+		void place(const Vector3D &entry){
+			Segment::place(entry);
+			transverse = vctr::Z_VECTOR ^ dir;
+		}
+
+		// the field of a quadrupole of gradient b at x, y being x relative to the orbit
+		static constexpr Vector3D B(double b, const Vector3D &x, const Vector3D &y, const Vector3D &transverse) noexcept{
+			return b*((y|transverse)*vctr::Z_VECTOR + x[2]*transverse);
+		}
+		constexpr Vector3D offset(const Vector3D &x) const noexcept{ return (x - entry_point) - ((x - entry_point)|dir)*dir; }
+
+		void apply_lorentz_force(Particle &p, double dt, double) const noexcept{ p.add_magnetic_force(B(b, p, offset(p), transverse), dt); }
+		void build(Accelerator &w) const{ w.addQuadrupole(radius, b, exit_point); }
+	};
+
+	struct Fodo : public Quad{
+		// the four elements of Accelerator::addFodoCell, i.e. a compiled FodoCell: a quadrupole of gradient b, a
+		// straight section of length L, a quadrupole of gradient -b and a straight section of length L
+		double L;
+		double l = 0.0; // length of each quadrupole, set by place()
+
+		constexpr Fodo(double radius, double my_b, double my_L, const Vector3D &end) : Quad(radius, my_b, end), L(my_L){}
+
+		void place(const Vector3D &entry){
+			Quad::place(entry);
+			l = 0.5*length - L;
+		}
+
+		void apply_lorentz_force(Particle &p, double dt, double) const noexcept{
+			const double s((p - entry_point)|dir);
+			if(s < l) p.add_magnetic_force(B(b, p, offset(p), transverse), dt);
+			else if(s >= l + L and s < 2.0*l + L) p.add_magnetic_force(B(-b, p, offset(p), transverse), dt);
+		}
+		void build(Accelerator &w) const{ w.addFodoCell(radius, b, L, exit_point); }
+	};
+
+	struct Cavity : public Segment{
+		double E_0;
+		double omega;
+		double kappa;
+		double phi;
+
+		constexpr Cavity(double radius, double my_E_0, double my_omega, double my_kappa, double my_phi, const Vector3D &end) :
+			Segment(radius, 0.0, end), E_0(my_E_0), omega(my_omega), kappa(my_kappa), phi(my_phi)
+		{}
+
+		void apply_lorentz_force(Particle &p, double, double t) const noexcept{
+			p.add_electric_force(E_0*fastmath::sin(omega*t - kappa*curvilinear_coord(p) + phi) * dir);
+		}
+		void build(Accelerator &w) const{ w.addRadiofrequencyCavity(radius, E_0, omega, kappa, phi, exit_point); }
+	};
+}
+
+template<class... Kinds>
+class StaticLattice{
+	private:
+		typedef std::tuple<Kinds...> Elements;
+		static constexpr size_t N = sizeof...(Kinds);
+
+		Elements elements;
+
+		// held by value, so that the push runs through contiguous memory (the particles' vtables are never used here)
+		std::vector<Particle> particles;
+		std::vector<size_t> element; // index of the element each particle is in
+
+		double time = 0.0;
+
+		// calls f(e) on the i-th element, resolved at compile time for each kind
+		template<class F, size_t I>
+		void visit(size_t i, F &f, std::integral_constant<size_t,I>) const{
+			if(i == I) f(std::get<I>(elements));
+			else visit(i, f, std::integral_constant<size_t,I+1>());
+		}
+		template<class F>
+		void visit(size_t, F&, std::integral_constant<size_t,N>) const{}
+
+		template<class F>
+		void visit(size_t i, F &f) const{ visit(i, f, std::integral_constant<size_t,0>()); }
+
+		template<size_t I>
+		void place(const Vector3D &entry, std::integral_constant<size_t,I>){
+			std::get<I>(elements).place(entry);
+			place(std::get<I>(elements).getExit_point(), std::integral_constant<size_t,I+1>());
+		}
+		void place(const Vector3D&, std::integral_constant<size_t,N>){}
+
+		template<size_t I>
+		void build(Accelerator &w, std::integral_constant<size_t,I>) const{
+			std::get<I>(elements).build(w);
+			build(w, std::integral_constant<size_t,I+1>());
+		}
+		void build(Accelerator&, std::integral_constant<size_t,N>) const{}
+
+		struct Containment{
+			const Vector3D &r;
+			bool contained;
+			template<class K> void operator()(const K &e){ contained = e.contains(r); }
+		};
+
+		// a whole step of a particle in its element, with a single dispatch on the kind of the element
+		struct Step{
+			Particle &p;
+			double dt;
+			double t;
+			bool lost;
+			int step; // +1 to the successor, -1 to the predecessor, 0 to stay
+			template<class K> void operator()(const K &e){
+				lost = e.has_collided(p);
+				if(lost) return;
+
+				e.apply_lorentz_force(p, dt, t);
+				p.add_momentum(dt*p.getForce());
+				p.setPosition(p + dt * phcst::C_USI * p.getVelocity());
+				p.reset_force();
+				p.setTime(p.getTime() + dt);
+
+				step = e.is_after(p) ? 1 : e.is_before(p) ? -1 : 0;
+			}
+		};
+
+		struct Return{
+			const Vector3D &r;
+			bool back; // to the predecessor, after a step to the successor
+			template<class K> void operator()(const K &e){ back = not e.is_after(r) and e.is_before(r); }
+		};
+
+	public:
+		StaticLattice(const Vector3D &origin, const Kinds&... kinds) : elements(kinds...){
+			place(origin, std::integral_constant<size_t,0>());
+		}
+
+		static constexpr size_t size(void){ return N; }
+
+		template<size_t I>
+		const typename std::tuple_element<I, Elements>::type& get(void) const{ return std::get<I>(elements); }
+
+		// appends the equivalent runtime elements to w
+		void build(Accelerator &w) const{ build(w, std::integral_constant<size_t,0>()); }
+
+		// copies the particles of w, placing each in the element that contains it
+		void load(const Accelerator &w){
+			for(size_t k(0); k < w.particle_count(); ++k){
+				for(size_t i(0); i < N; ++i){
+					Containment c{w.getParticle(k), false};
+					visit(i, c);
+					if(c.contained){
+						particles.push_back(w.getParticle(k));
+						element.push_back(i);
+						break;
+					}
+				}
+			}
+		}
+
+		bool is_empty(void) const{ return particles.empty(); }
+		size_t particle_count(void) const{ return particles.size(); }
+		const Particle& getParticle(size_t k) const{ return particles[k]; }
+		size_t getElement_index(size_t k) const{ return element[k]; }
+		double getTime(void) const{ return time; }
+
+		// same scheme as Accelerator::evolve without space charge, in a single pass: since the particles do not interact,
+		// removing a lost particle before or after pushing the others makes no difference, and the particles end up in
+		// the same order
+		void evolve(double dt){
+			time += dt;
+
+			for(size_t k(0); k < particles.size();){
+				Step s{particles[k], dt, time, false, 0};
+				visit(element[k], s);
+				if(s.lost){
+					std::swap(particles[k], particles.back());
+					std::swap(element[k], element.back());
+					particles.pop_back();
+					element.pop_back();
+					continue;
+				}
+
+				if(s.step != 0) element[k] = (element[k] + N + s.step) % N;
+				if(s.step == 1){
+					Return r{particles[k], false};
+					visit(element[k], r);
+					if(r.back) element[k] = (element[k] + N - 1) % N;
+				}
+				++k;
+			}
+		}
+};
+
+namespace cernjunior{
+	// the lattice of build_default_accelerator
+	typedef StaticLattice<lattice::Fodo, lattice::Bend, lattice::Fodo, lattice::Bend, lattice::Fodo, lattice::Bend, lattice::Fodo, lattice::Bend> DefaultRing;
+
+	inline DefaultRing default_ring(void){
+		constexpr double r(0.5);
+		constexpr double k(1.0);
+
+		constexpr double B(5.89158);
+		constexpr double b(1.2);
+
+		constexpr Vector3D origin(3,2,0);
+		return DefaultRing(origin,
+			lattice::Fodo(r, b, 1.0, Vector3D(3,-2)), lattice::Bend(r, k, B, Vector3D(2,-3)),
+			lattice::Fodo(r, b, 1.0, Vector3D(-2,-3)), lattice::Bend(r, k, B, Vector3D(-3,-2)),
+			lattice::Fodo(r, b, 1.0, Vector3D(-3,2)), lattice::Bend(r, k, B, Vector3D(-2,3)),
+			lattice::Fodo(r, b, 1.0, Vector3D(2,3)), lattice::Bend(r, k, B, origin)
+		);
+	}
+
+	// same layout as the default ring, starting at (6,2,0) with a narrower chamber and weaker dipoles, since the
+	// default ring is horizontally unstable: the ring of the tests of the linear optics and of the tracking engines
+	inline DefaultRing stable_ring(void){
+		constexpr double RIGIDITY(5.89158); // of a 2 GeV proton (in T.m)
+		constexpr double r(0.1);
+		constexpr double h(2.0);
+		constexpr double rho(4.0);
+		constexpr double b(1.0);
+
+		constexpr Vector3D origin(h+rho,h,0);
+		return DefaultRing(origin,
+			lattice::Fodo(r, b, 1.0, Vector3D(h+rho,-h)), lattice::Bend(r, 1.0/rho, RIGIDITY/rho, Vector3D(h,-h-rho)),
+			lattice::Fodo(r, b, 1.0, Vector3D(-h,-h-rho)), lattice::Bend(r, 1.0/rho, RIGIDITY/rho, Vector3D(-h-rho,-h)),
+			lattice::Fodo(r, b, 1.0, Vector3D(-h-rho,h)), lattice::Bend(r, 1.0/rho, RIGIDITY/rho, Vector3D(-h,h+rho)),
+			lattice::Fodo(r, b, 1.0, Vector3D(h,h+rho)), lattice::Bend(r, 1.0/rho, RIGIDITY/rho, origin)
+		);
+	}
+}
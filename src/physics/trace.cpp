@@ -0,0 +1,169 @@
+#include "trace.h"
+
+#include <algorithm> // for min
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../misc/exceptions.h"
+
+namespace trace{
+	namespace detail{
+		std::atomic<bool> enabled(false);
+		std::atomic<int64_t> epoch(0);
+	}
+}
+
+namespace{
+	// the events of one thread, the last ones overwriting the oldest once it is full
+	struct Buffer{
+		std::vector<trace::Event> events;
+		std::atomic<uint64_t> recorded; // since start(), only written by the owning thread
+		unsigned int tid;
+		std::string name;
+		bool in_use = true; // by a running thread, guarded by registry_mutex
+
+		Buffer(size_t capacity, unsigned int my_tid) : events(capacity), recorded(0), tid(my_tid){}
+
+		size_t size(void) const{ return std::min<uint64_t>(recorded.load(std::memory_order_acquire), events.size()); }
+	};
+
+	// buffers outlive their threads, so that the events of the workers of an ensemble are still there to be written,
+	// and a thread that exits hands its buffer (and its track) over to the next thread that records: there are never
+	// more buffers than threads alive at once, however many thread pools come and go
+	std::mutex registry_mutex;
+	std::vector<std::unique_ptr<Buffer>> registry;
+	size_t capacity(0); // of the buffers, set by start()
+
+	thread_local Buffer* own(nullptr);
+
+	// releases the buffer of its thread when the thread exits
+	struct Release{
+		Buffer* buffer = nullptr;
+		~Release(void){
+			if(not buffer) return;
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			buffer->in_use = false;
+		}
+	};
+	thread_local Release release;
+
+	Buffer& own_buffer(void){
+		if(not own){
+			std::lock_guard<std::mutex> lock(registry_mutex);
+			for(auto &b : registry){
+				if(not b->in_use){
+					b->in_use = true;
+					own = b.get();
+					break;
+				}
+			}
+			if(not own){
+				registry.emplace_back(new Buffer(capacity, registry.size() + 1));
+				own = registry.back().get();
+			}
+			release.buffer = own;
+		}
+		return *own;
+	}
+
+	void write_string(std::ostream &output, const std::string &s){
+		output << '"';
+		for(char c : s){
+			if(c == '"' or c == '\\') output << '\\';
+			if(static_cast<unsigned char>(c) >= 0x20) output << c;
+		}
+		output << '"';
+	}
+}
+
+void trace::detail::record(const Event &e) noexcept{
+	Buffer* b(own);
+	if(not b){
+		try{ b = &own_buffer(); }
+		catch(...){ return; } // out of memory: the event is lost
+	}
+	if(b->events.empty()) return; // started before this thread's buffer was sized, see start()
+
+	const uint64_t n(b->recorded.load(std::memory_order_relaxed));
+	b->events[n % b->events.size()] = e;
+	b->recorded.store(n + 1, std::memory_order_release);
+}
+
+void trace::start(size_t events_per_thread){
+	if(events_per_thread == 0) throw excptn::BAD_TRACE_CAPACITY;
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex);
+		capacity = events_per_thread;
+		for(auto &b : registry){
+			b->events.assign(capacity, Event());
+			b->recorded.store(0, std::memory_order_relaxed);
+		}
+	}
+	detail::epoch.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+	detail::enabled.store(true, std::memory_order_release);
+}
+
+void trace::stop(void) noexcept{
+	detail::enabled.store(false, std::memory_order_release);
+}
+
+void trace::name_thread(const std::string &name){
+	own_buffer().name = name;
+}
+
+size_t trace::event_count(void){
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	size_t n(0);
+	for(const auto &b : registry) n += b->size();
+	return n;
+}
+
+unsigned long trace::overwritten(void){
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	unsigned long n(0);
+	for(const auto &b : registry) n += b->recorded.load(std::memory_order_acquire) - b->size();
+	return n;
+}
+
+std::ostream& trace::write(std::ostream &output){
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"cern-junior\"}}";
+
+	const std::ios::fmtflags flags(output.flags());
+	const std::streamsize precision(output.precision());
+	output.setf(std::ios::fixed, std::ios::floatfield);
+	output.precision(3); // the timestamps are in µs
+	for(const auto &b : registry){
+		if(not b->name.empty()){
+			output << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid << ",\"args\":{\"name\":";
+			write_string(output, b->name);
+			output << "}}";
+		}
+
+		// from the oldest event held
+		const uint64_t recorded(b->recorded.load(std::memory_order_acquire));
+		const size_t n(b->size());
+		for(uint64_t k(recorded - n); k < recorded; ++k){
+			const Event &e(b->events[k % b->events.size()]);
+			output << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+			       << ",\"ts\":" << 1e-3*e.start << ",\"dur\":" << 1e-3*e.duration;
+			if(e.argument_name) output << ",\"args\":{\"" << e.argument_name << "\":" << e.argument << "}";
+			output << "}";
+		}
+	}
+	output.flags(flags);
+	output.precision(precision);
+
+	output << "\n]}\n";
+	return output;
+}
+
+void trace::write(const std::string &path){
+	std::ofstream file(path);
+	if(not file) throw excptn::TRACE_FILE_ERROR;
+	write(file);
+	if(not file) throw excptn::TRACE_FILE_ERROR;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+ * Timeline of a run in the Chrome trace format, which Perfetto (ui.perfetto.dev) and chrome://tracing open: scoped
+ * events (see Scope) around the phases of Accelerator::evolve and its force passes, the snapshot captures and
+ * writes, and the runs of an ensemble, on one track per thread.
+ *
+ * Tracing is off until start(), a scope then costing a relaxed atomic load. Each thread records into a buffer of
+ * its own without taking any lock (it only locks the registry of the buffers to get its own, when it records
+ * its first event). A buffer keeps the last events_per_thread events, the older ones being overwritten, and goes
+ * to the next thread to record once its thread has exited, so that memory stays bounded however long tracing
+ * stays on and however many threads come and go (e.g. the pools of successive ensembles).
+ *
+ * start() and write() touch the buffers of every thread, so they must be called while no traced thread is running,
+ * e.g. before and after a run. stop() can be called at any time.
+ */
+namespace trace{
+	const size_t DEFAULT_EVENTS_PER_THREAD = 1 << 16; // 3 MB per thread
+
+	struct Event{
+		const char* name; // string literals, of which only the addresses are kept
+		const char* category;
+		uint64_t start; // in ns since start()
+		uint64_t duration; // in ns
+		const char* argument_name; // none if nullptr
+		int64_t argument;
+	};
+
+	namespace detail{
+		extern std::atomic<bool> enabled;
+		extern std::atomic<int64_t> epoch; // of the steady clock, in ns
+
+		inline uint64_t now(void) noexcept{
+			const int64_t t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+			return t - epoch.load(std::memory_order_relaxed);
+		}
+
+		void record(const Event &e) noexcept; // into the calling thread's buffer
+	}
+
+	void start(size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD); // discards the events recorded so far
+	void stop(void) noexcept; // keeps the events recorded so far for write()
+	inline bool active(void) noexcept{ return detail::enabled.load(std::memory_order_relaxed); }
+
+	void name_thread(const std::string &name); // the name of the calling thread's track
+
+	size_t event_count(void); // held by the buffers
+	unsigned long overwritten(void); // lost to the bound on the buffers since start()
+
+	std::ostream& write(std::ostream &output); // as a Chrome trace, i.e. JSON
+	void write(const std::string &path); // throws if the file cannot be written
+
+	// records the time from its construction to its destruction, if tracing was active at its construction
+	class Scope{
+		private:
+			const char* name;
+			const char* category;
+			const char* argument_name;
+			int64_t argument;
+			bool recording;
+			uint64_t start;
+
+		public:
+			explicit Scope(const char* my_name, const char* my_category, const char* my_argument_name = nullptr, int64_t my_argument = 0) noexcept :
+				name(my_name), category(my_category), argument_name(my_argument_name), argument(my_argument),
+				recording(active()), start(recording ? detail::now() : 0){}
+
+			~Scope(void){
+				if(recording) detail::record({name, category, start, detail::now() - start, argument_name, argument});
+			}
+
+			Scope(const Scope &to_copy) = delete;
+			Scope& operator=(const Scope &to_copy) = delete;
+
+			void setArgument(int64_t my_argument) noexcept{ argument = my_argument; } // when only known at the end
+	};
+}
@@ -0,0 +1,258 @@
+#include <cmath>
+#include <iomanip>
+#include <algorithm> // for max
+
+#include "transfer_map.h"
+#include "accelerator.h"
+
+using namespace std;
+
+ReferenceParticle::ReferenceParticle(const Particle &p) :
+	charge(p.getCharge()),
+	gamma(p.getGamma()),
+	beta(p.getVelocity().norm()),
+	energy(p.getEnergy())
+{
+	if(beta <= 0.0 or charge == 0.0) throw excptn::BAD_REFERENCE_PARTICLE;
+	momentum = gamma*p.getMass()*beta*phcst::C_USI;
+}
+
+TransferMap::TransferMap(void){
+	m.fill(0.0);
+	for(int i(0); i < 6; ++i) (*this)(i,i) = 1.0;
+}
+
+TransferMap TransferMap::operator*(const TransferMap &M) const{
+	TransferMap product;
+	for(int i(0); i < 6; ++i){
+		for(int j(0); j < 6; ++j){
+			double sum(0.0);
+			for(int k(0); k < 6; ++k) sum += (*this)(i,k)*M(k,j);
+			product(i,j) = sum;
+		}
+	}
+	return product;
+}
+
+PhaseSpaceVector TransferMap::operator*(const PhaseSpaceVector &X) const{
+	PhaseSpaceVector Y;
+	for(int i(0); i < 6; ++i){
+		double sum(0.0);
+		for(int k(0); k < 6; ++k) sum += (*this)(i,k)*X[k];
+		Y[i] = sum;
+	}
+	return Y;
+}
+
+TransferMap TransferMap::drift(double length, double gamma){
+	TransferMap M;
+	M(0,1) = length;
+	M(2,3) = length;
+	M(4,5) = length/(gamma*gamma); // faster particles get ahead
+	return M;
+}
+
+TransferMap TransferMap::sector_bend(double length, double curvature, double gamma){
+	if(abs(curvature) <= simcst::ZERO_CURVATURE) return drift(length, gamma);
+
+	// horizontal weak focusing and dispersion of a sector dipole, the vertical plane is a drift
+	const double h(curvature);
+	const double theta(h*length);
+	const double C(cos(theta));
+	const double S(sin(theta));
+
+	TransferMap M(drift(length, gamma));
+	M(0,0) = C;
+	M(0,1) = S/h;
+	M(1,0) = -h*S;
+	M(1,1) = C;
+	M(0,5) = (1.0 - C)/h;
+	M(1,5) = S;
+	M(4,0) = -S;
+	M(4,1) = -(1.0 - C)/h;
+	M(4,5) = -(length - S/h) + length/(gamma*gamma); // longer path on the outside of the bend
+	return M;
+}
+
+namespace{
+	// 2x2 block of a thick lens x'' = -K x
+	void thick_lens(TransferMap &M, int i, double length, double K){
+		const double k(sqrt(abs(K)));
+		const double phi(k*length);
+		if(phi <= 1e-8){
+			M(i,i+1) = length;
+		}else if(K > 0.0){
+			M(i,i) = cos(phi);
+			M(i,i+1) = sin(phi)/k;
+			M(i+1,i) = -k*sin(phi);
+			M(i+1,i+1) = cos(phi);
+		}else{
+			M(i,i) = cosh(phi);
+			M(i,i+1) = sinh(phi)/k;
+			M(i+1,i) = k*sinh(phi);
+			M(i+1,i+1) = cosh(phi);
+		}
+	}
+}
+
+TransferMap TransferMap::quadrupole(double length, double K, double gamma){
+	TransferMap M(drift(length, gamma));
+	thick_lens(M, 0, length, K);
+	thick_lens(M, 2, length, -K);
+	return M;
+}
+
+TransferMap TransferMap::longitudinal_kick(double dDelta_dz){
+	TransferMap M;
+	M(5,4) = dDelta_dz;
+	return M;
+}
+
+std::ostream& TransferMap::print(std::ostream &output) const{
+	for(int i(0); i < 6; ++i){
+		for(int j(0); j < 6; ++j) output << setw(14) << (*this)(i,j);
+		output << "\n";
+	}
+	return output;
+}
+
+std::ostream& operator<<(std::ostream &output, const TransferMap &M){
+	return M.print(output);
+}
+
+// ELEMENT MAPS
+TransferMap Element::transfer_map(const ReferenceParticle &reference) const{
+	// field-free, or a sector dipole matched to the reference particle
+	return TransferMap::sector_bend(length, curvature, reference.gamma);
+}
+
+TransferMap Quadrupole::transfer_map(const ReferenceParticle &reference) const{
+	// F = q.v.b.(-x u + z Z) with u = Z ^ dir, i.e. x'' = -(b/B.rho) x and z'' = (b/B.rho) z
+	return TransferMap::quadrupole(length, b/reference.rigidity(), reference.gamma);
+}
+
+TransferMap FodoCell::transfer_map(const ReferenceParticle &reference) const{
+	TransferMap M;
+	double start(0.0);
+	for(size_t k(0); k < ends.size(); ++k){
+		M = TransferMap::quadrupole(ends[k] - start, gradients[k]/reference.rigidity(), reference.gamma) * M;
+		start = ends[k];
+	}
+	return M;
+}
+
+TransferMap RadiofrequencyCavity::transfer_map(const ReferenceParticle &reference) const{
+	// thin kick in the middle of the cavity, assuming the reference particle crosses it at phase phi.
+	// A particle ahead by z arrives z/(beta.c) earlier, and delta = dE/(beta^2.E)
+	const double dE_dz(-reference.charge*E_0*length*omega*cos(phi)/(reference.beta*phcst::C_USI));
+	const TransferMap half(TransferMap::drift(0.5*length, reference.gamma));
+
+	return half * TransferMap::longitudinal_kick(dE_dz/(reference.beta*reference.beta*reference.energy)) * half;
+}
+
+// LINEAR OPTICS
+LinearOptics::LinearOptics(const Accelerator &a, const ReferenceParticle &reference){
+	maps.reserve(a.element_count());
+	for(size_t i(0); i < a.element_count(); ++i){
+		maps.push_back(a.getElement(i).transfer_map(reference));
+		one_turn = maps.back() * one_turn;
+	}
+}
+
+bool LinearOptics::is_stable(int plane) const{
+	const int i(2*plane);
+	return abs(one_turn(i,i) + one_turn(i+1,i+1)) < 2.0;
+}
+
+Twiss LinearOptics::periodic_twiss(int plane) const{
+	if(not is_stable(plane)) throw excptn::UNSTABLE_OPTICS;
+
+	const int i(2*plane);
+	const double cos_mu(0.5*(one_turn(i,i) + one_turn(i+1,i+1)));
+	const double sin_mu((one_turn(i,i+1) >= 0.0 ? 1.0 : -1.0) * sqrt(1.0 - cos_mu*cos_mu));
+
+	return {one_turn(i,i+1)/sin_mu, 0.5*(one_turn(i,i) - one_turn(i+1,i+1))/sin_mu, 0.0};
+}
+
+std::vector<std::array<Twiss,2>> LinearOptics::twiss(void) const{
+	std::vector<std::array<Twiss,2>> result;
+	result.reserve(maps.size() + 1);
+	result.push_back({periodic_twiss(0), periodic_twiss(1)});
+
+	for(const auto &M : maps){
+		std::array<Twiss,2> next(result.back());
+		for(int plane(0); plane < 2; ++plane){
+			const int i(2*plane);
+			const Twiss &t(result.back()[plane]);
+			const double g((1.0 + t.alpha*t.alpha)/t.beta);
+			const double R11(M(i,i)), R12(M(i,i+1)), R21(M(i+1,i)), R22(M(i+1,i+1));
+
+			next[plane].beta = R11*R11*t.beta - 2.0*R11*R12*t.alpha + R12*R12*g;
+			next[plane].alpha = -R11*R21*t.beta + (R11*R22 + R12*R21)*t.alpha - R12*R22*g;
+
+			double dmu(atan2(R12, R11*t.beta - R12*t.alpha));
+			if(dmu < 0.0) dmu += 2.0*M_PI;
+			next[plane].mu = t.mu + dmu;
+		}
+		result.push_back(next);
+	}
+
+	return result;
+}
+
+std::array<double,2> LinearOptics::tunes(void) const{
+	const std::array<Twiss,2> end(twiss().back());
+	return {end[0].mu/(2.0*M_PI), end[1].mu/(2.0*M_PI)};
+}
+
+void LinearOptics::track(std::vector<PhaseSpaceVector> &X, unsigned long turns) const{
+	for(auto &x : X){
+		for(unsigned long n(0); n < turns; ++n) x = one_turn * x;
+	}
+}
+
+std::array<double,2> LinearOptics::rms_emittances(const std::vector<PhaseSpaceVector> &X){
+	std::array<double,2> emittances = {0.0, 0.0};
+	if(X.empty()) return emittances;
+
+	for(int plane(0); plane < 2; ++plane){
+		const int i(2*plane);
+		double mean[2] = {0.0, 0.0};
+		for(const auto &x : X){
+			mean[0] += x[i];
+			mean[1] += x[i+1];
+		}
+		mean[0] /= X.size();
+		mean[1] /= X.size();
+
+		double xx(0.0), pp(0.0), xp(0.0);
+		for(const auto &x : X){
+			xx += (x[i] - mean[0])*(x[i] - mean[0]);
+			pp += (x[i+1] - mean[1])*(x[i+1] - mean[1]);
+			xp += (x[i] - mean[0])*(x[i+1] - mean[1]);
+		}
+		xx /= X.size();
+		pp /= X.size();
+		xp /= X.size();
+		emittances[plane] = sqrt(max(0.0, xx*pp - xp*xp));
+	}
+
+	return emittances;
+}
+
+PhaseSpaceVector LinearOptics::phase_coordinates(const Particle &p, const ReferenceParticle &reference){
+	const Element* e(p.getElement());
+	if(not e) throw excptn::PARTICLE_OUTSIDE_LATTICE;
+
+	const double s(e->curvilinear_coord(p));
+	const Vector3D t(e->local_trajectory(s));
+	const Vector3D n(vctr::Z_VECTOR ^ t);
+	const Vector3D offset(p - e->inverse_curvilinear_coord(s));
+	const Vector3D v(p.getVelocity());
+	const double v_s(v|t);
+	if(v_s <= 0.0) throw excptn::PARTICLE_OUTSIDE_LATTICE;
+
+	// compared through the rigidity, since macro-particles have their mass and charge scaled alike
+	const double rigidity(p.getGamma()*p.getMass()*v.norm()*phcst::C_USI/p.getCharge());
+	return {offset|n, (v|n)/v_s, offset[2], v[2]/v_s, 0.0, rigidity/reference.rigidity() - 1.0};
+}
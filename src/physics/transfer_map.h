@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <iostream>
+
+class Particle;
+class Element;
+class Accelerator;
+
+/*
+ * Linear optics. Phase-space coordinates are taken relative to the reference particle on the ideal orbit:
+ *   (x, x', y, y', z, delta)
+ * where x is the horizontal offset towards the left of the ideal trajectory (i.e. along Z ^ t, outwards for
+ * elements of positive curvature), y the vertical offset, x' and y' the corresponding slopes, z the
+ * longitudinal offset (positive when ahead of the reference particle) and delta the relative momentum deviation.
+ */
+
+typedef std::array<double,6> PhaseSpaceVector;
+
+struct ReferenceParticle{
+	double momentum; // (in kg.m/s)
+	double charge; // (in C)
+	double gamma;
+	double beta;
+	double energy; // (in J)
+
+	explicit ReferenceParticle(const Particle &p);
+
+	double rigidity(void) const{ return momentum/charge; } // B.rho (in T.m)
+};
+
+class TransferMap{
+	// 6x6 matrix acting on phase-space vectors
+	private:
+		std::array<double,36> m;
+	public:
+		TransferMap(void); // identity
+
+		double operator()(int i, int j) const{ return m[6*i + j]; }
+		double& operator()(int i, int j){ return m[6*i + j]; }
+
+		TransferMap operator*(const TransferMap &M) const; // (A*B) is the map of B followed by A
+		PhaseSpaceVector operator*(const PhaseSpaceVector &X) const;
+
+		static TransferMap drift(double length, double gamma);
+		static TransferMap sector_bend(double length, double curvature, double gamma);
+		static TransferMap quadrupole(double length, double K, double gamma); // K > 0 focuses horizontally (in m^-2)
+		static TransferMap longitudinal_kick(double dDelta_dz);
+
+		std::ostream& print(std::ostream &output) const;
+};
+
+std::ostream& operator<<(std::ostream &output, const TransferMap &M);
+
+struct Twiss{
+	double beta; // (in m)
+	double alpha;
+	double mu; // phase advance from the start of the lattice (in rad)
+};
+
+class LinearOptics{
+	// One-turn map of an accelerator for a given reference particle, and the periodic optics derived from it.
+	// This assumes that the dipoles are matched to the reference particle (B_0 = B.rho * curvature).
+	private:
+		std::vector<TransferMap> maps; // one per element
+		TransferMap one_turn;
+
+	public:
+		LinearOptics(const Accelerator &a, const ReferenceParticle &reference);
+
+		const TransferMap& getOne_turn_map(void) const{ return one_turn; }
+		const TransferMap& getElement_map(size_t i) const{ return maps.at(i); }
+
+		bool is_stable(int plane) const; // plane 0 is horizontal, 1 is vertical
+		Twiss periodic_twiss(int plane) const; // at the start of the lattice, with mu = 0
+
+		std::vector<std::array<Twiss,2>> twiss(void) const; // at the entry of each element and at the end of the turn
+		std::array<double,2> tunes(void) const; // number of betatron oscillations per turn, integer part included
+
+		void track(std::vector<PhaseSpaceVector> &X, unsigned long turns) const; // turn-by-turn tracking with the one-turn map
+
+		static std::array<double,2> rms_emittances(const std::vector<PhaseSpaceVector> &X); // horizontal and vertical (in m.rad)
+
+		// coordinates of a particle relative to the ideal orbit at its current position (z is taken as 0)
+		static PhaseSpaceVector phase_coordinates(const Particle &p, const ReferenceParticle &reference);
+};
@@ -0,0 +1,203 @@
+#include <cmath>
+#include <algorithm> // for min and max
+
+#include "element.h"
+
+using namespace std;
+using namespace phcst;
+
+// ELEMENT-WISE TRACKING
+// Every element carries a particle from wherever it is to its exit plane (the plane orthogonal to the
+// ideal orbit at the exit point) in O(1) work. The lattice is assumed to lie in a horizontal plane.
+
+bool Element::is_lost(const Particle &p, const Vector3D &middle) const{
+	return has_collided(middle) or has_collided(p);
+}
+
+namespace{
+	// time needed by p to reach the plane through x orthogonal to n in a straight line, negative if it never does
+	double time_to_plane(const Particle &p, const Vector3D &x, const Vector3D &n){
+		const double v_n(p.getVelocity()|n);
+		if(v_n <= 0.0) return -1.0;
+		return max(0.0, ((x - p)|n)/(v_n*C_USI));
+	}
+
+	void drift(Particle &p, double t){
+		p.setPosition(p + (t*C_USI)*p.getVelocity());
+		p.setTime(p.getTime() + t);
+	}
+}
+
+bool Element::straight_line(Particle &p) const{
+	const double t(time_to_plane(p, exit_point, local_trajectory(length)));
+	if(t < 0.0) return false; // never reaches the exit
+
+	const Vector3D middle(p + (0.5*t*C_USI)*p.getVelocity());
+	drift(p, t);
+
+	return not is_lost(p, middle);
+}
+
+bool Dipole::transport(Particle &p) const{
+	// dv/dt = Omega.(v ^ Z): the horizontal velocity rotates at constant speed, the vertical one is constant
+	const double Omega(p.getCharge()*B_0/(p.getGamma()*p.getMass()));
+	const Vector3D v(p.getVelocity());
+	const Vector3D v_h(v - v[2]*vctr::Z_VECTOR);
+	const Vector3D v_r(v_h ^ vctr::Z_VECTOR);
+
+	const Vector3D start(p);
+	const auto position([&](double t){
+		const double theta(Omega*t);
+		return start + (C_USI/Omega)*(sin(theta)*v_h + (1.0 - cos(theta))*v_r) + (C_USI*v[2]*t)*vctr::Z_VECTOR;
+	});
+
+	// crossing of the exit plane: a + (c/Omega).(P.sin(theta) + Q.(1 - cos(theta))) = 0 with theta = Omega.t
+	const Vector3D n(local_trajectory(length));
+	const double a((p - exit_point)|n);
+	const double P(v_h|n);
+	const double Q(v_r|n);
+	const double R(sqrt(P*P + Q*Q));
+	if(R <= 0.0) return false;
+
+	if(abs(a*Omega/(C_USI*R)) < 1e-12) return straight_line(p); // no field to speak of
+
+	const double K((-a*Omega/C_USI - Q)/R); // = sin(theta - phi), with cos(phi) = P/R and sin(phi) = Q/R
+	if(abs(K) > 1.0) return false; // the particle loops without reaching the exit
+
+	const double phi(atan2(Q, P));
+	const double period(2.0*M_PI/abs(Omega));
+	double t(period);
+	for(double theta : {phi + asin(K), phi + M_PI - asin(K)}){
+		double candidate(fmod(theta/Omega, period));
+		if(candidate < 0.0) candidate += period;
+		t = min(t, candidate);
+	}
+
+	const double theta(Omega*t);
+	p.setPosition(position(t));
+	p.setVelocity(cos(theta)*v_h + sin(theta)*v_r + v[2]*vctr::Z_VECTOR);
+	p.setTime(p.getTime() + t);
+
+	return not is_lost(p, position(0.5*t));
+}
+
+bool Element::thick_lenses(Particle &p, const double* ends, const double* gradients, size_t n) const{
+	// linear motion around the axis, x'' = -K.x and y'' = K.y, over the rest of each lens
+	const Vector3D u(vctr::Z_VECTOR ^ dir);
+	const Vector3D v(p.getVelocity());
+	const double v_s(v|dir);
+	if(v_s <= 0.0) return false;
+
+	const Vector3D r(relative_coords(p));
+	const double momentum(p.getGamma()*p.getMass()*v.norm()*C_USI);
+
+	double s(r|dir);
+	double path(0.0);
+	PhaseSpaceVector X = {r|u, (v|u)/v_s, r[2], v[2]/v_s, 0.0, 0.0};
+	for(size_t k(0); k < n; ++k){
+		if(ends[k] <= s) continue;
+
+		const double l(ends[k] - s);
+		const double K(p.getCharge()*gradients[k]/momentum);
+		const PhaseSpaceVector X_end(TransferMap::quadrupole(l, K, 1.0) * X);
+		const PhaseSpaceVector X_half(TransferMap::quadrupole(0.5*l, K, 1.0) * X);
+
+		// path length from the mean squared slope
+		const double slope2(0.5*(X[1]*X[1] + X[3]*X[3] + X_end[1]*X_end[1] + X_end[3]*X_end[3]));
+		path += l*(1.0 + 0.5*slope2);
+
+		if(has_collided(entry_point + (s + 0.5*l)*dir + X_half[0]*u + X_half[2]*vctr::Z_VECTOR)) return false;
+		X = X_end;
+		s = ends[k];
+	}
+
+	p.setPosition(exit_point + X[0]*u + X[2]*vctr::Z_VECTOR);
+	p.setVelocity(v.norm()*(dir + X[1]*u + X[3]*vctr::Z_VECTOR).unitary());
+	p.setTime(p.getTime() + path/(v.norm()*C_USI));
+
+	return not has_collided(p);
+}
+
+bool Quadrupole::transport(Particle &p) const{
+	return thick_lenses(p, &length, &b, 1);
+}
+
+bool FodoCell::transport(Particle &p) const{
+	return thick_lenses(p, ends.data(), gradients.data(), ends.size());
+}
+
+bool RadiofrequencyCavity::transport(Particle &p) const{
+	// energy kick integrated along the straight path at the entry velocity, applied half way
+	const Vector3D v(p.getVelocity());
+	const double v_s(v|dir);
+	if(v_s <= 0.0) return false;
+
+	const double s_0(relative_coords(p)|dir);
+	const double remaining(length - s_0);
+
+	// phase omega.t - kappa.s + phi = A + k.s along the path
+	const double k(omega/(v_s*C_USI) - kappa);
+	const double A(omega*p.getTime() - omega*s_0/(v_s*C_USI) + phi);
+	const double integral(abs(k*remaining) < 1e-9 ?
+		remaining*sin(A + k*(s_0 + 0.5*remaining)) :
+		(cos(A + k*s_0) - cos(A + k*length))/k
+	);
+	const double kick(p.getCharge()*E_0*integral/(v_s*C_USI)); // momentum gained along dir (in kg.m/s)
+
+	drift(p, 0.5*remaining/(v_s*C_USI));
+	const Vector3D middle(p);
+	p.add_momentum(kick*dir);
+
+	return straight_line(p) and not has_collided(middle);
+}
+
+// S-BASED TRACKING
+
+void MagneticElement::kick(Particle &p, double dt) const{
+	p.gyrate(B(p, p.getTime()), dt);
+}
+
+void ElectricElement::kick(Particle &p, double dt) const{
+	p.add_momentum((p.getCharge()*dt)*E(p, p.getTime()));
+}
+
+bool Element::integrate(Particle &p, unsigned int steps) const{
+	const double s_0(min(max(0.0, curvilinear_coord(p)), length));
+
+	double start(0.0);
+	for(size_t k(0); k < segment_count(); ++k){
+		const double end(segment_end(k));
+		if(end > s_0 and not integrate(p, max(start, s_0), end, steps)) return false;
+		start = end;
+	}
+
+	return true;
+}
+
+bool Element::integrate(Particle &p, double s_from, double s_to, unsigned int steps) const{
+	// each step drifts onto the plane half way to the next one, applies the field for twice that time,
+	// then drifts exactly onto the next plane with the new velocity.
+	// In a curved element the straight path between two planes is longer than the arc, which is corrected
+	// for by the ratio of the two along the ideal orbit
+	const double ds((s_to - s_from)/steps);
+	const double half_angle(0.5*curvature*ds);
+	const double arc_over_chord(abs(half_angle) > 1e-8 ? half_angle/tan(half_angle) : 1.0);
+
+	for(unsigned int k(1); k <= steps; ++k){
+		const double s(k == steps ? s_to : s_from + k*ds);
+		const double s_half(s - 0.5*ds);
+
+		const double t(time_to_plane(p, inverse_curvilinear_coord(s_half), local_trajectory(s_half)));
+		if(t < 0.0) return false;
+		drift(p, t);
+		kick(p, 2.0*t*arc_over_chord);
+
+		const double t_rest(time_to_plane(p, inverse_curvilinear_coord(s), local_trajectory(s)));
+		if(t_rest < 0.0) return false;
+		drift(p, t_rest);
+
+		if(has_collided(p)) return false;
+	}
+
+	return true;
+}
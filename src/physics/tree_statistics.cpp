@@ -0,0 +1,44 @@
+#include "tree_statistics.h"
+
+#include <algorithm> // for max
+
+void TreeStatistics::add_node(size_t depth){
+	if(depths.size() <= depth) depths.resize(depth + 1, 0);
+	++depths[depth];
+}
+
+void TreeStatistics::add_imbalance(double node_charge, double fullest_child_charge){
+	if(node_charge <= 0.0) return;
+	imbalance_sum += fullest_child_charge; // i.e. the ratio weighted by node_charge
+	imbalance_weight += node_charge;
+}
+
+void TreeStatistics::merge(const TreeStatistics &other){
+	trees += other.trees;
+	degenerate += other.degenerate;
+	if(depths.size() < other.depths.size()) depths.resize(other.depths.size(), 0);
+	for(size_t d(0); d < other.depths.size(); ++d) depths[d] += other.depths[d];
+	internal += other.internal;
+	leaves += other.leaves;
+	empty += other.empty;
+	bytes += other.bytes;
+	imbalance_sum += other.imbalance_sum;
+	imbalance_weight += other.imbalance_weight;
+}
+
+std::ostream& TreeStatistics::print(std::ostream& output) const{
+	output << "TREES:\n\n";
+	output << "   " << trees << " trees (" << degenerate << " of zero volume), " << nodes() << " nodes in " << bytes << " bytes\n";
+	output << "   internal " << internal << ", leaves " << leaves << ", empty " << empty << " (occupancy " << occupancy() << ")\n";
+	output << "   nodes by depth:";
+	for(size_t n : depths) output << " " << n;
+	output << "\n";
+	output << "   charge imbalance: " << imbalance() << "\n";
+	if(particles){
+		output << "   particles: " << particles << " (" << particles - std::min(particles, leaves) << " outside the trees)\n";
+		output << "   opened nodes per particle: " << opened_per_particle << "\n";
+		output << "   interactions per particle: " << interactions_per_particle << "\n";
+	}
+	output << "\n";
+	return output;
+}
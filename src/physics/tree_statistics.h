@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+/*
+ * Shape of one or several Barnes-Hut trees (see Node::statistics and Accelerator::tree_statistics), to tune the
+ * domains of the elements and detect pathological trees: a tree much deeper than log8 of its particles, particles
+ * missing from the trees because they lie outside the domain of their element, or a domain of zero volume (every
+ * cell of which is then opened). Gathering them visits each node once, i.e. costs a fraction of a step.
+ */
+struct TreeStatistics{
+	size_t trees = 0;
+	size_t degenerate = 0; // trees whose domain has no volume
+	std::vector<size_t> depths; // number of nodes at each depth, the roots being at depth 0
+	size_t internal = 0; // nodes by type (see Node)
+	size_t leaves = 0; // holding a particle each
+	size_t empty = 0;
+	size_t bytes = 0; // taken by the nodes
+
+	// of the internal nodes, weighted by their charge (see imbalance())
+	double imbalance_sum = 0.0;
+	double imbalance_weight = 0.0;
+
+	// over the particles pushed in the last step (Accelerator::tree_statistics only, and if EvolveProfile::ENABLED)
+	size_t particles = 0; // of the accelerator, of which those that are not leaves of the trees get no space charge
+	double opened_per_particle = 0.0; // internal nodes descended into
+	double interactions_per_particle = 0.0;
+
+	size_t nodes(void) const{ return internal + leaves + empty; }
+	size_t max_depth(void) const{ return depths.empty() ? 0 : depths.size() - 1; }
+	double occupancy(void) const{ return leaves + empty ? double(leaves)/(leaves + empty) : 0.0; } // of the childless nodes
+
+	// the charge of the fullest child of an internal node over that of the node (1/8 if the charge is evenly spread,
+	// 1 if it all falls in a single child), averaged over the internal nodes with their charge as weight
+	double imbalance(void) const{ return imbalance_weight > 0.0 ? imbalance_sum/imbalance_weight : 0.0; }
+
+	void add_node(size_t depth); // counts a node at that depth, whatever its type
+	void add_imbalance(double node_charge, double fullest_child_charge);
+	void merge(const TreeStatistics &other); // of other trees
+
+	std::ostream& print(std::ostream& output) const;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+#include "snapshotview.h"
+#include "../physics/accelerator.h"
+
+class AcceleratorWidgetSnapshot : public Accelerator{
+	// accelerator whose draw() records a binary snapshot rather than printing
+	public:
+		AcceleratorWidgetSnapshot(Vector3D origin, const std::string &path, uint32_t flags = 0, unsigned int step_decimation = 1, unsigned int particle_decimation = 1, const snapshot::Compression &compression = snapshot::Compression(), snapshot::Overflow overflow = snapshot::Overflow::DROP) :
+			Accelerator(new SnapshotView(path, flags, step_decimation, particle_decimation, compression, overflow), origin)
+		{}
+		virtual ~AcceleratorWidgetSnapshot(void){ delete canvas; } // closes the file
+
+		SnapshotView& getView(void){ return *static_cast<SnapshotView*>(canvas); }
+};
@@ -0,0 +1,396 @@
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include "codec.h"
+#include "snapshot.h"
+
+#include "../physics/accelerator.h"
+#include "../misc/exceptions.h"
+
+using namespace snapshot;
+
+ElementFrame::ElementFrame(const Element &e) :
+	straight(e.is_straight()),
+	curvature(std::abs(e.getCurvature())),
+	entry(e.getEntry_point()),
+	center(e.is_straight() ? vctr::ZERO_VECTOR : e.center()),
+	u(e.getBasis_vector_u()),
+	v(e.getBasis_vector_v()),
+	w(e.getBasis_vector_w())
+{}
+
+double ElementFrame::curvilinear_coord(const Vector3D &x) const{
+	if(straight) return (x - entry)|u;
+
+	const Vector3D X(x - center);
+	return atan2(X|v, X|u) / curvature;
+}
+
+Vector3D ElementFrame::position(double s) const{
+	if(straight) return entry + s*u;
+
+	const double beta(s*curvature);
+	return center + (1.0/curvature)*(cos(beta)*u + sin(beta)*v);
+}
+
+std::vector<ElementFrame> lattice_frames(const Accelerator &a){
+	std::vector<ElementFrame> frames;
+	frames.reserve(a.element_count());
+	for(size_t i(0); i < a.element_count(); ++i){
+		frames.push_back(ElementFrame(a.getElement(i)));
+	}
+	return frames;
+}
+
+namespace{
+	// Adaptive binary range coder (the one of LZMA): 11-bit probabilities, 32-bit range.
+	constexpr int PROBABILITY_BITS(11);
+	constexpr uint16_t HALF_PROBABILITY(1 << (PROBABILITY_BITS - 1));
+	constexpr int ADAPTATION_SHIFT(5);
+	constexpr uint32_t TOP(1u << 24);
+
+	class RangeEncoder{
+		private:
+			std::vector<char> &out;
+			uint64_t low = 0;
+			uint32_t range = 0xFFFFFFFF;
+			uint8_t cache = 0;
+			uint64_t cache_size = 1;
+
+			void shift_low(void){
+				if(static_cast<uint32_t>(low) < 0xFF000000u or (low >> 32) != 0){
+					const uint8_t carry(low >> 32);
+					uint8_t temp(cache);
+					do{
+						out.push_back(static_cast<char>(temp + carry));
+						temp = 0xFF;
+					}while(--cache_size != 0);
+					cache = static_cast<uint8_t>(low >> 24);
+				}
+				++cache_size;
+				low = (low & 0x00FFFFFF) << 8;
+			}
+
+			void normalize(void){
+				while(range < TOP){
+					range <<= 8;
+					shift_low();
+				}
+			}
+		public:
+			explicit RangeEncoder(std::vector<char> &my_out) : out(my_out){}
+
+			void bit(uint16_t &p, bool b){
+				const uint32_t bound((range >> PROBABILITY_BITS) * p);
+				if(not b){
+					range = bound;
+					p += ((1 << PROBABILITY_BITS) - p) >> ADAPTATION_SHIFT;
+				}else{
+					low += bound;
+					range -= bound;
+					p -= p >> ADAPTATION_SHIFT;
+				}
+				normalize();
+			}
+
+			void direct_bit(bool b){
+				range >>= 1;
+				if(b) low += range;
+				normalize();
+			}
+
+			void flush(void){ for(int i(0); i < 5; ++i) shift_low(); }
+	};
+
+	class RangeDecoder{
+		private:
+			const char* data;
+			const char* end;
+			uint32_t range = 0xFFFFFFFF;
+			uint32_t code = 0;
+
+			uint8_t next(void){ return data < end ? static_cast<uint8_t>(*data++) : 0; }
+
+			void normalize(void){
+				while(range < TOP){
+					range <<= 8;
+					code = (code << 8) | next();
+				}
+			}
+		public:
+			RangeDecoder(const char* my_data, const char* my_end) : data(my_data), end(my_end){
+				for(int i(0); i < 5; ++i) code = (code << 8) | next();
+			}
+
+			bool bit(uint16_t &p){
+				const uint32_t bound((range >> PROBABILITY_BITS) * p);
+				bool b;
+				if(code < bound){
+					range = bound;
+					p += ((1 << PROBABILITY_BITS) - p) >> ADAPTATION_SHIFT;
+					b = false;
+				}else{
+					code -= bound;
+					range -= bound;
+					p -= p >> ADAPTATION_SHIFT;
+					b = true;
+				}
+				normalize();
+				return b;
+			}
+
+			bool direct_bit(void){
+				range >>= 1;
+				bool b(code >= range);
+				if(b) code -= range;
+				normalize();
+				return b;
+			}
+	};
+
+	struct IntegerModel{
+		// an integer is coded as its bit length (through an adaptive binary tree) followed by its lower bits,
+		// of which only the most significant one is modelled
+		static constexpr int LENGTH_BITS = 7;
+		uint16_t length[1 << LENGTH_BITS];
+		uint16_t top[1 << LENGTH_BITS];
+
+		IntegerModel(void){
+			std::fill(std::begin(length), std::end(length), HALF_PROBABILITY);
+			std::fill(std::begin(top), std::end(top), HALF_PROBABILITY);
+		}
+
+		void encode(RangeEncoder &rc, uint64_t n){
+			int bits(0);
+			while(bits < 64 and (n >> bits) != 0) ++bits;
+
+			int node(1);
+			for(int i(LENGTH_BITS - 1); i >= 0; --i){
+				const bool b((bits >> i) & 1);
+				rc.bit(length[node], b);
+				node = 2*node + b;
+			}
+			if(bits >= 2) rc.bit(top[bits], (n >> (bits - 2)) & 1);
+			for(int i(bits - 3); i >= 0; --i) rc.direct_bit((n >> i) & 1);
+		}
+
+		uint64_t decode(RangeDecoder &rc){
+			int node(1);
+			for(int i(0); i < LENGTH_BITS; ++i) node = 2*node + rc.bit(length[node]);
+			const int bits(node - (1 << LENGTH_BITS));
+
+			if(bits == 0) return 0;
+			uint64_t n(1);
+			if(bits >= 2) n = (n << 1) | rc.bit(top[bits]);
+			for(int i(bits - 3); i >= 0; --i) n = (n << 1) | rc.direct_bit();
+			return n;
+		}
+	};
+
+	uint64_t zigzag(int64_t n){ return (static_cast<uint64_t>(n) << 1) ^ static_cast<uint64_t>(n >> 63); }
+	int64_t unzigzag(uint64_t n){ return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1); }
+
+	struct Models{
+		IntegerModel id_gap;
+		IntegerModel element;
+		uint16_t same_element = HALF_PROBABILITY;
+		IntegerModel field[7];
+	};
+
+	// quantisation steps such that the three components' errors add up to at most the requested bound
+	// (the small margin absorbs rounding errors in the change of frame)
+	double step(double bound){ return 0.999 * 2.0*bound/sqrt(3.0); }
+
+	template <typename T>
+	void put(std::vector<char> &out, const T &value){
+		const char* p(reinterpret_cast<const char*>(&value));
+		out.insert(out.end(), p, p + sizeof(T));
+	}
+
+	template <typename T>
+	T get(const std::vector<char> &in, size_t &position){
+		if(position + sizeof(T) > in.size()) throw excptn::SNAPSHOT_BAD_FORMAT;
+		T value;
+		std::memcpy(&value, in.data() + position, sizeof(T));
+		position += sizeof(T);
+		return value;
+	}
+
+	void put(std::vector<char> &out, const Vector3D &x){ for(int i(0); i < 3; ++i) put<double>(out, x[i]); }
+	Vector3D get_vector(const std::vector<char> &in, size_t &position){
+		const double x(get<double>(in, position));
+		const double y(get<double>(in, position));
+		const double z(get<double>(in, position));
+		return Vector3D(x, y, z);
+	}
+
+	const ElementFrame& frame_of(const std::vector<ElementFrame> &frames, uint32_t element){
+		// particles outside of any element are written in global coordinates
+		static const ElementFrame global;
+		return element < frames.size() ? frames[element] : global;
+	}
+
+	void predict(const History &h, uint32_t element, int64_t prediction[7]){
+		const bool usable(h.present and h.element == element);
+		for(int k(0); k < 7; ++k){
+			prediction[k] = usable ? h.q[k] + (h.has_slope ? h.slope[k] : 0) : 0;
+		}
+	}
+
+	void remember(History &h, uint32_t element, const int64_t q[7]){
+		h.has_slope = h.present and h.element == element;
+		for(int k(0); k < 7; ++k){
+			h.slope[k] = h.has_slope ? q[k] - h.q[k] : 0;
+			h.q[k] = q[k];
+		}
+		h.present = true;
+		h.element = element;
+	}
+}
+
+std::vector<char> SnapshotEncoder::encode(const Snapshot &s, const std::vector<ElementFrame> &frames){
+	const bool keyframe(chunks++ % settings.keyframe_interval == 0);
+	const double dx(step(settings.position_error));
+	const double dv(step(settings.velocity_error));
+
+	std::vector<char> out;
+	out.push_back(keyframe);
+	put<double>(out, dx);
+	put<double>(out, dv);
+
+	if(keyframe){
+		history.assign(history.size(), History());
+		put<uint32_t>(out, frames.size());
+		for(const auto &f : frames){
+			out.push_back(f.straight);
+			put<double>(out, f.curvature);
+			put(out, f.entry);
+			put(out, f.center);
+			put(out, f.u);
+			put(out, f.v);
+			put(out, f.w);
+		}
+	}
+
+	// particles are coded by increasing identifier, so that identifiers are cheap to code
+	std::vector<size_t> order(s.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&s](size_t i, size_t j){ return s.id[i] < s.id[j]; });
+
+	Models models;
+	RangeEncoder rc(out);
+	int64_t previous_id(-1);
+
+	for(size_t i : order){
+		const uint32_t id(s.id[i]);
+		const uint32_t element(s.element[i]);
+		if(id >= history.size()) history.resize(id + 1);
+		History &h(history[id]);
+
+		models.id_gap.encode(rc, id - previous_id - 1);
+		previous_id = id;
+
+		const bool same(h.present and h.element == element);
+		if(h.present) rc.bit(models.same_element, same);
+		if(not same) models.element.encode(rc, element == UINT32_MAX ? 0 : uint64_t(element) + 1);
+
+		const ElementFrame &f(frame_of(frames, element));
+		const Vector3D x(s.real[X - X][i], s.real[Y - X][i], s.real[Z - X][i]);
+		const Vector3D v(s.real[VX - X][i], s.real[VY - X][i], s.real[VZ - X][i]);
+		const double gamma(s.real[GAMMA - X][i]);
+		const Vector3D momentum(std::isfinite(gamma) ? gamma*v : v); // gamma.v (in m.c), from which gamma is recovered
+
+		double curvilinear(element < frames.size() ? f.curvilinear_coord(x) : 0.0);
+		if(not std::isfinite(curvilinear)) curvilinear = 0.0;
+
+		int64_t q[7];
+		q[0] = llround(curvilinear / dx);
+		const Vector3D r(x - f.position(q[0]*dx));
+		q[1] = llround((r|f.u) / dx);
+		q[2] = llround((r|f.v) / dx);
+		q[3] = llround((r|f.w) / dx);
+		q[4] = llround((momentum|f.u) / dv);
+		q[5] = llround((momentum|f.v) / dv);
+		q[6] = llround((momentum|f.w) / dv);
+
+		int64_t prediction[7];
+		predict(h, element, prediction);
+		for(int k(0); k < 7; ++k) models.field[k].encode(rc, zigzag(q[k] - prediction[k]));
+
+		remember(h, element, q);
+	}
+	rc.flush();
+
+	return out;
+}
+
+void SnapshotDecoder::decode(const std::vector<char> &payload, Snapshot &s){
+	if(payload.empty()) throw excptn::SNAPSHOT_BAD_FORMAT;
+
+	size_t position(0);
+	const bool keyframe(payload[position++] != 0);
+	const double dx(get<double>(payload, position));
+	const double dv(get<double>(payload, position));
+
+	if(keyframe){
+		history.assign(history.size(), History());
+		frames.resize(get<uint32_t>(payload, position));
+		for(auto &f : frames){
+			f.straight = payload.at(position++) != 0;
+			f.curvature = get<double>(payload, position);
+			f.entry = get_vector(payload, position);
+			f.center = get_vector(payload, position);
+			f.u = get_vector(payload, position);
+			f.v = get_vector(payload, position);
+			f.w = get_vector(payload, position);
+		}
+		synchronized = true;
+	}
+	if(not synchronized) throw excptn::SNAPSHOT_BAD_FORMAT; // decoding must start at a keyframe
+
+	const size_t count(s.id.size());
+	s.element.resize(count);
+	for(auto &column : s.real) column.resize(count);
+
+	Models models;
+	RangeDecoder rc(payload.data() + position, payload.data() + payload.size());
+	int64_t previous_id(-1);
+
+	for(size_t i(0); i < count; ++i){
+		const uint32_t id(previous_id + 1 + models.id_gap.decode(rc));
+		previous_id = id;
+		if(id >= history.size()) history.resize(id + 1);
+		History &h(history[id]);
+
+		uint32_t element(h.element);
+		if(not h.present or not rc.bit(models.same_element)){
+			const uint64_t code(models.element.decode(rc));
+			element = code == 0 ? UINT32_MAX : code - 1;
+		}
+
+		int64_t prediction[7];
+		predict(h, element, prediction);
+
+		int64_t q[7];
+		for(int k(0); k < 7; ++k) q[k] = prediction[k] + unzigzag(models.field[k].decode(rc));
+		remember(h, element, q);
+
+		const ElementFrame &f(frame_of(frames, element));
+		const Vector3D x(f.position(q[0]*dx) + (q[1]*dx)*f.u + (q[2]*dx)*f.v + (q[3]*dx)*f.w);
+		const Vector3D momentum((q[4]*dv)*f.u + (q[5]*dv)*f.v + (q[6]*dv)*f.w);
+		const double gamma(sqrt(1.0 + momentum.norm2()));
+		const Vector3D v((1.0/gamma)*momentum);
+
+		s.id[i] = id;
+		s.element[i] = element;
+		s.real[X - X][i] = x[0];
+		s.real[Y - X][i] = x[1];
+		s.real[Z - X][i] = x[2];
+		s.real[VX - X][i] = v[0];
+		s.real[VY - X][i] = v[1];
+		s.real[VZ - X][i] = v[2];
+		s.real[GAMMA - X][i] = gamma;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "../vector3d/vector3d.h"
+
+class Element;
+class Accelerator;
+struct Snapshot;
+
+/*
+ * Lossy compression of snapshots.
+ *
+ * Each position is written in the frame of its element: a curvilinear coordinate s along the ideal orbit
+ * plus a residual with respect to the ideal orbit at s, expressed in the element's orthonormal basis (u,v,w).
+ * The velocity is written as the momentum gamma.v, from which both v = gamma.v/sqrt(1 + (gamma.v)^2) and gamma
+ * are recovered: neither moves further than the momentum does, so that gamma stays accurate (and finite) at
+ * high energy. Residuals and momenta are quantised so that the reconstructed vectors are within the requested
+ * (euclidian) error bound, predicted from the previous snapshots of the same particle, and the prediction
+ * errors are coded with an adaptive binary range coder.
+ * Every keyframe_interval chunks, a keyframe without prediction is written, so that any chunk can be
+ * decoded by starting from the keyframe that precedes it. Keyframes also carry the element frames,
+ * hence a file can be decoded without the lattice that produced it.
+ */
+
+struct ElementFrame{
+	// geometry of an element needed to go back and forth between its frame and global coordinates
+	bool straight;
+	double curvature; // absolute value of the element's curvature
+	Vector3D entry;
+	Vector3D center; // only meaningful for curved elements
+	Vector3D u;
+	Vector3D v;
+	Vector3D w;
+
+	ElementFrame(void) : straight(true), curvature(0.0), u(vctr::X_VECTOR), v(vctr::Y_VECTOR), w(vctr::Z_VECTOR){} // global frame
+	explicit ElementFrame(const Element &e);
+
+	double curvilinear_coord(const Vector3D &x) const; // same as Element::curvilinear_coord
+	Vector3D position(double s) const; // same as Element::inverse_curvilinear_coord
+};
+
+std::vector<ElementFrame> lattice_frames(const Accelerator &a);
+
+namespace snapshot{
+	struct Compression{
+		double position_error; // maximal distance between a position and its reconstruction (in m)
+		double velocity_error; // maximal distance between a velocity and its reconstruction (in c), and between the gammas
+		unsigned int keyframe_interval;
+
+		Compression(double my_position_error = 1e-6, double my_velocity_error = 1e-8, unsigned int my_keyframe_interval = 64) :
+			position_error(my_position_error),
+			velocity_error(my_velocity_error),
+			keyframe_interval(my_keyframe_interval ? my_keyframe_interval : 1)
+		{}
+	};
+
+	struct History{
+		// quantised coordinates of a particle in the previous snapshots, used for prediction
+		bool present = false;
+		bool has_slope = false;
+		uint32_t element = 0;
+		int64_t q[7]; // s, position residual (3) and momentum gamma.v (3)
+		int64_t slope[7]; // difference between the last two snapshots
+	};
+}
+
+class SnapshotEncoder{
+	private:
+		const snapshot::Compression settings;
+		std::vector<snapshot::History> history; // indexed by particle identifier
+		unsigned long chunks = 0;
+	public:
+		explicit SnapshotEncoder(const snapshot::Compression &my_settings) : settings(my_settings){}
+
+		// frames are those of the lattice the snapshot was captured in
+		std::vector<char> encode(const Snapshot &s, const std::vector<ElementFrame> &frames);
+};
+
+class SnapshotDecoder{
+	private:
+		std::vector<ElementFrame> frames; // taken from the last keyframe
+		std::vector<snapshot::History> history;
+		bool synchronized = false;
+	public:
+		static bool is_keyframe(const char* payload){ return payload[0] != 0; }
+
+		// the snapshot s must already hold its step, time and particle count
+		void decode(const std::vector<char> &payload, Snapshot &s);
+};
@@ -0,0 +1,299 @@
+#include <cstring>
+
+#include "snapshot.h"
+
+#include "../physics/particle.h"
+#include "../physics/trace.h"
+#include "../misc/exceptions.h"
+
+using namespace snapshot;
+
+namespace{
+	const char FILE_MAGIC[8] = {'C','J','S','N','A','P','\0','\0'};
+	const char CHUNK_MAGIC[4] = {'C','H','N','K'};
+	const char INDEX_MAGIC[4] = {'C','I','D','X'};
+	const char END_MAGIC[8] = {'C','J','E','N','D','\0','\0','\0'};
+
+	template <typename T>
+	void put(std::ostream &out, const T &value){
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	T get(std::istream &in){
+		T value;
+		in.read(reinterpret_cast<char*>(&value), sizeof(T));
+		if(not in) throw excptn::SNAPSHOT_BAD_FORMAT;
+		return value;
+	}
+
+	void expect(std::istream &in, const char* magic, size_t n){
+		char buffer[8];
+		in.read(buffer, n);
+		if(not in or std::memcmp(buffer, magic, n) != 0) throw excptn::SNAPSHOT_BAD_FORMAT;
+	}
+}
+
+void Snapshot::clear(void){
+	id.clear();
+	element.clear();
+	for(auto &column : real) column.clear();
+}
+
+void Snapshot::reserve(size_t n){
+	id.reserve(n);
+	element.reserve(n);
+	for(auto &column : real) column.reserve(n);
+}
+
+void Snapshot::push_back(const Particle &p, uint32_t element_index){
+	const Vector3D v(p.getVelocity());
+
+	id.push_back(p.getId());
+	element.push_back(element_index);
+	real[X - X].push_back(p[0]);
+	real[Y - X].push_back(p[1]);
+	real[Z - X].push_back(p[2]);
+	real[VX - X].push_back(v[0]);
+	real[VY - X].push_back(v[1]);
+	real[VZ - X].push_back(v[2]);
+	real[GAMMA - X].push_back(p.getGamma());
+}
+
+SnapshotWriter::SnapshotWriter(const std::string &path, uint32_t my_flags, uint32_t step_decimation, uint32_t particle_decimation, const Compression &compression, Overflow my_overflow) :
+	file(path, std::ios::binary | std::ios::trunc),
+	flags(my_flags),
+	overflow(my_overflow),
+	encoder(compression)
+{
+	if(not file) throw excptn::SNAPSHOT_FILE_ERROR;
+
+	file.write(FILE_MAGIC, 8);
+	put<uint32_t>(file, VERSION);
+	put<uint32_t>(file, flags);
+	put<uint32_t>(file, step_decimation);
+	put<uint32_t>(file, particle_decimation);
+
+	worker = std::thread(&SnapshotWriter::run, this);
+}
+
+SnapshotWriter::~SnapshotWriter(void){
+	try{ close(); }
+	catch(...){} // destructors must not throw
+}
+
+void SnapshotWriter::commit(void){
+	if(closed) throw excptn::SNAPSHOT_WRITER_CLOSED;
+
+	{
+		// the writer thread does not hold the mutex while writing, so this only waits for the disk if the queue is full
+		std::unique_lock<std::mutex> lock(mtx);
+		if(pending.size() >= QUEUE_DEPTH){
+			if(overflow == Overflow::DROP){
+				++dropped;
+				capture.clear();
+				return;
+			}
+			++waits;
+			space.wait(lock, [this]{ return pending.size() < QUEUE_DEPTH; });
+		}
+
+		pending.push_back(std::move(capture));
+		if(spare.empty()){
+			capture = Snapshot();
+		}else{
+			capture = std::move(spare.back());
+			spare.pop_back();
+		}
+	}
+	cv.notify_one();
+
+	++committed;
+	capture.clear(); // keeps the capacity of the recycled buffer
+}
+
+void SnapshotWriter::run(void){
+	if(trace::active()) trace::name_thread("snapshot writer");
+
+	std::unique_lock<std::mutex> lock(mtx);
+	while(true){
+		cv.wait(lock, [this]{ return not pending.empty() or stopping; });
+		if(pending.empty()) return; // stopping, nothing left to write
+
+		Snapshot writing(std::move(pending.front()));
+		pending.pop_front();
+		space.notify_one();
+
+		lock.unlock();
+		write_chunk(writing);
+		lock.lock();
+		spare.push_back(std::move(writing));
+	}
+}
+
+void SnapshotWriter::write_chunk(const Snapshot &s){
+	const uint32_t count(s.size());
+	const trace::Scope scope("snapshot write", "snapshot", "particles", count);
+	const bool compressed((flags & COMPRESSED) and s.frames);
+	const bool single(flags & FLOAT32);
+
+	std::vector<char> encoded;
+	if(compressed) encoded = encoder.encode(s, *s.frames);
+
+	const uint64_t payload(compressed ? encoded.size() : count * (2*sizeof(uint32_t) + NUM_REAL_FIELDS*(single ? sizeof(float) : sizeof(double))));
+
+	index.push_back({s.step, s.time, static_cast<uint64_t>(file.tellp()), count});
+
+	file.write(CHUNK_MAGIC, 4);
+	put<uint32_t>(file, compressed ? QUANTISED : RAW);
+	put<uint64_t>(file, s.step);
+	put<double>(file, s.time);
+	put<uint32_t>(file, count);
+	put<uint64_t>(file, payload);
+
+	if(compressed){
+		file.write(encoded.data(), encoded.size());
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(s.id.data()), count*sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(s.element.data()), count*sizeof(uint32_t));
+
+	for(const auto &column : s.real){
+		if(single){
+			std::vector<float> converted(column.begin(), column.end());
+			file.write(reinterpret_cast<const char*>(converted.data()), count*sizeof(float));
+		}else{
+			file.write(reinterpret_cast<const char*>(column.data()), count*sizeof(double));
+		}
+	}
+}
+
+void SnapshotWriter::close(void){
+	if(not worker.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	cv.notify_one();
+	worker.join();
+	closed = true;
+
+	const uint64_t index_offset(file.tellp());
+	file.write(INDEX_MAGIC, 4);
+	put<uint64_t>(file, index.size());
+	for(const auto &entry : index){
+		put<uint64_t>(file, entry.step);
+		put<double>(file, entry.time);
+		put<uint64_t>(file, entry.offset);
+		put<uint32_t>(file, entry.count);
+	}
+	put<uint64_t>(file, index_offset);
+	file.write(END_MAGIC, 8);
+
+	file.close();
+	if(file.fail()) throw excptn::SNAPSHOT_FILE_ERROR;
+}
+
+SnapshotReader::SnapshotReader(const std::string &path) :
+	file(path, std::ios::binary)
+{
+	if(not file) throw excptn::SNAPSHOT_FILE_ERROR;
+
+	expect(file, FILE_MAGIC, 8);
+	if(get<uint32_t>(file) != VERSION) throw excptn::SNAPSHOT_BAD_FORMAT;
+	flags = get<uint32_t>(file);
+	step_decimation = get<uint32_t>(file);
+	particle_decimation = get<uint32_t>(file);
+
+	file.seekg(-static_cast<std::streamoff>(sizeof(uint64_t) + 8), std::ios::end);
+	const uint64_t index_offset(get<uint64_t>(file));
+	expect(file, END_MAGIC, 8);
+
+	file.seekg(index_offset);
+	expect(file, INDEX_MAGIC, 4);
+	index.resize(get<uint64_t>(file));
+	for(auto &entry : index){
+		entry.step = get<uint64_t>(file);
+		entry.time = get<double>(file);
+		entry.offset = get<uint64_t>(file);
+		entry.count = get<uint32_t>(file);
+	}
+}
+
+std::vector<char> SnapshotReader::payload(size_t i, uint32_t &encoding, Snapshot &s){
+	const IndexEntry &entry(index.at(i));
+	file.seekg(entry.offset);
+
+	expect(file, CHUNK_MAGIC, 4);
+	encoding = get<uint32_t>(file);
+	s.step = get<uint64_t>(file);
+	s.time = get<double>(file);
+	s.id.resize(get<uint32_t>(file));
+
+	std::vector<char> data(get<uint64_t>(file));
+	file.read(data.data(), data.size());
+	if(not file) throw excptn::SNAPSHOT_BAD_FORMAT;
+
+	return data;
+}
+
+Snapshot SnapshotReader::read(size_t i){
+	Snapshot s;
+	uint32_t encoding;
+	std::vector<char> data(payload(i, encoding, s));
+
+	if(encoding == QUANTISED){
+		if(data.empty()) throw excptn::SNAPSHOT_BAD_FORMAT;
+		if(not SnapshotDecoder::is_keyframe(data.data()) and last_decoded + 1 != i){
+			// decode forward from the last keyframe before chunk i
+			size_t k(i);
+			Snapshot skipped;
+			do{
+				if(k == 0) throw excptn::SNAPSHOT_BAD_FORMAT;
+				data = payload(--k, encoding, skipped);
+				if(encoding != QUANTISED) throw excptn::SNAPSHOT_BAD_FORMAT;
+			}while(data.empty() or not SnapshotDecoder::is_keyframe(data.data()));
+
+			decoder.decode(data, skipped);
+			for(++k; k < i; ++k){
+				data = payload(k, encoding, skipped);
+				decoder.decode(data, skipped);
+			}
+			data = payload(i, encoding, s);
+		}
+		decoder.decode(data, s);
+		last_decoded = i;
+		return s;
+	}
+
+	if(encoding != RAW) throw excptn::SNAPSHOT_BAD_FORMAT;
+
+	const size_t count(s.id.size());
+	const bool single(flags & FLOAT32);
+	if(data.size() != count * (2*sizeof(uint32_t) + NUM_REAL_FIELDS*(single ? sizeof(float) : sizeof(double)))){
+		throw excptn::SNAPSHOT_BAD_FORMAT;
+	}
+
+	const char* position(data.data());
+	s.element.resize(count);
+	std::memcpy(s.id.data(), position, count*sizeof(uint32_t));
+	position += count*sizeof(uint32_t);
+	std::memcpy(s.element.data(), position, count*sizeof(uint32_t));
+	position += count*sizeof(uint32_t);
+
+	for(auto &column : s.real){
+		column.resize(count);
+		if(single){
+			const float* values(reinterpret_cast<const float*>(position));
+			column.assign(values, values + count);
+			position += count*sizeof(float);
+		}else{
+			std::memcpy(column.data(), position, count*sizeof(double));
+			position += count*sizeof(double);
+		}
+	}
+
+	return s;
+}
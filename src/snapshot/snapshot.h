@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+
+#include "codec.h"
+
+class Particle;
+
+/*
+ * Binary snapshot format (host byte order, i.e. little-endian on every machine we run on):
+ *
+ *   file header : "CJSNAP\0\0" | uint32 version | uint32 flags | uint32 step decimation | uint32 particle decimation
+ *   chunk       : "CHNK" | uint32 encoding | uint64 step | double time | uint32 count | uint64 payload size | payload
+ *   index       : "CIDX" | uint64 number of chunks | { uint64 step, double time, uint64 offset, uint32 count } per chunk
+ *   trailer     : uint64 offset of the index | "CJEND\0\0\0"
+ *
+ * An uncompressed payload stores one array per field, in the order of snapshot::Field.
+ * Identifiers and element indices are uint32, the other fields are double (or float with snapshot::FLOAT32).
+ * A quantised payload (with snapshot::COMPRESSED) is described in codec.h; it is decoded into the same fields.
+ * The index at the end of the file allows random access to any chunk without scanning the whole file.
+ */
+
+namespace snapshot{
+	constexpr uint32_t VERSION(2); // 2: quantised payloads carry gamma.v rather than v
+
+	enum Flags : uint32_t { FLOAT32 = 1, COMPRESSED = 2 };
+	enum Encoding : uint32_t { RAW = 0, QUANTISED = 1 };
+
+	enum Field { ID, ELEMENT, X, Y, Z, VX, VY, VZ, GAMMA, NUM_FIELDS };
+	constexpr int NUM_REAL_FIELDS(NUM_FIELDS - X);
+
+	// what SnapshotWriter::commit does when QUEUE_DEPTH snapshots are already waiting for the disk
+	enum class Overflow { WAIT, DROP };
+	constexpr size_t QUEUE_DEPTH(4);
+}
+
+struct Snapshot{
+	// columnar copy of the phase space of the (decimated) beam at a given step
+	unsigned long step = 0;
+	double time = 0.0;
+
+	std::vector<uint32_t> id;
+	std::vector<uint32_t> element; // index of the particle's element in the accelerator
+	std::vector<double> real[snapshot::NUM_REAL_FIELDS]; // x, y, z (in m), vx, vy, vz (in c), gamma
+
+	std::shared_ptr<const std::vector<ElementFrame>> frames; // geometry of the elements, needed for compression
+
+	size_t size(void) const{ return id.size(); }
+
+	void clear(void);
+	void reserve(size_t n);
+	void push_back(const Particle &p, uint32_t element_index);
+};
+
+class SnapshotWriter{
+	// Writes snapshots on a background thread.
+	// The tracking thread fills one buffer while the committed ones wait in a bounded queue for the writer thread.
+	// When the queue is full, commit() drops the snapshot (snapshot::Overflow::DROP, the default, so that tracking never
+	// waits for the disk) or, if asked for, waits for the writer (snapshot::Overflow::WAIT, so that every snapshot is
+	// written); either way, it is counted. The buffers are recycled, keeping their capacity.
+	private:
+		std::ofstream file;
+		const uint32_t flags;
+		const snapshot::Overflow overflow;
+		SnapshotEncoder encoder; // only used with snapshot::COMPRESSED
+
+		struct IndexEntry{ uint64_t step; double time; uint64_t offset; uint32_t count; };
+		std::vector<IndexEntry> index;
+
+		Snapshot capture; // filled by the tracking thread
+		std::deque<Snapshot> pending; // committed, at most QUEUE_DEPTH, guarded by mtx
+		std::vector<Snapshot> spare; // written, to be recycled, guarded by mtx
+
+		bool stopping = false;
+		bool closed = false;
+		std::mutex mtx;
+		std::condition_variable cv; // a snapshot is pending, or stopping
+		std::condition_variable space; // the queue is no longer full
+		std::thread worker;
+
+		unsigned long committed = 0;
+		unsigned long dropped = 0;
+		unsigned long waits = 0; // commits that waited for the writer
+
+		void run(void);
+		void write_chunk(const Snapshot &s);
+
+	public:
+		SnapshotWriter(const std::string &path, uint32_t my_flags = 0, uint32_t step_decimation = 1, uint32_t particle_decimation = 1, const snapshot::Compression &compression = snapshot::Compression(), snapshot::Overflow my_overflow = snapshot::Overflow::DROP);
+		~SnapshotWriter(void);
+
+		SnapshotWriter(const SnapshotWriter &) = delete;
+		SnapshotWriter& operator=(const SnapshotWriter &) = delete;
+
+		Snapshot& frame(void){ return capture; } // buffer of the snapshot being captured
+		void commit(void); // hands the captured snapshot over to the writer thread, throws once closed
+		void close(void); // waits for the pending snapshots, then writes the index
+
+		unsigned long getCommitted(void) const{ return committed; } // written or to be written
+		unsigned long getDropped(void) const{ return dropped; }
+		unsigned long getWaits(void) const{ return waits; }
+};
+
+class SnapshotReader{
+	// Random access to the chunks of a snapshot file
+	private:
+		std::ifstream file;
+		uint32_t flags;
+		uint32_t step_decimation;
+		uint32_t particle_decimation;
+
+		struct IndexEntry{ uint64_t step; double time; uint64_t offset; uint32_t count; };
+		std::vector<IndexEntry> index;
+
+		// quantised chunks depend on the previous ones: the decoder is kept so that sequential reads are cheap
+		SnapshotDecoder decoder;
+		size_t last_decoded = SIZE_MAX;
+
+		std::vector<char> payload(size_t i, uint32_t &encoding, Snapshot &s);
+
+	public:
+		explicit SnapshotReader(const std::string &path);
+
+		size_t chunk_count(void) const{ return index.size(); }
+		unsigned long chunk_step(size_t i) const{ return index.at(i).step; }
+		double chunk_time(size_t i) const{ return index.at(i).time; }
+
+		uint32_t getFlags(void) const{ return flags; }
+		uint32_t getStep_decimation(void) const{ return step_decimation; }
+		uint32_t getParticle_decimation(void) const{ return particle_decimation; }
+
+		Snapshot read(size_t i);
+};
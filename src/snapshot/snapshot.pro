@@ -0,0 +1,20 @@
+TEMPLATE = lib
+
+CONFIG = staticlib c++11 thread
+
+INCLUDEPATH += \
+	../general \
+	../physics \
+
+SOURCES += \
+	snapshot.cpp \
+	codec.cpp \
+	snapshotview.cpp \
+
+HEADERS += \
+	snapshot.h \
+	codec.h \
+	snapshotview.h \
+	acceleratorwidgetsnapshot.h \
+
+include(../cernjunior.pri)
@@ -0,0 +1,39 @@
+#include "snapshotview.h"
+
+#include "../physics/particle.h"
+#include "../physics/accelerator.h"
+
+void SnapshotView::index_elements(const Accelerator &a){
+	// elements are fixed once the accelerator is initialized, so this is only done once
+	element_indices.clear();
+	for(size_t i(0); i < a.element_count(); ++i){
+		element_indices[&a.getElement(i)] = i;
+	}
+	frames = std::make_shared<const std::vector<ElementFrame>>(lattice_frames(a));
+}
+
+void SnapshotView::draw(const Particle &to_draw){
+	if(not current or to_draw.getId() % particle_decimation != 0) return;
+
+	auto found(element_indices.find(to_draw.getElement()));
+	writer.frame().push_back(to_draw, found == element_indices.end() ? UINT32_MAX : found->second);
+}
+
+void SnapshotView::draw(const Accelerator &to_draw){
+	if(to_draw.getStep() % step_decimation != 0) return;
+
+	if(element_indices.size() != to_draw.element_count()) index_elements(to_draw);
+
+	const trace::Scope scope("snapshot capture", "snapshot", "particles", to_draw.particle_count());
+	Snapshot &frame(writer.frame());
+	frame.step = to_draw.getStep();
+	frame.time = to_draw.getTime();
+	frame.frames = frames;
+	frame.reserve(to_draw.particle_count() / particle_decimation + 1);
+
+	current = &to_draw;
+	to_draw.draw_particles();
+	current = nullptr;
+
+	writer.commit();
+}
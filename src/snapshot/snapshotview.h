@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "../general/canvas.h"
+#include "snapshot.h"
+
+class SnapshotView : public Canvas{
+	// Canvas that records the beam into a binary snapshot file instead of displaying it.
+	// Only every step_decimation-th step and every particle_decimation-th particle (by identifier) are kept.
+	private:
+		SnapshotWriter writer;
+		const unsigned int step_decimation;
+		const unsigned int particle_decimation;
+
+		const Accelerator* current = nullptr; // accelerator whose snapshot is being captured
+		std::unordered_map<const Element*, uint32_t> element_indices;
+		std::shared_ptr<const std::vector<ElementFrame>> frames;
+
+		void index_elements(const Accelerator &a);
+	public:
+		SnapshotView(const std::string &path, uint32_t flags = 0, unsigned int my_step_decimation = 1, unsigned int my_particle_decimation = 1, const snapshot::Compression &compression = snapshot::Compression(), snapshot::Overflow overflow = snapshot::Overflow::DROP) :
+			Canvas(),
+			writer(path, flags, my_step_decimation ? my_step_decimation : 1, my_particle_decimation ? my_particle_decimation : 1, compression, overflow),
+			step_decimation(my_step_decimation ? my_step_decimation : 1),
+			particle_decimation(my_particle_decimation ? my_particle_decimation : 1)
+		{}
+		virtual ~SnapshotView(void){}
+
+		virtual void draw(const Box &) override{}
+		virtual void draw(const Particle &to_draw) override;
+		virtual void draw(const Beam &) override{}
+		virtual void draw(const Element &) override{}
+		virtual void draw(const Accelerator &to_draw) override;
+
+		void close(void){ writer.close(); }
+
+		unsigned long getCommitted(void) const{ return writer.getCommitted(); }
+		unsigned long getDropped(void) const{ return writer.getDropped(); }
+		unsigned long getWaits(void) const{ return writer.getWaits(); }
+};
@@ -11,10 +11,10 @@ INCLUDEPATH += \
 	../../textview \
 
 LIBS += \
+	-L../../textview -ltextview \
+	-L../../physics -lphysics \
 	-L../../color -lcolor \
 	-L../../vector3d -lvector3d \
-	-L../../physics -lphysics \
-	-L../../textview -ltextview \
 
 PRE_TARGETDEPS +=\
 	../../color/libcolor.a \
@@ -24,3 +24,5 @@ PRE_TARGETDEPS +=\
 
 SOURCES += \
 	accelerator_test.cpp \
+
+include(../../cernjunior.pri)
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "../../physics/accelerator.h"
+
+using namespace std;
+
+// Counts the allocations made through the global operator new, and checks that once the accelerator has taken a
+// few steps (the warm-up, over which the trees and the lists of block timesteps reach their size), evolve makes
+// none, with and without block timesteps. The lost particles are freed as they are lost, which is not counted.
+
+namespace{
+	atomic<unsigned long> allocations(0);
+
+	const unsigned int PARTICLES(500);
+	const double DT(1e-11);
+	const int WARM_UP(20);
+	const int STEPS(500);
+
+	// number of allocations made by steps calls to evolve()
+	unsigned long count(Accelerator &w, int steps){
+		const unsigned long before(allocations.load());
+		for(int i(0); i < steps; ++i) w.evolve(DT);
+		return allocations.load() - before;
+	}
+}
+
+void* operator new(size_t size){
+	++allocations;
+	if(void* p = malloc(size ? size : 1)) return p;
+	throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept{ free(p); }
+void operator delete(void* p, size_t) noexcept{ free(p); }
+
+int main(void){
+	int failures(0);
+	for(unsigned int levels : {0u, 3u}){
+		Accelerator w(nullptr, Vector3D(3,2,0));
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(5);
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), PARTICLES*1e5, 1e5, 0.01, 0.001);
+		w.setBlock_timesteps(levels, simcst::DEFAULT_MAX_DEFLECTION);
+		w.initialize();
+
+		const unsigned long warm_up(count(w, WARM_UP));
+		const unsigned long steady(count(w, STEPS));
+		cout << "block levels " << levels << ": " << warm_up << " allocations over the first " << WARM_UP << " steps, "
+		     << steady << " over the next " << STEPS << " (" << w.particle_count() << " particles left)\n";
+		if(steady){
+			cout << "FAILED: evolve allocates in the steady state\n";
+			++failures;
+		}
+	}
+
+	// drawing random vectors allocates nothing either
+	GaussianVector3D gaussian(1.0);
+	RandomEngine gen(1);
+	const unsigned long before(allocations.load());
+	const RandomVector3D copy(gaussian);
+	for(int i(0); i < 100; ++i) gaussian(gen);
+	if(allocations.load() != before){
+		cout << "FAILED: random vectors allocate\n";
+		++failures;
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
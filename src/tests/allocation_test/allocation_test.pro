@@ -0,0 +1,22 @@
+CONFIG += \
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = allocation_test.out
+
+LIBS += \
+	-L../../physics -lphysics \
+	-L../../color -lcolor \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../color/libcolor.a \
+	../../vector3d/libvector3d.a \
+	../../physics/libphysics.a \
+
+SOURCES += \
+	allocation_test.cpp \
+
+include(../../cernjunior.pri)
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cmath>
+
+#include "../../physics/accelerator.h"
+
+using namespace std;
+
+// Runs the same beam in the default accelerator with several Barnes-Hut opening angles, and checks that the
+// trajectories get closer to those of the exact sums (theta = 0) as theta decreases, at the cost of more
+// interactions. Opening angles that are negative or not a number are refused. With the approximations of fastmath,
+// the forces computed 8 interactions at a time (see ForceBatch) must be those computed one at a time, to the bit with
+// the scalar kernel and to within a tolerance with the vector ones.
+
+namespace{
+	const unsigned int PARTICLES(300);
+	const double LAMBDA(1e7); // heavy macro-particles, so that the space charge is not negligible
+	const double DT(1e-11);
+	const int STEPS(200);
+	const double BATCHED_TOLERANCE(1e-13); // relative to the largest force, with the vector kernels
+
+	void run(Accelerator &w, double theta){
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(1);
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), PARTICLES*LAMBDA, LAMBDA, 0.01, 0.001);
+		w.setBarnes_hut_theta(theta);
+		w.initialize();
+		for(int i(0); i < STEPS; ++i) w.evolve(DT);
+	}
+
+	// largest distance between the particles of a and b, or NAN if they did not lose the same particles
+	double distance(const Accelerator &a, const Accelerator &b){
+		if(a.particle_count() != b.particle_count()) return NAN;
+		double d(0.0);
+		for(size_t i(0); i < a.particle_count(); ++i){
+			if(a.getParticle(i).getId() != b.getParticle(i).getId()) return NAN;
+			d = max(d, (a.getParticle(i) - b.getParticle(i)).norm());
+		}
+		return d;
+	}
+
+	// number of particles of a cloud whose batched forces differ from those computed one interaction at a time by more
+	// than the given fraction of the largest force, with the given kernel
+	size_t batched_differences(double theta, fastmath::Kernel kernel, double tolerance){
+		RandomEngine gen(2);
+		GaussianVector3D offset(0.2);
+		vector<unique_ptr<Particle>> particles;
+		for(unsigned int i(0); i < 10*PARTICLES; ++i) particles.push_back(Proton(offset(gen), 2, vctr::X_VECTOR).copy());
+
+		NodePool pool;
+		Node root(Box(nullptr, vctr::ZERO_VECTOR, vctr::X_VECTOR, 1.0));
+		root.setPool(&pool);
+		for(const auto &p : particles) root.insert(p.get());
+
+		fastmath::select(kernel);
+		vector<Vector3D> batched, single;
+		double largest(0.0);
+		for(const auto &p : particles){
+			root.apply_electromagnetic_force(*p, Precision::DOUBLE, theta);
+			batched.push_back(p->getForce());
+			p->reset_force();
+			root.apply_electromagnetic_force<double>(*p, theta);
+			single.push_back(p->getForce());
+			p->reset_force();
+			largest = max(largest, single.back().norm());
+		}
+		fastmath::select(fastmath::Kernel::LIBM);
+
+		size_t differences(0);
+		for(size_t i(0); i < particles.size(); ++i){
+			const Vector3D d(batched[i] - single[i]);
+			if(not (abs(d[0]) <= tolerance*largest and abs(d[1]) <= tolerance*largest and abs(d[2]) <= tolerance*largest)) ++differences;
+		}
+		return largest > 0.0 ? differences : particles.size();
+	}
+}
+
+int main(void){
+	Accelerator exact(nullptr, Vector3D(3,2,0));
+	Accelerator fine(nullptr, Vector3D(3,2,0));
+	Accelerator coarse(nullptr, Vector3D(3,2,0));
+	run(exact, 0.0);
+	run(fine, 0.3);
+	run(coarse, 1.0);
+
+	const double fine_error(distance(fine, exact));
+	const double coarse_error(distance(coarse, exact));
+	cout << "Largest distance to the exact sums: " << fine_error << " m with theta = 0.3, " << coarse_error << " m with theta = 1\n";
+	cout << "Interactions: " << exact.getProfile().interactions << ", " << fine.getProfile().interactions << ", " << coarse.getProfile().interactions << "\n";
+
+	int failures(0);
+	if(not (fine_error < coarse_error)){
+		cout << "FAILED: a smaller opening angle is not more accurate\n";
+		++failures;
+	}
+	if(EvolveProfile::ENABLED and not (exact.getProfile().interactions > fine.getProfile().interactions and fine.getProfile().interactions > coarse.getProfile().interactions)){
+		cout << "FAILED: a smaller opening angle does not take more interactions\n";
+		++failures;
+	}
+
+	// the scalar kernel takes the same operations as one interaction at a time, but the vector ones may contract some
+	// into fused multiply-adds (see fast_math.cpp)
+	for(fastmath::Kernel kernel : {fastmath::Kernel::SCALAR, fastmath::best()}){
+		const double tolerance(kernel == fastmath::Kernel::SCALAR ? 0.0 : BATCHED_TOLERANCE);
+		for(double theta : {0.0, 0.5, 1.0}){
+			const size_t differences(batched_differences(theta, kernel, tolerance));
+			if(differences){
+				cout << "FAILED: the batched forces differ for " << differences << " particles with theta = " << theta << " and the " << fastmath::name(kernel) << " kernel\n";
+				++failures;
+			}
+		}
+	}
+
+	for(double theta : {-0.1, double(NAN), double(INFINITY)}){
+		try{
+			exact.setBarnes_hut_theta(theta);
+			cout << "FAILED: accepted the opening angle " << theta << "\n";
+			++failures;
+		}catch(const invalid_argument&){}
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
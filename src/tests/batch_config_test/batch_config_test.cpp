@@ -0,0 +1,122 @@
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "../../batch/batch_config.h"
+
+using namespace std;
+
+// Reads configurations with read_batch_config: a complete one, whose commands must all be taken into account, and
+// wrong ones, each of which must be rejected with the number of its faulty line rather than read as something else
+// (a negative count wrapping to a huge unsigned one, for instance).
+
+namespace{
+	int failures(0);
+
+	void check(bool condition, const string &what){
+		if(condition) return;
+		cout << "FAILED: " << what << "\n";
+		++failures;
+	}
+
+	BatchConfig read(const string &text){
+		istringstream input(text);
+		return read_batch_config(input);
+	}
+
+	// text must be rejected, at line 2
+	void rejected(const string &command){
+		try{
+			read("timestep 1e-11 # a comment\n" + command + "\n");
+			check(false, "'" + command + "' is accepted");
+		}catch(const invalid_argument &e){
+			check(string(e.what()).compare(0, 7, "line 2:") == 0, "'" + command + "' is reported as '" + e.what() + "'");
+		}
+	}
+}
+
+int main(void){
+	const BatchConfig config(read(
+		"# complete configuration\n"
+		"\n"
+		"origin 1 2 3\n"
+		"straight 0.1 1 0 0\n"
+		"dipole 0.1 2 5.89 # closes the ring\n"
+		"quadrupole 0.1 -1.2 4 0 0\n"
+		"beam gaussian p 1000 10 0.01 0.001 3\n"
+		"particle e 0 0 0 2 1 0 0\n"
+		"timestep 2e-11\n"
+		"steps -1\n"
+		"space_charge on single\n"
+		"barnes_hut 0.3\n"
+		"block_timesteps 3 1e-4\n"
+		"seed 42\n"
+		"engine curvilinear 8\n"
+		"turns 5\n"
+		"sweep b 1 2 3\n"
+		"repeat 2\n"
+		"threads 4\n"
+		"table runs.tsv\n"
+		"trace run.json 100\n"
+		"output out.cjs every 10 particles 2 float32 compress 1e-6 1e-3 wait\n"
+		"summary every 100\n"
+		"trees every 0\n"
+	));
+	check(config.origin == Vector3D(1,2,3), "origin");
+	check(config.lattice.size() == 3 and config.lattice[1].kind == ElementSpec::DIPOLE and not config.lattice[1].has_end, "lattice");
+	check(config.lattice[2].b == -1.2 and config.lattice[2].has_end and config.lattice[2].end == Vector3D(4,0,0), "quadrupole");
+	check(config.beams.size() == 2 and config.beams[0].N == 1000 and config.beams[0].energy == 3 and config.beams[1].single, "beams");
+	check(config.dt == 2e-11 and config.steps == -1, "timestep and steps");
+	check(config.space_charge and config.space_charge_precision == Precision::SINGLE and config.barnes_hut_theta == 0.3, "space charge");
+	check(config.block_levels == 3 and config.max_deflection == 1e-4, "block timesteps");
+	check(config.has_seed and config.seed == 42, "seed");
+	check(config.engine == BatchConfig::CURVILINEAR and config.steps_per_element == 8 and config.turns == 5, "engine");
+	check(config.sweeps.size() == 1 and config.sweeps[0].values.size() == 3 and config.repeats == 2 and config.threads == 4, "ensemble");
+	check(config.is_ensemble() and config.table == "runs.tsv", "table");
+	check(config.trace == "run.json" and config.trace_events == 100, "trace");
+	check(config.output.path == "out.cjs" and config.output.step_decimation == 10 and config.output.particle_decimation == 2, "output");
+	check(config.output.float32 and config.output.compress and config.output.overflow == snapshot::Overflow::WAIT, "output options");
+	check(config.output.summary_interval == 100 and config.output.tree_interval == 0, "intervals");
+
+	for(const char* command : {
+		"frobnicate 3",
+		"straight",
+		"straight 0.1 1 0",
+		"dipole 0.1 2",
+		"timestep 0",
+		"steps -2",
+		"steps 10 20",
+		"beam gaussian p -1 10 0.01 0.001",
+		"beam gaussian p 99999999999 10 0.01 0.001",
+		"beam elliptic p 100 10 0.01 0.001",
+		"particle x 0 0 0 2 1 0 0",
+		"space_charge maybe",
+		"barnes_hut -0.1",
+		"block_timesteps 21",
+		"seed -1",
+		"engine curvilinear 0",
+		"engine magic",
+		"turns -1",
+		"sweep emittance 1",
+		"repeat 0",
+		"threads -1",
+		"polygon 0 0 0 0 1 0.1 1 1",
+		"output out.cjs every -1",
+		"output out.cjs every 0",
+		"output out.cjs particles -3",
+		"output out.cjs zip",
+		"output out.cjs compress 0 1e-8",
+		"output out.cjs compress 1e-6 -1e-8",
+		"output out.cjs compress 1e400 1e-8",
+		"summary every -1",
+		"summary 10",
+		"trees every -5",
+		"trace run.json 0",
+	}){
+		rejected(command);
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
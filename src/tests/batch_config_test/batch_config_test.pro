@@ -0,0 +1,27 @@
+CONFIG += \
+	    thread\
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = batch_config_test.out
+
+LIBS += \
+	-L../../batch -lbatch \
+	-L../../snapshot -lsnapshot \
+	-L../../physics -lphysics \
+	-L../../color -lcolor \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../batch/libbatch.a \
+	../../snapshot/libsnapshot.a \
+	../../color/libcolor.a \
+	../../vector3d/libvector3d.a \
+	../../physics/libphysics.a \
+
+SOURCES += \
+	batch_config_test.cpp \
+
+include(../../cernjunior.pri)
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cmath>
+#include <initializer_list>
+
+#include "../../physics/static_lattice.h"
+
+using namespace std;
+
+// Checks that block timesteps reduce to uniform steps when every particle is forced to the same level,
+// and that only the particles about to cross the edge of a field take finer steps: those in the straight
+// sections and inside the (uniform) dipoles keep the coarsest one.
+
+namespace{
+	// curvilinear coordinates along the ring of four FODO cells and four sector dipoles (see cernjunior::stable_ring),
+	// whose first dipole runs from 4 m to 10.28 m, after the drift of the first cell
+	const double DRIFT(1.5);
+	const double DIPOLE(5.0);
+	const double BEFORE_DIPOLE(3.99); // a step of dt takes the particle 3 cm further, into the dipole
+	const double BEFORE_CELL(10.27); // and out of the dipole, into the quadrupole of the second cell
+
+	// the ring and a proton at each curvilinear coordinate s, slightly off the ideal orbit
+	void build(Accelerator &w, std::initializer_list<double> s){
+		cernjunior::stable_ring().build(w);
+
+		const Vector3D offset(0.001, 0.0, 0.0005);
+		for(double s_0 : s){
+			const std::array<Vector3D,2> x(w.position_and_trajectory(s_0));
+			w.addParticle(Proton(x[0] + offset, 2, x[1]));
+		}
+
+		w.setSpace_charge(false);
+		w.initialize();
+	}
+
+	// largest distance between the particles of a and b
+	double distance(const Accelerator &a, const Accelerator &b){
+		double d(0.0);
+		for(size_t i(0); i < a.particle_count(); ++i) d = max(d, (a.getParticle(i) - b.getParticle(i)).norm());
+		return d;
+	}
+}
+
+int main(void){
+	const double dt(1e-10);
+	const unsigned int levels(3);
+	const int steps(200);
+	int failures(0);
+
+	// both particles cross an edge during the first step, none during the others
+	Accelerator finest(nullptr, Vector3D(6,2,0)), fine(nullptr, Vector3D(6,2,0));
+	build(finest, {BEFORE_DIPOLE, BEFORE_CELL});
+	build(fine, {BEFORE_DIPOLE, BEFORE_CELL});
+	finest.setBlock_timesteps(levels, 1e-30); // every particle at the finest level
+	finest.evolve(dt);
+	for(int k(0); k < (1 << levels); ++k) fine.evolve(dt/(1 << levels));
+
+	Accelerator coarsest(nullptr, Vector3D(6,2,0)), coarse(nullptr, Vector3D(6,2,0));
+	build(coarsest, {DRIFT, DIPOLE});
+	build(coarse, {DRIFT, DIPOLE});
+	coarsest.setBlock_timesteps(levels, 1e30); // every particle at the coarsest level
+	for(int i(0); i < steps; ++i){
+		coarsest.evolve(dt);
+		coarse.evolve(dt);
+	}
+
+	cout << "Distance to uniform steps, all particles at the finest level: " << distance(finest, fine) << " m\n";
+	cout << "Distance to uniform steps, all particles at the coarsest level: " << distance(coarsest, coarse) << " m\n";
+	if(finest.particle_count() != 2 or finest.block_population(levels) != 2 or not (distance(finest, fine) < 1e-12)){
+		cout << "FAILED: block timesteps at the finest level differ from uniform fine steps\n";
+		++failures;
+	}
+	if(coarsest.particle_count() != 2 or not (distance(coarsest, coarse) < 1e-12)){
+		cout << "FAILED: block timesteps at the coarsest level differ from uniform coarse steps\n";
+		++failures;
+	}
+	if(abs(finest.getTime() - fine.getTime()) > 1e-15){
+		cout << "FAILED: the clocks of the accelerators differ\n";
+		++failures;
+	}
+
+	// with 1e-3 per step, the particle entering the dipole needs steps of dt/8 (6.6e-3 in a step of dt), while the
+	// field does not change along the steps of the other two
+	Accelerator adaptive(nullptr, Vector3D(6,2,0));
+	build(adaptive, {DRIFT, DIPOLE, BEFORE_DIPOLE});
+	adaptive.setBlock_timesteps(levels, 1e-3);
+	adaptive.evolve(dt);
+
+	cout << "Particles at each level:";
+	for(unsigned int l(0); l <= levels; ++l) cout << " " << adaptive.block_population(l);
+	cout << "\n";
+	if(adaptive.block_population(0) != 2 or adaptive.block_population(levels) != 1){
+		cout << "FAILED: expected the particles in the drift and in the dipole at the coarsest level, and the one entering the dipole at the finest\n";
+		++failures;
+	}
+
+	if(failures == 0) cout << "OK\n";
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#include <algorithm> // for count
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "../../ensemble/ensemble.h"
+#include "../../ensemble/thread_pool.h"
+
+using namespace std;
+
+// Checks the work-stealing ThreadPool (every task runs, including the ones submitted by tasks, idle workers steal
+// from a busy one, wait() can be called again and again, and rethrows what a task threw), then the ensemble runner:
+// one run per combination of the swept values and repetition, each with its own seed, and the same table whatever
+// the order in which the threads ran them.
+
+namespace{
+	int failures(0);
+
+	void check(bool condition, const string &what){
+		if(condition) return;
+		cout << "FAILED: " << what << "\n";
+		++failures;
+	}
+
+	const char* RING(
+		"origin 3 2 0\n"
+		"fodo 0.5 1.2 1.0  3 -2 0\n"
+		"dipole 0.5 1 5.89158  2 -3 0\n"
+		"fodo 0.5 1.2 1.0  -2 -3 0\n"
+		"dipole 0.5 1 5.89158  -3 -2 0\n"
+		"fodo 0.5 1.2 1.0  -3 2 0\n"
+		"dipole 0.5 1 5.89158  -2 3 0\n"
+		"fodo 0.5 1.2 1.0  2 3 0\n"
+		"dipole 0.5 1 5.89158\n"
+		"beam gaussian p 200 1.0 0.05 0.01\n"
+		"space_charge off\n"
+	);
+
+	BatchConfig read(const string &text){
+		istringstream input(text);
+		return read_batch_config(input);
+	}
+
+	// the table without the wall times, which differ from one run to the next
+	string table(const BatchConfig &config, vector<RunSummary> runs){
+		for(auto &r : runs) r.wall_time = 0.0;
+		ostringstream output;
+		ensemble::print_table(config, runs, output);
+		return output.str();
+	}
+}
+
+int main(void){
+	{
+		ThreadPool pool(4);
+		check(pool.size() == 4, "number of workers");
+
+		// tasks submitted from outside and from tasks, all waited for
+		atomic<int> done(0);
+		for(int i(0); i < 100; ++i){
+			pool.submit([&pool, &done]{
+				for(int j(0); j < 10; ++j) pool.submit([&done]{ ++done; });
+				++done;
+			});
+		}
+		pool.wait();
+		check(done == 1100, "1100 tasks run, " + to_string(done.load()) + " counted");
+
+		// a single task queues slow tasks on its own worker: the other ones must steal them
+		mutex mtx;
+		set<thread::id> thieves;
+		pool.submit([&pool, &mtx, &thieves]{
+			for(int j(0); j < 40; ++j){
+				pool.submit([&mtx, &thieves]{
+					this_thread::sleep_for(chrono::milliseconds(2));
+					lock_guard<mutex> lock(mtx);
+					thieves.insert(this_thread::get_id());
+				});
+			}
+		});
+		pool.wait();
+		check(thieves.size() > 1, "the tasks of a busy worker are not stolen");
+
+		// a task throws: the others still run, wait() rethrows once, and the pool goes on
+		done = 0;
+		for(int i(0); i < 20; ++i){
+			pool.submit([i, &done]{
+				++done;
+				if(i == 7) throw runtime_error("task 7");
+			});
+		}
+		bool rethrown(false);
+		try{
+			pool.wait();
+		}catch(const runtime_error &e){
+			rethrown = string(e.what()) == "task 7";
+		}
+		check(rethrown, "the exception of a task is not rethrown by wait()");
+		check(done == 20, "the other tasks do not all run after an exception");
+		pool.submit([&done]{ ++done; });
+		try{
+			pool.wait();
+		}catch(...){
+			check(false, "wait() rethrows the same exception twice");
+		}
+		check(done == 21, "the pool does not run tasks after an exception");
+	}
+
+	{
+		const BatchConfig config(read(string(RING) + "steps 300\nseed 11\nsweep b 1.0 1.4\nsweep phase 0 1 2\nrepeat 2\nthreads 3\n"));
+		const vector<BatchConfig> variants(ensemble::variants(config));
+		check(variants.size() == 12, "12 variants expected, " + to_string(variants.size()) + " made");
+
+		set<uint64_t> seeds;
+		for(const auto &v : variants){
+			seeds.insert(v.seed);
+			check(not v.is_ensemble() and v.has_seed, "a variant is itself an ensemble, or has no seed");
+		}
+		check(seeds.size() == variants.size(), "two runs share a seed");
+		check(variants[0].lattice[0].b == 1.0 and variants[2].lattice[0].b == 1.4 and variants[2].lattice[2].b == 1.4, "swept b");
+
+		const vector<RunSummary> runs(ensemble::run(config));
+		check(runs.size() == 12, "12 runs expected");
+		for(size_t i(0); i < runs.size(); ++i){
+			const RunSummary &r(runs[i]);
+			check(r.run == i and r.error.empty() and r.seed == variants[i].seed, "run " + to_string(i) + ": " + r.error);
+			check(r.parameters.size() == 2 and r.parameters[0] == (i/2 % 2 ? 1.4 : 1.0) and r.parameters[1] == double(i/4), "parameters of run " + to_string(i));
+			check(r.initial_particles == 200 and r.steps == 300, "initial particles or steps of run " + to_string(i));
+		}
+		check(runs[0].emittance_growth[0] != runs[1].emittance_growth[0], "two repetitions give the same result");
+
+		const string first(table(config, runs));
+		check(first == table(config, ensemble::run(config)), "the same ensemble gives another table");
+		check(count(first.begin(), first.end(), '\n') == 13, "the table has a header and one line per run");
+		check(first.compare(0, 12, "run\tb\tphase\t") == 0, "table header");
+	}
+
+	try{
+		read(string(RING) + "engine linear\nsweep B_0 5 6\n");
+		check(false, "sweeping B_0 with the linear engine is accepted");
+	}catch(const invalid_argument&){}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
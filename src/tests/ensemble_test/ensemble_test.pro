@@ -0,0 +1,29 @@
+CONFIG += \
+	    thread\
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = ensemble_test.out
+
+LIBS += \
+	-L../../ensemble -lensemble \
+	-L../../batch -lbatch \
+	-L../../snapshot -lsnapshot \
+	-L../../physics -lphysics \
+	-L../../color -lcolor \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../ensemble/libensemble.a \
+	../../batch/libbatch.a \
+	../../snapshot/libsnapshot.a \
+	../../color/libcolor.a \
+	../../vector3d/libvector3d.a \
+	../../physics/libphysics.a \
+
+SOURCES += \
+	ensemble_test.cpp \
+
+include(../../cernjunior.pri)
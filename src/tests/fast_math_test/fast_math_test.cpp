@@ -0,0 +1,101 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <limits>
+
+#include "../../vector3d/fast_math.h"
+
+using namespace std;
+
+// Compares each supported math kernel to libm on random arguments over the ranges met in the simulation and
+// beyond, plus the special values, and checks the error bounds given in fast_math.h. The inverse cube is compared
+// to its value in extended precision, since 1/pow(x, 1.5) is itself off when pow(x, 1.5) is subnormal. The number of arguments
+// is not a multiple of the width of the vector kernels, so that their scalar tails are exercised as well.
+
+namespace{
+	const size_t N(100003);
+
+	// largest error of y with respect to reference (relative if asked), or infinity if they disagree on which are numbers
+	double max_error(const vector<double> &y, const vector<double> &reference, bool relative){
+		double error(0.0);
+		for(size_t i(0); i < y.size(); ++i){
+			if(isnan(y[i]) != isnan(reference[i]) or isinf(y[i]) != isinf(reference[i])) return INFINITY;
+			if(not isfinite(reference[i]) or reference[i] == 0.0) continue;
+			const double e(abs(y[i] - reference[i]));
+			error = max(error, relative ? e/abs(reference[i]) : e);
+		}
+		return error;
+	}
+
+	int check(const char* function, fastmath::Kernel k, double error, double bound){
+		cout << "  " << function << ": " << error << " (bound " << bound << ")\n";
+		if(error <= bound) return 0;
+		cout << "FAILED: the " << fastmath::name(k) << " " << function << " exceeds its error bound\n";
+		return 1;
+	}
+}
+
+int main(void){
+	mt19937_64 gen(12);
+	uniform_real_distribution<double> exponent(-200.0, 200.0);
+	uniform_real_distribution<double> angle(-1e4, 1e4);
+	uniform_real_distribution<double> sine(-1.0, 1.0);
+
+	const double special[] = {0.0, -0.0, 1.0, -1.0, 0.5, -0.5, 1e-320, numeric_limits<double>::min(), numeric_limits<double>::max(),
+		INFINITY, -INFINITY, NAN, 1.5, 1e7, -3e9};
+
+	vector<double> r2(N), theta(N), s(N);
+	for(size_t i(0); i < N; ++i){
+		r2[i] = pow(10.0, exponent(gen));
+		theta[i] = i % 2 ? angle(gen) : 1e-3*angle(gen);
+		s[i] = sine(gen);
+	}
+	for(size_t i(0); i < sizeof(special)/sizeof(special[0]); ++i) r2[i] = theta[N/2 + i] = s[N - 1 - i] = special[i];
+
+	vector<double> inverse_cube(N), sin(N), cos(N), asin(N);
+	for(size_t i(0); i < N; ++i) inverse_cube[i] = r2[i] < 0.0 ? NAN : double(1.0L/pow((long double)r2[i], 1.5L));
+	fastmath::sincos(theta.data(), sin.data(), cos.data(), N, fastmath::Kernel::LIBM);
+	fastmath::asin(s.data(), asin.data(), N, fastmath::Kernel::LIBM);
+
+	int failures(0);
+	double rsqrt_error(0.0);
+	for(size_t i(0); i < N; ++i) rsqrt_error = max(rsqrt_error, double(abs(fastmath::approx::rsqrt(r2[i])*sqrt((long double)r2[i]) - 1.0L)));
+	cout << "scalar rsqrt: " << rsqrt_error << " (bound " << fastmath::RSQRT_ERROR << ")\n";
+	if(not (rsqrt_error <= fastmath::RSQRT_ERROR)){
+		cout << "FAILED: rsqrt exceeds its error bound\n";
+		++failures;
+	}
+
+	for(fastmath::Kernel k : {fastmath::Kernel::SCALAR, fastmath::Kernel::AVX2, fastmath::Kernel::AVX512}){
+		if(not fastmath::supported(k)){
+			cout << fastmath::name(k) << ": not supported\n";
+			continue;
+		}
+		cout << fastmath::name(k) << ":\n";
+
+		vector<double> y(N), z(N);
+		fastmath::inverse_cube(r2.data(), y.data(), N, k);
+		failures += check("inverse_cube", k, max_error(y, inverse_cube, true), fastmath::INVERSE_CUBE_ERROR);
+
+		fastmath::sincos(theta.data(), y.data(), z.data(), N, k);
+		failures += check("sin", k, max_error(y, sin, false), fastmath::SINCOS_ERROR);
+		failures += check("cos", k, max_error(z, cos, false), fastmath::SINCOS_ERROR);
+
+		fastmath::asin(s.data(), y.data(), N, k);
+		failures += check("asin", k, max_error(y, asin, false), fastmath::ASIN_ERROR);
+	}
+
+	// the single values follow the selected kernel
+	fastmath::select(fastmath::Kernel::SCALAR);
+	const bool approximated(fastmath::sin(1.0) == fastmath::approx::sin(1.0) and fastmath::asin(0.7) == fastmath::approx::asin(0.7));
+	fastmath::select(fastmath::Kernel::LIBM);
+	if(not approximated or fastmath::sin(1.0) != std::sin(1.0) or fastmath::rsqrt(2.0) != 1.0/std::sqrt(2.0)){
+		cout << "FAILED: the single values do not follow the selected kernel\n";
+		++failures;
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
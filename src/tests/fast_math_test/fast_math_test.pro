@@ -0,0 +1,21 @@
+CONFIG += \
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = fast_math_test.out
+
+INCLUDEPATH += \
+	../../vector3d \
+
+LIBS += \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../vector3d/libvector3d.a \
+
+SOURCES += \
+	fast_math_test.cpp \
+
+include(../../cernjunior.pri)
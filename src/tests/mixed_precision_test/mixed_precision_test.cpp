@@ -0,0 +1,64 @@
+#include <iostream>
+#include <cmath>
+
+#include "../../physics/accelerator.h"
+
+using namespace std;
+
+// Runs the same beam in the default accelerator without space charge, with space charge in double precision and
+// with space charge in single precision (the orbits being integrated in double precision in both cases), and
+// checks that the single-precision interactions change the trajectories by much less than the space charge itself.
+
+namespace{
+	const unsigned int PARTICLES(300);
+	const double LAMBDA(1e7); // heavy macro-particles, so that the space charge is not negligible
+	const double DT(1e-11);
+	const int STEPS(300);
+
+	void run(Accelerator &w, bool space_charge, Precision precision){
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(1);
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), PARTICLES*LAMBDA, LAMBDA, 0.01, 0.001);
+		w.setSpace_charge(space_charge);
+		w.setSpace_charge_precision(precision);
+		w.initialize();
+		for(int i(0); i < STEPS; ++i) w.evolve(DT);
+	}
+
+	// largest distance between the particles of a and b, or NAN if they did not lose the same particles
+	double distance(const Accelerator &a, const Accelerator &b){
+		if(a.particle_count() != b.particle_count()) return NAN;
+		double d(0.0);
+		for(size_t i(0); i < a.particle_count(); ++i){
+			if(a.getParticle(i).getId() != b.getParticle(i).getId()) return NAN;
+			d = max(d, (a.getParticle(i) - b.getParticle(i)).norm());
+		}
+		return d;
+	}
+}
+
+int main(void){
+	Accelerator none(nullptr, Vector3D(3,2,0));
+	Accelerator full(nullptr, Vector3D(3,2,0));
+	Accelerator mixed(nullptr, Vector3D(3,2,0));
+	run(none, false, Precision::DOUBLE);
+	run(full, true, Precision::DOUBLE);
+	run(mixed, true, Precision::SINGLE);
+
+	const double effect(distance(full, none));
+	const double error(distance(mixed, full));
+	cout << "Particles left: " << none.particle_count() << " without space charge, " << full.particle_count() << " in double precision, " << mixed.particle_count() << " in single precision\n";
+	cout << "Largest displacement due to the space charge: " << effect << " m\n";
+	cout << "Largest distance between single and double precision: " << error << " m\n";
+
+	if(not (effect > 0.0)){
+		cout << "FAILED: the space charge has no effect\n";
+		return 1;
+	}
+	if(not (error < 1e-3*effect)){
+		cout << "FAILED: single-precision interactions are not accurate enough\n";
+		return 1;
+	}
+	cout << "OK\n";
+	return 0;
+}
@@ -10,9 +10,9 @@ INCLUDEPATH += \
 	../../physics \
 
 LIBS += \
+	-L../../physics -lphysics \
 	-L../../color -lcolor \
 	-L../../vector3d -lvector3d \
-	-L../../physics -lphysics \
 
 PRE_TARGETDEPS +=\
 	../../color/libcolor.a \
@@ -21,3 +21,5 @@ PRE_TARGETDEPS +=\
 
 SOURCES += \
 	particle_test.cpp \
+
+include(../../cernjunior.pri)
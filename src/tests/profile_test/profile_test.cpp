@@ -0,0 +1,74 @@
+#include <iostream>
+#include <chrono>
+
+#include "../../physics/accelerator.h"
+
+using namespace std;
+
+// Checks the counters of the profile of evolve against what the accelerator reports after each step, with and
+// without block timesteps and space charge, and that the phases take no more time than the steps themselves.
+
+namespace{
+	const unsigned int PARTICLES(300);
+	const double DT(1e-11);
+	const int STEPS(200);
+
+	int check(unsigned int levels, bool space_charge){
+		Accelerator w(nullptr, Vector3D(3,2,0));
+		cernjunior::build_default_accelerator(w);
+		w.setSeed(6);
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), PARTICLES*1e5, 1e5, 0.01, 0.001);
+		w.setBlock_timesteps(levels, simcst::DEFAULT_MAX_DEFLECTION);
+		w.setSpace_charge(space_charge);
+		w.initialize();
+
+		const size_t initial(w.particle_count());
+		unsigned long present(0); // particles pushed at least once in each step
+		const auto start(chrono::steady_clock::now());
+		for(int i(0); i < STEPS; ++i){
+			w.evolve(DT);
+			present += w.particle_count();
+		}
+		const double wall(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+		const EvolveProfile &profile(w.getProfile());
+
+		cout << "block levels " << levels << (space_charge ? ", space charge" : ", no space charge") << ":\n";
+		profile.print(cout);
+
+		int failures(0);
+		const auto expect([&failures](bool condition, const char* what){
+			if(not condition){
+				cout << "FAILED: " << what << "\n";
+				++failures;
+			}
+		});
+		if(not EvolveProfile::ENABLED){
+			expect(profile.steps == 0 and profile.pushed == 0 and profile.total_seconds() == 0.0, "profile compiled out but not empty");
+			return failures;
+		}
+
+		expect(profile.steps == (unsigned long)(STEPS), "wrong number of steps");
+		expect(levels ? profile.pushed >= present : profile.pushed == present, "wrong number of pushes");
+		expect(profile.lost == initial - w.particle_count(), "wrong number of lost particles");
+		expect(profile.crossings > 0, "no element crossings");
+		expect(space_charge ? profile.nodes > 0 and profile.interactions > 0 : profile.nodes == 0 and profile.interactions == 0,
+		       "wrong space charge counters");
+		for(double s : profile.seconds) expect(s >= 0.0, "negative phase time");
+		expect(profile.seconds[EvolveProfile::PUSH] > 0.0 and profile.total_seconds() <= wall, "phase times beyond the wall time");
+
+		w.clearProfile();
+		expect(w.getProfile().steps == 0 and w.getProfile().total_seconds() == 0.0, "profile not cleared");
+		return failures;
+	}
+}
+
+int main(void){
+	int failures(0);
+	failures += check(0, true);
+	failures += check(3, true);
+	failures += check(0, false);
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+#include "../../snapshot/acceleratorwidgetsnapshot.h"
+#include "../../physics/beam.h"
+#include "../../physics/static_lattice.h"
+
+using namespace std;
+
+// Records a few hundred steps of a beam into a compressed snapshot file, reads it back and checks that every
+// position, velocity and gamma is within the requested error bound, also when a chunk is read out of order.
+// This is done in the default accelerator, whose dipoles have a curvature of 1, in a ring whose dipoles have a
+// curvature of 1/4, and with electrons of 2 GeV, whose velocity is within 4e-8 of c.
+
+namespace{
+	const snapshot::Compression COMPRESSION(1e-6, 1e-8, 16);
+	const int STEPS(300);
+
+	struct Errors{
+		double position = 0.0;
+		double velocity = 0.0;
+		double gamma = 0.0;
+	};
+
+	// largest errors of the particles of decoded with respect to those of original
+	bool compare(const Snapshot &decoded, const Snapshot &original, Errors &errors){
+		if(decoded.size() != original.size()) return false;
+
+		for(size_t i(0); i < decoded.size(); ++i){
+			size_t j(0);
+			while(j < original.size() and original.id[j] != decoded.id[i]) ++j;
+			if(j == original.size()) return false;
+
+			double dx(0.0), dv(0.0);
+			for(int k(0); k < 3; ++k){
+				dx += pow(decoded.real[k][i] - original.real[k][j], 2);
+				dv += pow(decoded.real[3 + k][i] - original.real[3 + k][j], 2);
+			}
+			errors.position = max(errors.position, sqrt(dx));
+			errors.velocity = max(errors.velocity, sqrt(dv));
+			errors.gamma = max(errors.gamma, abs(decoded.real[snapshot::GAMMA - snapshot::X][i] - original.real[snapshot::GAMMA - snapshot::X][j]));
+			if(not (std::isfinite(dx) and std::isfinite(dv))) errors.position = errors.velocity = INFINITY;
+		}
+		return true;
+	}
+
+	// records STEPS steps of the particles fill adds to the lattice build makes, and checks them once read back
+	bool check(const string &name, const Vector3D &origin, function<void(Accelerator&)> build, function<void(Accelerator&)> fill){
+		const string path("snapshot_test.cjs");
+
+		vector<Snapshot> exact;
+		{
+			AcceleratorWidgetSnapshot w(origin, path, snapshot::COMPRESSED, 1, 1, COMPRESSION, snapshot::Overflow::WAIT); // every step is compared
+			build(w);
+			fill(w);
+			w.initialize();
+
+			for(int i(1); i <= STEPS; ++i){
+				w.evolve(1e-11);
+				w.draw();
+
+				// exact copy of what was just captured
+				exact.push_back(Snapshot());
+				exact.back().step = w.getStep();
+				for(size_t j(0); j < w.particle_count(); ++j) exact.back().push_back(w.getParticle(j), 0);
+			}
+			w.getView().close();
+			cout << name << ": committed snapshots: " << w.getView().getCommitted() << " (dropped: " << w.getView().getDropped() << ")\n";
+		}
+
+		SnapshotReader reader(path);
+		Errors errors;
+		size_t compared(0);
+		bool ok(reader.chunk_count() == size_t(STEPS));
+		for(size_t c(0); ok and c < reader.chunk_count(); ++c){
+			const Snapshot decoded(reader.read(c));
+			ok = compare(decoded, exact.at(decoded.step - 1), errors);
+			compared += decoded.size();
+		}
+
+		// random access to a chunk in the middle of a group of predicted chunks
+		Errors again_errors;
+		if(ok){
+			const size_t middle(reader.chunk_count() / 2 + 3);
+			const Snapshot again(reader.read(middle));
+			ok = again.step == reader.chunk_step(middle) and compare(again, exact.at(again.step - 1), again_errors);
+		}
+
+		FILE* f(fopen(path.c_str(), "rb"));
+		fseek(f, 0, SEEK_END);
+		const double compressed_size(ftell(f));
+		fclose(f);
+		remove(path.c_str());
+
+		const double raw_size(compared * (2*sizeof(uint32_t) + snapshot::NUM_REAL_FIELDS*sizeof(double)));
+
+		cout << name << ": compared " << compared << " particle states in " << reader.chunk_count() << " chunks\n";
+		cout << name << ": maximal errors " << errors.position << " m, " << errors.velocity << " c, " << errors.gamma
+		     << " on gamma (bounds " << COMPRESSION.position_error << ", " << COMPRESSION.velocity_error << ")\n";
+		cout << name << ": compression ratio " << raw_size / compressed_size << "\n";
+
+		for(const Errors &e : {errors, again_errors}){
+			ok = ok and e.position <= COMPRESSION.position_error and e.velocity <= COMPRESSION.velocity_error and e.gamma <= COMPRESSION.velocity_error;
+		}
+		if(not ok) cout << "FAILED: " << name << "\n";
+		return ok;
+	}
+}
+
+int main(void){
+	int failures(0);
+
+	failures += not check("default accelerator", Vector3D(3,2,0), cernjunior::build_default_accelerator, [](Accelerator &w){
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), 200, 1.0, 0.1, 0.01);
+	});
+
+	const auto ring([](Accelerator &w){ cernjunior::stable_ring().build(w); });
+	failures += not check("curvature 1/4", Vector3D(6,2,0), ring, [](Accelerator &w){
+		w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), 200, 1.0, 0.01, 0.001);
+	});
+
+	// along the first FODO cell, which they do not leave
+	failures += not check("electrons", Vector3D(6,2,0), ring, [](Accelerator &w){
+		for(int i(0); i < 50; ++i){
+			const array<Vector3D,2> x(w.position_and_trajectory(0.05*i));
+			w.addParticle(Electron(x[0] + Vector3D(0.0001*(i % 7), 0.0, 0.0001*(i % 5)), 2, x[1]));
+		}
+	});
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
@@ -0,0 +1,28 @@
+CONFIG += \
+	    c++11\
+	    console\
+	    thread
+
+CONFIG -= app_bundle
+
+TARGET = snapshot_test.out
+
+INCLUDEPATH += \
+	../../snapshot \
+
+LIBS += \
+	-L../../snapshot -lsnapshot \
+	-L../../physics -lphysics \
+	-L../../color -lcolor \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../snapshot/libsnapshot.a \
+	../../color/libcolor.a \
+	../../vector3d/libvector3d.a \
+	../../physics/libphysics.a \
+
+SOURCES += \
+	snapshot_test.cpp \
+
+include(../../cernjunior.pri)
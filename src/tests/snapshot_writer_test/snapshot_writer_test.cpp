@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cstdio>
+#include <stdexcept>
+
+#include "../../snapshot/snapshot.h"
+#include "../../misc/exceptions.h"
+
+using namespace std;
+
+// Commits large snapshots to a SnapshotWriter faster than the disk takes them: with snapshot::Overflow::WAIT, every
+// one of them must be in the file, in order and intact; with snapshot::Overflow::DROP, the ones in the file and the
+// ones counted as dropped must add up, DROP being the default. Committing to a closed writer must throw.
+
+namespace{
+	const string PATH("snapshot_writer_test.cjs");
+	const unsigned long FRAMES(40);
+	const size_t PARTICLES(50000);
+
+	int failures(0);
+
+	void check(bool condition, const string &what){
+		if(condition) return;
+		cout << "FAILED: " << what << "\n";
+		++failures;
+	}
+
+	void fill(Snapshot &s, unsigned long step){
+		s.step = step;
+		s.time = 1e-11*step;
+		for(size_t i(0); i < PARTICLES; ++i){
+			s.id.push_back(i);
+			s.element.push_back(step);
+			for(auto &column : s.real) column.push_back(step + 1e-6*i);
+		}
+	}
+
+	// the chunks must be in order, with the data they were committed with
+	void check_file(unsigned long expected, const string &policy){
+		SnapshotReader reader(PATH);
+		check(reader.chunk_count() == expected, policy + ": " + to_string(reader.chunk_count()) + " chunks instead of " + to_string(expected));
+		unsigned long last(0);
+		for(size_t c(0); c < reader.chunk_count(); ++c){
+			const Snapshot s(reader.read(c));
+			check(c == 0 or s.step > last, policy + ": chunks out of order");
+			check(s.size() == PARTICLES and s.element.back() == s.step and s.real[0].back() == s.step + 1e-6*(PARTICLES - 1), policy + ": chunk " + to_string(c) + " differs");
+			last = s.step;
+		}
+	}
+}
+
+int main(void){
+	{
+		SnapshotWriter writer(PATH, 0, 1, 1, snapshot::Compression(), snapshot::Overflow::WAIT);
+		for(unsigned long step(1); step <= FRAMES; ++step){
+			fill(writer.frame(), step);
+			writer.commit();
+		}
+		writer.close();
+		cout << "wait: " << writer.getCommitted() << " committed, " << writer.getWaits() << " waits\n";
+		check(writer.getCommitted() == FRAMES and writer.getDropped() == 0, "snapshots are lost with Overflow::WAIT");
+		check_file(FRAMES, "wait");
+
+		bool thrown(false);
+		try{
+			writer.commit();
+		}catch(const logic_error &e){
+			thrown = e.what() == string(excptn::SNAPSHOT_WRITER_CLOSED.what());
+		}
+		check(thrown, "committing to a closed writer does not throw");
+	}
+
+	{
+		// copying a prepared frame is much faster than encoding and writing it, so the queue must overflow
+		SnapshotWriter writer(PATH); // snapshot::Overflow::DROP by default
+		Snapshot prepared;
+		fill(prepared, 0);
+		for(unsigned long step(1); step <= FRAMES; ++step){
+			Snapshot &s(writer.frame());
+			s = prepared;
+			s.step = step;
+			for(auto &e : s.element) e = step;
+			for(auto &x : s.real[0]) x += step;
+			writer.commit();
+		}
+		writer.close();
+		cout << "drop: " << writer.getCommitted() << " committed, " << writer.getDropped() << " dropped\n";
+		check(writer.getCommitted() + writer.getDropped() == FRAMES and writer.getWaits() == 0, "snapshots unaccounted for with Overflow::DROP");
+		check(writer.getDropped() > 0, "no snapshot dropped with Overflow::DROP, the queue never overflowed");
+		check_file(writer.getCommitted(), "drop");
+	}
+	remove(PATH.c_str());
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
@@ -0,0 +1,25 @@
+CONFIG += \
+	    thread\
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = snapshot_writer_test.out
+
+LIBS += \
+	-L../../snapshot -lsnapshot \
+	-L../../physics -lphysics \
+	-L../../color -lcolor \
+	-L../../vector3d -lvector3d \
+
+PRE_TARGETDEPS +=\
+	../../snapshot/libsnapshot.a \
+	../../color/libcolor.a \
+	../../vector3d/libvector3d.a \
+	../../physics/libphysics.a \
+
+SOURCES += \
+	snapshot_writer_test.cpp \
+
+include(../../cernjunior.pri)
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <chrono>
+
+#include "../../physics/static_lattice.h"
+
+using namespace std;
+
+// Tracks the same beam with the time-stepping engine through a ring declared as a StaticLattice and through
+// its runtime counterpart, which must agree, and reports the time taken by each (only the agreement is checked,
+// the timings being left to the benchmarks).
+
+namespace{
+	const Vector3D ORIGIN(6,2,0);
+	const double DT(1e-11);
+	const int STEPS(2000);
+	const int REPEATS(5); // the best time of a few runs is kept
+
+	double seconds_since(const chrono::steady_clock::time_point &start){
+		return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+
+	// the same beam in a ring of four FODO cells and four sector dipoles, and in its runtime counterpart w
+	void load(cernjunior::DefaultRing &fixed, Accelerator &w){
+		fixed.build(w);
+		w.setSeed(1);
+		w.setSpace_charge(false);
+		w.addGaussianCircularBeam(Proton(ORIGIN, 2, w.getElement(0).getDir()), 200, 1.0, 0.001, 0.0001);
+		w.initialize();
+		fixed.load(w);
+	}
+}
+
+int main(void){
+	int failures(0);
+
+	double runtime(0.0), compile_time(0.0);
+	for(int r(0); r < REPEATS; ++r){
+		cernjunior::DefaultRing fixed(cernjunior::stable_ring());
+		Accelerator w(nullptr, ORIGIN);
+		load(fixed, w);
+
+		auto start(chrono::steady_clock::now());
+		for(int i(0); i < STEPS; ++i) w.evolve(DT);
+		const double t_runtime(seconds_since(start));
+
+		start = chrono::steady_clock::now();
+		for(int i(0); i < STEPS; ++i) fixed.evolve(DT);
+		const double t_compile_time(seconds_since(start));
+
+		runtime = r == 0 ? t_runtime : min(runtime, t_runtime);
+		compile_time = r == 0 ? t_compile_time : min(compile_time, t_compile_time);
+		if(r + 1 < REPEATS) continue;
+
+		cout << "Elements: " << cernjunior::DefaultRing::size() << " static, " << w.element_count() << " at runtime\n";
+		if(w.element_count() != cernjunior::DefaultRing::size()){
+			cout << "FAILED: the static lattice and its runtime counterpart differ\n";
+			++failures;
+		}
+
+		double distance(0.0);
+		size_t misplaced(0);
+		for(size_t k(0); k < min(w.particle_count(), fixed.particle_count()); ++k){
+			distance = max(distance, (w.getParticle(k) - fixed.getParticle(k)).norm());
+			if(w.getParticle(k).getElement() != &w.getElement(fixed.getElement_index(k))) ++misplaced;
+		}
+		cout << "Particles left: " << w.particle_count() << " at runtime, " << fixed.particle_count() << " with the static lattice\n";
+		cout << "Largest distance between the two: " << distance << " m\n";
+		if(w.particle_count() != fixed.particle_count() or misplaced or not (distance < 1e-9)){
+			cout << "FAILED: the static lattice does not track like its runtime counterpart\n";
+			++failures;
+		}
+	}
+
+	cout << "Time for " << STEPS << " steps (best of " << REPEATS << "): " << runtime << " s at runtime, " << compile_time
+		<< " s with the static lattice, i.e. " << runtime/compile_time << " times faster\n";
+
+	Accelerator default_accelerator(nullptr, Vector3D(3,2,0));
+	cernjunior::default_ring().build(default_accelerator);
+	default_accelerator.initialize();
+	if(default_accelerator.getLength() <= 0.0 or default_accelerator.element_count() != cernjunior::DefaultRing::size()){
+		cout << "FAILED: the default ring does not match the default accelerator\n";
+		++failures;
+	}
+
+	if(failures == 0) cout << "OK\n";
+	return failures ? 1 : 0;
+}
@@ -4,3 +4,18 @@ SUBDIRS += \
 	vector3d_test \
 #	particle_test \
 	accelerator_test \
+	snapshot_test \
+	transfer_map_test \
+	block_timestep_test \
+	static_lattice_test \
+	mixed_precision_test \
+	barnes_hut_test \
+	fast_math_test \
+	allocation_test \
+	profile_test \
+	tree_statistics_test \
+	trace_test \
+	triple_buffer_test \
+	batch_config_test \
+	ensemble_test \
+	snapshot_writer_test \
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../physics/accelerator.h"
+#include "../../physics/trace.h"
+
+using namespace std;
+
+// Records the trace of a few steps of the default accelerator and of threads of its own, and checks that nothing
+// is recorded while tracing is off, that each buffer keeps its last events only, that threads started one after
+// the other share a buffer, and that the trace written has the events expected.
+
+namespace{
+	const double DT(1e-11);
+
+	size_t occurrences(const string &text, const string &pattern){
+		size_t n(0);
+		for(size_t i(text.find(pattern)); i != string::npos; i = text.find(pattern, i + 1)) ++n;
+		return n;
+	}
+}
+
+int main(void){
+	int failures(0);
+	const auto expect([&failures](bool condition, const char* what){
+		if(not condition){
+			cout << "FAILED: " << what << "\n";
+			++failures;
+		}
+	});
+
+	Accelerator w(nullptr, Vector3D(3,2,0));
+	cernjunior::build_default_accelerator(w);
+	w.setSeed(7);
+	w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), 100*1e5, 1e5, 0.01, 0.001);
+	w.setBlock_timesteps(2, simcst::DEFAULT_MAX_DEFLECTION);
+	w.initialize();
+
+	w.evolve(DT);
+	expect(not trace::active() and trace::event_count() == 0, "events recorded while tracing is off");
+
+	const int STEPS(10);
+	trace::start();
+	trace::name_thread("main \"thread\"");
+	for(int i(0); i < STEPS; ++i) w.evolve(DT);
+
+	// 4 threads alive at once, of 100 events each, into buffers of 64 events
+	trace::start(64);
+	vector<thread> threads;
+	atomic<int> named(0);
+	for(int t(0); t < 4; ++t){
+		threads.emplace_back([t, &named](){
+			trace::name_thread("thread " + to_string(t));
+			++named;
+			while(named < 4) this_thread::yield(); // so that none of them exits before the others have a buffer
+			for(int i(0); i < 100; ++i) const trace::Scope scope("work", "test", "i", i);
+		});
+	}
+	for(auto &t : threads) t.join();
+	expect(trace::event_count() == 4*64 and trace::overwritten() == 4*36, "wrong bound on the buffers");
+
+	ostringstream kept;
+	trace::write(kept);
+	expect(occurrences(kept.str(), "\"work\"") == 4*64 and kept.str().find("\"i\":35}") == string::npos
+	       and kept.str().find("\"i\":36}") != string::npos, "wrong events kept");
+
+	// 10 threads one after the other, each taking over the buffer of the previous one
+	trace::start(64);
+	for(int t(0); t < 10; ++t){
+		thread([](){ for(int i(0); i < 100; ++i) const trace::Scope scope("reuse", "test", "i", i); }).join();
+	}
+	expect(trace::event_count() == 64 and trace::overwritten() == 10*100 - 64, "the buffers of exited threads are not reused");
+
+	// the steps of the accelerator, the buffers being cleared by start()
+	trace::start();
+	for(int i(0); i < STEPS; ++i) w.evolve(DT);
+	trace::stop();
+	w.evolve(DT);
+
+	ostringstream output;
+	trace::write(output);
+	const string json(output.str());
+	cout << trace::event_count() << " events, " << json.size() << " bytes\n";
+
+	expect(json.compare(0, 38, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":") == 0 and json.compare(json.size() - 4, 4, "\n]}\n") == 0, "not a trace");
+	expect(occurrences(json, "\"evolve\",\"cat\"") == size_t(STEPS), "wrong number of steps");
+	for(const char* phase : {"element reset", "collisions", "tree insertion", "push"}){
+		expect(occurrences(json, string("\"") + phase + "\"") == size_t(STEPS), "wrong number of phases");
+	}
+	expect(occurrences(json, "\"force pass\"") >= size_t(STEPS), "no force passes");
+	expect(json.find("\"main \\\"thread\\\"\"") != string::npos and json.find("\"thread 3\"") != string::npos, "thread names missing");
+	expect(occurrences(json, "{") == occurrences(json, "}"), "unbalanced braces");
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
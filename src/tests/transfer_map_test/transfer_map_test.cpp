@@ -0,0 +1,152 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "../../physics/static_lattice.h"
+
+using namespace std;
+
+// Computes the linear optics of a ring made of four FODO cells and four sector dipoles, then tracks a
+// slightly offset proton for one turn with the time-stepping engine and compares it with the one-turn map.
+// The offset is measured against a proton launched on the ideal orbit, which cancels most of the
+// integration error of the time-stepping engine. The same comparison is made with the element-wise engines.
+// Each FODO cell is compiled into a single element (see Accelerator::compile), which all the engines must cross alike.
+
+namespace{
+	// same layout as the default accelerator, with weaker dipoles (see cernjunior::stable_ring)
+	void build(Accelerator &w){ cernjunior::stable_ring().build(w); }
+
+	// coordinates of the only particle of w when it comes back to the origin, interpolated between two steps
+	PhaseSpaceVector one_turn(Accelerator &w, const ReferenceParticle &reference, double dt){
+		const Element* first(&w.getElement(0));
+		const Element* last(&w.getElement(w.element_count() - 1));
+		bool has_left(false);
+
+		PhaseSpaceVector before;
+		double s_before(0.0);
+		while(not w.is_empty()){
+			const Particle &p(w.getParticle(0));
+			if(p.getElement() == last){
+				before = LinearOptics::phase_coordinates(p, reference);
+				s_before = last->curvilinear_coord(p) - last->getLength();
+				has_left = true;
+			}
+
+			w.evolve(dt);
+
+			if(has_left and w.particle_count() and w.getParticle(0).getElement() == first){
+				const PhaseSpaceVector after(LinearOptics::phase_coordinates(w.getParticle(0), reference));
+				const double s_after(first->curvilinear_coord(w.getParticle(0)));
+				const double a(-s_before/(s_after - s_before));
+
+				PhaseSpaceVector X;
+				for(int i(0); i < 6; ++i) X[i] = before[i] + a*(after[i] - before[i]);
+				return X;
+			}
+		}
+		return {NAN, NAN, NAN, NAN, NAN, NAN};
+	}
+
+	PhaseSpaceVector one_turn(const Vector3D &offset, const ReferenceParticle &reference){
+		Accelerator w(nullptr, Vector3D(6,2,0));
+		build(w);
+		w.addParticle(Proton(w.getOrigin() + offset, 2, w.getElement(0).getDir()));
+		w.setSpace_charge(false);
+		w.initialize();
+		return one_turn(w, reference, 1e-13); // steps straddling element boundaries give an error of first order in dt
+	}
+
+	// with the analytic element-wise engine if steps is zero, with the s-based engine otherwise
+	PhaseSpaceVector one_turn_element_wise(const Vector3D &offset, const ReferenceParticle &reference, unsigned int steps = 0){
+		Accelerator w(nullptr, Vector3D(6,2,0));
+		build(w);
+		w.addParticle(Proton(w.getOrigin() + offset, 2, w.getElement(0).getDir()));
+		w.setSpace_charge(false);
+		w.initialize();
+
+		if(steps) w.integrate(w.element_count(), steps);
+		else w.track(w.element_count());
+		if(w.is_empty()) return {NAN, NAN, NAN, NAN, NAN, NAN};
+		return LinearOptics::phase_coordinates(w.getParticle(0), reference);
+	}
+}
+
+int main(void){
+	Accelerator w(nullptr, Vector3D(6,2,0));
+	build(w);
+	w.initialize();
+
+	const Vector3D normal(vctr::Z_VECTOR ^ w.getElement(0).getDir());
+	const Vector3D offset(0.001*normal + 0.0005*vctr::Z_VECTOR);
+	const Proton model(w.getOrigin(), 2, w.getElement(0).getDir());
+	const ReferenceParticle reference(model);
+	cout << "Rigidity: " << reference.rigidity() << " T.m\n";
+
+	const LinearOptics optics(w, reference);
+	cout << "One-turn map:\n" << optics.getOne_turn_map();
+
+	const array<double,2> tunes(optics.tunes());
+	const Twiss tx(optics.periodic_twiss(0));
+	const Twiss ty(optics.periodic_twiss(1));
+	cout << "Tunes: " << tunes[0] << " " << tunes[1] << "\n";
+	cout << "Beta functions at the origin: " << tx.beta << " " << ty.beta << "\n";
+
+	int failures(0);
+	cout << "Elements after compilation: " << w.element_count() << "\n";
+	if(w.element_count() != 8){
+		cout << "FAILED: expected each FODO cell to be compiled into a single element\n";
+		++failures;
+	}
+
+	for(int plane(0); plane < 2; ++plane){
+		const TransferMap &M(optics.getOne_turn_map());
+		const double det(M(2*plane,2*plane)*M(2*plane+1,2*plane+1) - M(2*plane,2*plane+1)*M(2*plane+1,2*plane));
+		if(abs(det - 1.0) > 1e-9){
+			cout << "FAILED: the one-turn map is not symplectic in plane " << plane << " (det = " << det << ")\n";
+			++failures;
+		}
+	}
+
+	const PhaseSpaceVector start = {offset|normal, 0.0, offset[2], 0.0, 0.0, 0.0};
+	const PhaseSpaceVector predicted(optics.getOne_turn_map() * start);
+
+	const PhaseSpaceVector on_orbit(one_turn(vctr::ZERO_VECTOR, reference));
+	PhaseSpaceVector tracked(one_turn(offset, reference));
+	for(int i(0); i < 6; ++i) tracked[i] -= on_orbit[i];
+
+	const PhaseSpaceVector on_orbit_element_wise(one_turn_element_wise(vctr::ZERO_VECTOR, reference));
+	PhaseSpaceVector element_wise(one_turn_element_wise(offset, reference));
+	for(int i(0); i < 6; ++i) element_wise[i] -= on_orbit_element_wise[i];
+
+	const PhaseSpaceVector on_orbit_s_based(one_turn_element_wise(vctr::ZERO_VECTOR, reference, 20));
+	PhaseSpaceVector s_based(one_turn_element_wise(offset, reference, 20));
+	for(int i(0); i < 6; ++i) s_based[i] -= on_orbit_s_based[i];
+
+	cout << "coordinate    start    one-turn map    time-stepping    element-wise    s-based\n";
+	const char* names[4] = {"x", "x'", "y", "y'"};
+	for(int i(0); i < 4; ++i){
+		cout << names[i] << "\t" << start[i] << "\t" << predicted[i] << "\t" << tracked[i] << "\t" << element_wise[i] << "\t" << s_based[i] << "\n";
+	}
+	cout << "Closed orbit error of the element-wise engine: " << on_orbit_element_wise[0] << " " << on_orbit_element_wise[1] << "\n";
+
+	// the time-stepping engine is not linear and has its own discretization error
+	for(int plane(0); plane < 2; ++plane){
+		const double amplitude(abs(start[2*plane]));
+		if(not (abs(predicted[2*plane] - tracked[2*plane]) < 0.03*amplitude)){
+			cout << "FAILED: the one-turn map and the time-stepping engine disagree in plane " << plane << "\n";
+			++failures;
+		}
+		if(not (abs(predicted[2*plane] - element_wise[2*plane]) < 0.01*amplitude)){
+			cout << "FAILED: the one-turn map and the element-wise engine disagree in plane " << plane << "\n";
+			++failures;
+		}
+		if(not (abs(predicted[2*plane] - s_based[2*plane]) < 0.01*amplitude)){
+			cout << "FAILED: the one-turn map and the s-based engine disagree in plane " << plane << "\n";
+			++failures;
+		}
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
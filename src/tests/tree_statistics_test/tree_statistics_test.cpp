@@ -0,0 +1,69 @@
+#include <iostream>
+#include <cmath>
+
+#include "../../physics/accelerator.h"
+
+using namespace std;
+
+// Checks the statistics of a tree of two particles against those worked out by hand, and the consistency of the
+// statistics of the trees of the default accelerator (every internal node has 8 children, each particle is a leaf
+// of at most one tree, the trees of the elements add up to the whole).
+
+namespace{
+	const unsigned int PARTICLES(300);
+	const double DT(1e-11);
+	const int STEPS(50);
+
+	int failures(0);
+
+	void expect(bool condition, const char* what){
+		if(not condition){
+			cout << "FAILED: " << what << "\n";
+			++failures;
+		}
+	}
+}
+
+int main(void){
+	// two protons in opposite octants of a cube of side 2
+	NodePool pool;
+	Node root(Box(nullptr, vctr::ZERO_VECTOR, vctr::X_VECTOR, 1.0));
+	root.setPool(&pool);
+	Proton a(Vector3D(0.5, 0.5, 0.5), 2, vctr::X_VECTOR);
+	Proton b(Vector3D(-0.5, -0.5, -0.5), 2, vctr::X_VECTOR);
+	root.insert(&a);
+	root.insert(&b);
+
+	TreeStatistics s;
+	root.statistics(s);
+	expect(s.internal == 1 and s.leaves == 2 and s.empty == 6 and s.max_depth() == 1 and s.depths[1] == 8, "wrong tree of two particles");
+	expect(s.bytes == 9*sizeof(Node) and abs(s.occupancy() - 0.25) < 1e-15 and abs(s.imbalance() - 0.5) < 1e-15, "wrong statistics of two particles");
+
+	// the trees of the default accelerator
+	Accelerator w(nullptr, Vector3D(3,2,0));
+	cernjunior::build_default_accelerator(w);
+	w.setSeed(9);
+	w.addGaussianCircularBeam(Proton(Vector3D(), 2, Vector3D(1,0,0)), PARTICLES*1e5, 1e5, 0.01, 0.001);
+	w.initialize();
+	for(int i(0); i < STEPS; ++i) w.evolve(DT);
+
+	const TreeStatistics all(w.tree_statistics());
+	all.print(cout);
+
+	size_t by_depth(0);
+	for(size_t n : all.depths) by_depth += n;
+	TreeStatistics merged;
+	for(size_t i(0); i < w.element_count(); ++i) merged.merge(w.tree_statistics(i));
+
+	expect(all.trees == w.element_count() and all.nodes() == all.trees + 8*all.internal and by_depth == all.nodes(), "wrong node counts");
+	expect(all.bytes == all.nodes()*sizeof(Node), "wrong memory footprint");
+	expect(all.leaves <= all.particles and all.particles == w.particle_count(), "more leaves than particles");
+	expect(all.imbalance() >= 0.125 and all.imbalance() <= 1.0, "imbalance out of range");
+	expect(merged.nodes() == all.nodes() and merged.leaves == all.leaves and merged.max_depth() == all.max_depth()
+	       and abs(merged.imbalance() - all.imbalance()) < 1e-12, "the trees of the elements do not add up");
+	if(EvolveProfile::ENABLED) expect(all.opened_per_particle > 0.0 and all.interactions_per_particle >= 1.0, "no cost per particle");
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
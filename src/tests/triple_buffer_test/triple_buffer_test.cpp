@@ -0,0 +1,98 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../../general/triple_buffer.h"
+
+using namespace std;
+
+// Checks the hand-over of TripleBuffer: on a single thread, the reader only sees published values, and the last one;
+// with a writer thread filling frames, the reader never sees a frame half written nor an older frame than the one it
+// saw before, and eventually sees the last one. The writer is kept at most LAG frames ahead of the reader, so that
+// the two really do hand frames over (a writer left alone publishes everything before the reader takes a single
+// frame), while still overwriting frames the reader has not taken.
+
+namespace{
+	const unsigned long FRAMES(20000);
+	const unsigned long LAG(3);
+	const unsigned long MIN_SEEN(FRAMES/(2*LAG)); // at least one frame in every LAG, with a margin
+	const size_t FRAME_SIZE(64);
+
+	// as SceneFrame: the buffers are recycled, each value being written over the one of two publications ago
+	struct Frame{
+		unsigned long step = 0;
+		vector<unsigned long> values;
+	};
+
+	void fill(Frame &frame, unsigned long step){
+		frame.step = step;
+		frame.values.assign(FRAME_SIZE, step);
+	}
+
+	bool consistent(const Frame &frame){
+		if(frame.step == 0) return frame.values.empty();
+		if(frame.values.size() != FRAME_SIZE) return false;
+		for(unsigned long v : frame.values) if(v != frame.step) return false;
+		return true;
+	}
+}
+
+int main(void){
+	int failures(0);
+
+	{
+		TripleBuffer<Frame> frames;
+		if(frames.update() or frames.read_buffer().step != 0){
+			cout << "FAILED: a value is read before any was published\n";
+			++failures;
+		}
+		for(unsigned long step(1); step <= 3; ++step){
+			fill(frames.write_buffer(), step);
+			frames.publish();
+		}
+		if(not frames.update() or frames.read_buffer().step != 3 or frames.update() or frames.read_buffer().step != 3){
+			cout << "FAILED: the reader does not keep the last value published\n";
+			++failures;
+		}
+	}
+
+	TripleBuffer<Frame> frames;
+	atomic<unsigned long> taken(0); // last step seen by the reader
+	thread writer([&frames, &taken]{
+		for(unsigned long step(1); step <= FRAMES; ++step){
+			while(step > taken.load() + LAG) this_thread::yield();
+			fill(frames.write_buffer(), step);
+			frames.publish();
+		}
+	});
+
+	unsigned long last(0), seen(0), torn(0), backwards(0);
+	while(last < FRAMES){
+		if(not frames.update()){
+			this_thread::yield();
+			continue;
+		}
+		const Frame &frame(frames.read_buffer());
+		if(not consistent(frame)) ++torn;
+		if(frame.step <= last) ++backwards;
+		last = frame.step;
+		taken.store(last);
+		++seen;
+	}
+	writer.join();
+
+	cout << seen << " of " << FRAMES << " frames seen, " << torn << " inconsistent, " << backwards << " out of order\n";
+	if(torn or backwards){
+		cout << "FAILED: the reader saw a frame being written\n";
+		++failures;
+	}
+	if(seen < MIN_SEEN){
+		cout << "FAILED: fewer than " << MIN_SEEN << " frames seen, too few to check the hand-over\n";
+		++failures;
+	}
+
+	if(failures) return 1;
+	cout << "OK\n";
+	return 0;
+}
@@ -0,0 +1,13 @@
+CONFIG += \
+	    thread\
+	    c++11\
+	    console
+
+CONFIG -= app_bundle
+
+TARGET = triple_buffer_test.out
+
+SOURCES += \
+	triple_buffer_test.cpp \
+
+include(../../cernjunior.pri)
@@ -29,5 +29,33 @@ int main(void){
 	cout << "\n   u.(v^w) = " << Vector3D::mixed_prod(u,v,w);
 	cout << "\n   An orthogonal unit vector to u is " << u.orthogonal();
 
+	// the algebra is constexpr
+	constexpr Vector3D a(1.0, 2.0, 3.0);
+	static_assert(((a ^ vctr::X_VECTOR)|a) == 0.0, "cross product not orthogonal");
+	static_assert((2.0*a - a)[2] == 3.0, "wrong scalar multiplication");
+
+	// degenerate cases are reported without exceptions, except by unitary()
+	static_assert(noexcept(a.unitary_or(a)) and noexcept(a.rotated(a, 1.0)) and noexcept(a.orthogonal()), "the algebra may throw");
+	if(vctr::ZERO_VECTOR.unitary_or(vctr::X_VECTOR) != vctr::X_VECTOR or u.rotated(vctr::ZERO_VECTOR, 1.0) != u){
+		cout << "\nFAILED: wrong degenerate case\n";
+		return 1;
+	}
+
+	// a batch gives the same results as the vectors it holds
+	Vector3DBatch<double,4> U, V;
+	const Vector3D us[4] = {u, v, w, u+w};
+	for(size_t i(0); i < 4; ++i){
+		U.set(i, us[i]);
+		V.set(i, us[(i+1) % 4]);
+	}
+	const Vector3DBatch<double,4> cross(U ^ V);
+	const Vector3DBatch<double,4>::Scalars dots(U | (V*0.5));
+	bool same(true);
+	for(size_t i(0); i < 4; ++i){
+		same = same and cross.get(i) == (us[i] ^ us[(i+1) % 4]) and dots[i] == (us[i] | (0.5*us[(i+1) % 4]));
+	}
+	cout << "\n   Batch of " << U.width() << " vectors: " << (same ? "same" : "DIFFERENT") << " results";
+
 	cout << "\n\n";
+	return same ? 0 : 1;
 }
@@ -17,3 +17,5 @@ PRE_TARGETDEPS +=\
 
 SOURCES += \
 	vector3d_test.cpp \
+
+include(../../cernjunior.pri)
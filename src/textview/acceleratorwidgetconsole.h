@@ -10,4 +10,6 @@ class AcceleratorWidgetConsole : public Accelerator{
 		AcceleratorWidgetConsole(Vector3D origin) : Accelerator(new TextView(std::cout), origin){ std::cout << "\n"; }
 
 		void show(void){ print(std::cout, true); }
+		void show_profile(void){ profile.print(std::cout); } // where the time of evolve() went so far
+		void show_trees(void){ tree_statistics().print(std::cout); } // as built by the last step
 };
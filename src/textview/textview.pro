@@ -12,3 +12,5 @@ SOURCES += \
 HEADERS += \
 	textview.h \
 	acceleratorwidgetconsole.h \
+
+include(../cernjunior.pri)
@@ -0,0 +1,300 @@
+#include <cmath>
+
+#include "fast_math.h"
+#include "../misc/exceptions.h"
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define FASTMATH_X86
+#include <immintrin.h>
+#endif
+
+namespace fastmath{
+	std::atomic<Kernel> detail::selection(Kernel::LIBM);
+
+#ifdef FASTMATH_X86
+	namespace{
+		// the processor is queried once, since the functions on arrays check the kernel at every call
+		bool cpu_supports_avx2(void) noexcept{
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+		}
+		bool cpu_supports_avx512(void) noexcept{
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f");
+		}
+		const bool AVX2_SUPPORTED(cpu_supports_avx2());
+		const bool AVX512_SUPPORTED(cpu_supports_avx512());
+	}
+#endif
+
+	bool supported(Kernel k) noexcept{
+		switch(k){
+			case Kernel::LIBM:
+			case Kernel::SCALAR:
+				return true;
+#ifdef FASTMATH_X86
+			case Kernel::AVX2:
+				return AVX2_SUPPORTED;
+			case Kernel::AVX512:
+				return AVX512_SUPPORTED;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	Kernel best(void) noexcept{
+		if(supported(Kernel::AVX512)) return Kernel::AVX512;
+		if(supported(Kernel::AVX2)) return Kernel::AVX2;
+		return Kernel::SCALAR;
+	}
+
+	void select(Kernel k){
+		if(not supported(k)) throw excptn::UNSUPPORTED_MATH_KERNEL;
+		detail::selection.store(k, std::memory_order_relaxed);
+	}
+
+	const char* name(Kernel k) noexcept{
+		switch(k){
+			case Kernel::LIBM: return "libm";
+			case Kernel::SCALAR: return "scalar";
+			case Kernel::AVX2: return "avx2";
+			case Kernel::AVX512: return "avx512";
+		}
+		return "";
+	}
+
+	Kernel find(const std::string &name){
+		if(name == "fast") return best();
+		for(Kernel k : {Kernel::LIBM, Kernel::SCALAR, Kernel::AVX2, Kernel::AVX512}){
+			if(name == fastmath::name(k)) return k;
+		}
+		throw excptn::UNKNOWN_MATH_KERNEL;
+	}
+
+	// the vector kernels follow the scalar approximations operation by operation (up to the contraction of some
+	// products and sums into fused multiply-adds), and leave the values out of their range to them
+	namespace{
+		void inverse_cube_libm(const double* x, double* y, size_t n){ for(size_t i(0); i < n; ++i) y[i] = 1.0/std::pow(x[i], 1.5); }
+		void inverse_cube_scalar(const double* x, double* y, size_t n){ for(size_t i(0); i < n; ++i) y[i] = approx::inverse_cube(x[i]); }
+
+		void sincos_libm(const double* x, double* s, double* c, size_t n){
+			for(size_t i(0); i < n; ++i){
+				s[i] = std::sin(x[i]);
+				c[i] = std::cos(x[i]);
+			}
+		}
+		void sincos_scalar(const double* x, double* s, double* c, size_t n){ for(size_t i(0); i < n; ++i) approx::sincos(x[i], s[i], c[i]); }
+
+		void asin_libm(const double* x, double* y, size_t n){ for(size_t i(0); i < n; ++i) y[i] = std::asin(x[i]); }
+		void asin_scalar(const double* x, double* y, size_t n){ for(size_t i(0); i < n; ++i) y[i] = approx::asin(x[i]); }
+
+#ifdef FASTMATH_X86
+		// AVX2, 4 values at a time
+		__attribute__((target("avx2"))) inline __m256d polynomial_avx2(__m256d z, std::initializer_list<double> coefficients){
+			// Horner's scheme, from the highest degree
+			const double* a(coefficients.end());
+			__m256d p(_mm256_set1_pd(*--a));
+			while(a != coefficients.begin()) p = _mm256_add_pd(_mm256_set1_pd(*--a), _mm256_mul_pd(z, p));
+			return p;
+		}
+
+		__attribute__((target("avx2"))) void inverse_cube_avx2(const double* x, double* y, size_t n){
+			const __m256d half(_mm256_set1_pd(0.5)), three_halves(_mm256_set1_pd(1.5));
+			const __m256d lowest(_mm256_set1_pd(DBL_MIN)), highest(_mm256_set1_pd(DBL_MAX));
+			const __m256i magic(_mm256_set1_epi64x(detail::RSQRT_MAGIC));
+			size_t i(0);
+			for(; i + 4 <= n; i += 4){
+				const __m256d X(_mm256_loadu_pd(x + i));
+				const __m256d h(_mm256_mul_pd(half, X));
+				__m256d Y(_mm256_castsi256_pd(_mm256_sub_epi64(magic, _mm256_srli_epi64(_mm256_castpd_si256(X), 1))));
+				for(int k(0); k < 4; ++k) Y = _mm256_mul_pd(Y, _mm256_sub_pd(three_halves, _mm256_mul_pd(_mm256_mul_pd(h, Y), Y)));
+				_mm256_storeu_pd(y + i, _mm256_mul_pd(_mm256_mul_pd(Y, Y), Y));
+
+				const __m256d in_range(_mm256_and_pd(_mm256_cmp_pd(X, lowest, _CMP_GE_OQ), _mm256_cmp_pd(X, highest, _CMP_LE_OQ)));
+				if(_mm256_movemask_pd(in_range) != 0xF) inverse_cube_scalar(x + i, y + i, 4);
+			}
+			inverse_cube_scalar(x + i, y + i, n - i);
+		}
+
+		__attribute__((target("avx2"))) void sincos_avx2(const double* x, double* s, double* c, size_t n){
+			const __m256d sign(_mm256_set1_pd(-0.0)), range(_mm256_set1_pd(SINCOS_RANGE));
+			const __m256d shifter(_mm256_set1_pd(detail::SHIFTER)), two_over_pi(_mm256_set1_pd(detail::TWO_OVER_PI));
+			const __m256d pio2_1(_mm256_set1_pd(detail::PIO2_1)), pio2_2(_mm256_set1_pd(detail::PIO2_2)), pio2_3(_mm256_set1_pd(detail::PIO2_3));
+			const __m256d one(_mm256_set1_pd(1.0)), half(_mm256_set1_pd(0.5));
+			const __m256i one_i(_mm256_set1_epi64x(1)), two_i(_mm256_set1_epi64x(2));
+			size_t i(0);
+			for(; i + 4 <= n; i += 4){
+				const __m256d X(_mm256_loadu_pd(x + i));
+				const __m256d t(_mm256_add_pd(_mm256_mul_pd(X, two_over_pi), shifter));
+				const __m256d N(_mm256_sub_pd(t, shifter));
+				__m256d r(_mm256_sub_pd(X, _mm256_mul_pd(N, pio2_1)));
+				r = _mm256_sub_pd(r, _mm256_mul_pd(N, pio2_2));
+				r = _mm256_sub_pd(r, _mm256_mul_pd(N, pio2_3));
+				const __m256d z(_mm256_mul_pd(r, r));
+
+				const __m256d sr(_mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, z), polynomial_avx2(z, {detail::S1, detail::S2, detail::S3, detail::S4, detail::S5, detail::S6}))));
+				const __m256d cr(_mm256_add_pd(_mm256_sub_pd(one, _mm256_mul_pd(half, z)), _mm256_mul_pd(_mm256_mul_pd(z, z), polynomial_avx2(z, {detail::C1, detail::C2, detail::C3, detail::C4, detail::C5, detail::C6}))));
+
+				const __m256i q(_mm256_castpd_si256(t));
+				const __m256d swap(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, one_i), one_i)));
+				const __m256d negate_s(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, two_i), two_i)));
+				const __m256d negate_c(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(q, one_i), two_i), two_i)));
+				_mm256_storeu_pd(s + i, _mm256_xor_pd(_mm256_blendv_pd(sr, cr, swap), _mm256_and_pd(negate_s, sign)));
+				_mm256_storeu_pd(c + i, _mm256_xor_pd(_mm256_blendv_pd(cr, sr, swap), _mm256_and_pd(negate_c, sign)));
+
+				const __m256d in_range(_mm256_cmp_pd(_mm256_andnot_pd(sign, X), range, _CMP_LE_OQ));
+				if(_mm256_movemask_pd(in_range) != 0xF) sincos_scalar(x + i, s + i, c + i, 4);
+			}
+			sincos_scalar(x + i, s + i, c + i, n - i);
+		}
+
+		__attribute__((target("avx2"))) void asin_avx2(const double* x, double* y, size_t n){
+			const __m256d sign(_mm256_set1_pd(-0.0)), half(_mm256_set1_pd(0.5)), one(_mm256_set1_pd(1.0)), two(_mm256_set1_pd(2.0));
+			const __m256d pio2(_mm256_set1_pd(detail::PIO2));
+			size_t i(0);
+			for(; i + 4 <= n; i += 4){
+				const __m256d X(_mm256_loadu_pd(x + i));
+				const __m256d a(_mm256_andnot_pd(sign, X));
+				const __m256d small(_mm256_cmp_pd(a, half, _CMP_LE_OQ));
+				const __m256d z(_mm256_blendv_pd(_mm256_mul_pd(half, _mm256_sub_pd(one, a)), _mm256_mul_pd(X, X), small));
+
+				const __m256d numerator(_mm256_mul_pd(z, polynomial_avx2(z, {detail::P0, detail::P1, detail::P2, detail::P3, detail::P4, detail::P5})));
+				const __m256d denominator(_mm256_add_pd(one, _mm256_mul_pd(z, polynomial_avx2(z, {detail::Q1, detail::Q2, detail::Q3, detail::Q4}))));
+				const __m256d R(_mm256_div_pd(numerator, denominator));
+
+				const __m256d near_zero(_mm256_add_pd(X, _mm256_mul_pd(X, R)));
+				const __m256d root(_mm256_sqrt_pd(z));
+				const __m256d far(_mm256_sub_pd(pio2, _mm256_mul_pd(two, _mm256_add_pd(root, _mm256_mul_pd(root, R)))));
+				const __m256d signed_far(_mm256_or_pd(_mm256_andnot_pd(sign, far), _mm256_and_pd(sign, X)));
+				_mm256_storeu_pd(y + i, _mm256_blendv_pd(signed_far, near_zero, small));
+			}
+			asin_scalar(x + i, y + i, n - i);
+		}
+
+		// AVX-512, 8 values at a time (the intrinsics of some versions of GCC start from undefined registers, which -Wall reports)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+		__attribute__((target("avx512f"))) inline __m512d polynomial_avx512(__m512d z, std::initializer_list<double> coefficients){
+			const double* a(coefficients.end());
+			__m512d p(_mm512_set1_pd(*--a));
+			while(a != coefficients.begin()) p = _mm512_add_pd(_mm512_set1_pd(*--a), _mm512_mul_pd(z, p));
+			return p;
+		}
+
+		__attribute__((target("avx512f"))) void inverse_cube_avx512(const double* x, double* y, size_t n){
+			const __m512d half(_mm512_set1_pd(0.5)), three_halves(_mm512_set1_pd(1.5));
+			const __m512d lowest(_mm512_set1_pd(DBL_MIN)), highest(_mm512_set1_pd(DBL_MAX));
+			const __m512i magic(_mm512_set1_epi64(detail::RSQRT_MAGIC));
+			size_t i(0);
+			for(; i + 8 <= n; i += 8){
+				const __m512d X(_mm512_loadu_pd(x + i));
+				const __m512d h(_mm512_mul_pd(half, X));
+				__m512d Y(_mm512_castsi512_pd(_mm512_sub_epi64(magic, _mm512_srli_epi64(_mm512_castpd_si512(X), 1))));
+				for(int k(0); k < 4; ++k) Y = _mm512_mul_pd(Y, _mm512_sub_pd(three_halves, _mm512_mul_pd(_mm512_mul_pd(h, Y), Y)));
+				_mm512_storeu_pd(y + i, _mm512_mul_pd(_mm512_mul_pd(Y, Y), Y));
+
+				const __mmask8 in_range(_mm512_cmp_pd_mask(X, lowest, _CMP_GE_OQ) & _mm512_cmp_pd_mask(X, highest, _CMP_LE_OQ));
+				if(in_range != 0xFF) inverse_cube_scalar(x + i, y + i, 8);
+			}
+			inverse_cube_scalar(x + i, y + i, n - i);
+		}
+
+		__attribute__((target("avx512f"))) void sincos_avx512(const double* x, double* s, double* c, size_t n){
+			const __m512i sign(_mm512_set1_epi64(INT64_MIN));
+			const __m512d range(_mm512_set1_pd(SINCOS_RANGE));
+			const __m512d shifter(_mm512_set1_pd(detail::SHIFTER)), two_over_pi(_mm512_set1_pd(detail::TWO_OVER_PI));
+			const __m512d pio2_1(_mm512_set1_pd(detail::PIO2_1)), pio2_2(_mm512_set1_pd(detail::PIO2_2)), pio2_3(_mm512_set1_pd(detail::PIO2_3));
+			const __m512d one(_mm512_set1_pd(1.0)), half(_mm512_set1_pd(0.5));
+			const __m512i one_i(_mm512_set1_epi64(1)), two_i(_mm512_set1_epi64(2));
+			size_t i(0);
+			for(; i + 8 <= n; i += 8){
+				const __m512d X(_mm512_loadu_pd(x + i));
+				const __m512d t(_mm512_add_pd(_mm512_mul_pd(X, two_over_pi), shifter));
+				const __m512d N(_mm512_sub_pd(t, shifter));
+				__m512d r(_mm512_sub_pd(X, _mm512_mul_pd(N, pio2_1)));
+				r = _mm512_sub_pd(r, _mm512_mul_pd(N, pio2_2));
+				r = _mm512_sub_pd(r, _mm512_mul_pd(N, pio2_3));
+				const __m512d z(_mm512_mul_pd(r, r));
+
+				const __m512d sr(_mm512_add_pd(r, _mm512_mul_pd(_mm512_mul_pd(r, z), polynomial_avx512(z, {detail::S1, detail::S2, detail::S3, detail::S4, detail::S5, detail::S6}))));
+				const __m512d cr(_mm512_add_pd(_mm512_sub_pd(one, _mm512_mul_pd(half, z)), _mm512_mul_pd(_mm512_mul_pd(z, z), polynomial_avx512(z, {detail::C1, detail::C2, detail::C3, detail::C4, detail::C5, detail::C6}))));
+
+				const __m512i q(_mm512_castpd_si512(t));
+				const __mmask8 swap(_mm512_test_epi64_mask(q, one_i));
+				const __mmask8 negate_s(_mm512_test_epi64_mask(q, two_i));
+				const __mmask8 negate_c(_mm512_test_epi64_mask(_mm512_add_epi64(q, one_i), two_i));
+				const __m512i S(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, sr, cr)));
+				const __m512i C(_mm512_castpd_si512(_mm512_mask_blend_pd(swap, cr, sr)));
+				_mm512_storeu_pd(s + i, _mm512_castsi512_pd(_mm512_mask_xor_epi64(S, negate_s, S, sign)));
+				_mm512_storeu_pd(c + i, _mm512_castsi512_pd(_mm512_mask_xor_epi64(C, negate_c, C, sign)));
+
+				const __mmask8 in_range(_mm512_cmp_pd_mask(_mm512_abs_pd(X), range, _CMP_LE_OQ));
+				if(in_range != 0xFF) sincos_scalar(x + i, s + i, c + i, 8);
+			}
+			sincos_scalar(x + i, s + i, c + i, n - i);
+		}
+
+		__attribute__((target("avx512f"))) void asin_avx512(const double* x, double* y, size_t n){
+			const __m512i sign(_mm512_set1_epi64(INT64_MIN));
+			const __m512d half(_mm512_set1_pd(0.5)), one(_mm512_set1_pd(1.0)), two(_mm512_set1_pd(2.0));
+			const __m512d pio2(_mm512_set1_pd(detail::PIO2));
+			size_t i(0);
+			for(; i + 8 <= n; i += 8){
+				const __m512d X(_mm512_loadu_pd(x + i));
+				const __m512d a(_mm512_abs_pd(X));
+				const __mmask8 small(_mm512_cmp_pd_mask(a, half, _CMP_LE_OQ));
+				const __m512d z(_mm512_mask_blend_pd(small, _mm512_mul_pd(half, _mm512_sub_pd(one, a)), _mm512_mul_pd(X, X)));
+
+				const __m512d numerator(_mm512_mul_pd(z, polynomial_avx512(z, {detail::P0, detail::P1, detail::P2, detail::P3, detail::P4, detail::P5})));
+				const __m512d denominator(_mm512_add_pd(one, _mm512_mul_pd(z, polynomial_avx512(z, {detail::Q1, detail::Q2, detail::Q3, detail::Q4}))));
+				const __m512d R(_mm512_div_pd(numerator, denominator));
+
+				const __m512d near_zero(_mm512_add_pd(X, _mm512_mul_pd(X, R)));
+				const __m512d root(_mm512_sqrt_pd(z));
+				const __m512d far(_mm512_sub_pd(pio2, _mm512_mul_pd(two, _mm512_add_pd(root, _mm512_mul_pd(root, R)))));
+				const __m512i signed_far(_mm512_or_epi64(_mm512_castpd_si512(far), _mm512_and_epi64(sign, _mm512_castpd_si512(X))));
+				_mm512_storeu_pd(y + i, _mm512_mask_blend_pd(small, _mm512_castsi512_pd(signed_far), near_zero));
+			}
+			asin_scalar(x + i, y + i, n - i);
+		}
+#pragma GCC diagnostic pop
+#endif
+	}
+
+	void inverse_cube(const double* x, double* y, size_t n, Kernel k) noexcept{
+		if(not supported(k)) k = Kernel::SCALAR;
+		switch(k){
+			case Kernel::LIBM: inverse_cube_libm(x, y, n); break;
+#ifdef FASTMATH_X86
+			case Kernel::AVX2: inverse_cube_avx2(x, y, n); break;
+			case Kernel::AVX512: inverse_cube_avx512(x, y, n); break;
+#endif
+			default: inverse_cube_scalar(x, y, n); break;
+		}
+	}
+
+	void sincos(const double* x, double* s, double* c, size_t n, Kernel k) noexcept{
+		if(not supported(k)) k = Kernel::SCALAR;
+		switch(k){
+			case Kernel::LIBM: sincos_libm(x, s, c, n); break;
+#ifdef FASTMATH_X86
+			case Kernel::AVX2: sincos_avx2(x, s, c, n); break;
+			case Kernel::AVX512: sincos_avx512(x, s, c, n); break;
+#endif
+			default: sincos_scalar(x, s, c, n); break;
+		}
+	}
+
+	void asin(const double* x, double* y, size_t n, Kernel k) noexcept{
+		if(not supported(k)) k = Kernel::SCALAR;
+		switch(k){
+			case Kernel::LIBM: asin_libm(x, y, n); break;
+#ifdef FASTMATH_X86
+			case Kernel::AVX2: asin_avx2(x, y, n); break;
+			case Kernel::AVX512: asin_avx512(x, y, n); break;
+#endif
+			default: asin_scalar(x, y, n); break;
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cfloat> // for DBL_MIN, DBL_MAX
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for memcpy
+#include <string>
+
+/*
+ * Approximations of the transcendental functions of the push and force loops: 1/sqrt(x) and x^(-3/2) from an
+ * estimate taken from the bits of x refined by four Newton steps, sin and cos from a reduction to [-pi/4, pi/4]
+ * followed by the polynomials of fdlibm, and asin from the rational approximation of fdlibm. Their errors with
+ * respect to libm are bounded below (and checked by fast_math_test).
+ *
+ * The kernel in use is chosen at runtime for the whole program (see select): LIBM, the default, keeps the
+ * functions of the standard library, so that results do not change unless asked for. The other kernels use the
+ * approximations, element-wise (SCALAR) or on 4 or 8 values at once (AVX2 or AVX-512), which only the functions
+ * on arrays can take advantage of: the space charge in double precision computes its inverse cubes with them, a
+ * batch of interactions at a time (see ForceBatch in physics/node.cpp), while the push takes the scalar ones.
+ */
+namespace fastmath{
+	enum class Kernel : unsigned char { LIBM, SCALAR, AVX2, AVX512 };
+
+	constexpr double RSQRT_ERROR = 1e-15; // relative, for x in [DBL_MIN, DBL_MAX] (libm is used outside)
+	constexpr double INVERSE_CUBE_ERROR = 2e-15; // relative, same range (and not a number for negative x, unlike 1/pow(x, 1.5))
+	constexpr double SINCOS_RANGE = 1.6e6; // |x| up to which the reduction is exact (libm is used beyond)
+	constexpr double SINCOS_ERROR = 1e-15; // absolute
+	constexpr double ASIN_ERROR = 1e-15; // absolute
+
+	namespace detail{
+		extern std::atomic<Kernel> selection;
+
+		constexpr double SHIFTER = 6755399441055744.0; // 1.5*2^52, rounds what is added to it to an integer
+		constexpr double TWO_OVER_PI = 6.36619772367581382433e-01;
+		constexpr double PIO2_1 = 1.57079632673412561417e+00; // pi/2 in three parts of 33 bits
+		constexpr double PIO2_2 = 6.07710050630396597660e-11;
+		constexpr double PIO2_3 = 2.02226624871116645580e-21;
+		constexpr double PIO2 = 1.57079632679489655800e+00;
+
+		constexpr double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03, S3 = -1.98412698298579493134e-04,
+			S4 = 2.75573137070700676789e-06, S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+		constexpr double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03, C3 = 2.48015872894767294178e-05,
+			C4 = -2.75573143513906633035e-07, C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+		constexpr double P0 = 1.66666666666666657415e-01, P1 = -3.25565818622400915405e-01, P2 = 2.01212532134862925881e-01,
+			P3 = -4.00555345006794114027e-02, P4 = 7.91534994289814532176e-04, P5 = 3.47933107596021167570e-05;
+		constexpr double Q1 = -2.40339491173441421878e+00, Q2 = 2.02094576023350569471e+00, Q3 = -6.88283971605453293030e-01,
+			Q4 = 7.70381505559019352791e-02;
+
+		constexpr std::uint64_t RSQRT_MAGIC = 0x5fe6eb50c7b537a9ull;
+
+		// 1/sqrt(x) to within 3.5e-2, for positive normal x
+		inline double rsqrt_estimate(double x) noexcept{
+			std::uint64_t i;
+			std::memcpy(&i, &x, sizeof(i));
+			i = RSQRT_MAGIC - (i >> 1);
+			double y;
+			std::memcpy(&y, &i, sizeof(y));
+			return y;
+		}
+
+		inline double sin_polynomial(double r, double z) noexcept{ return r + (r*z)*(S1 + z*(S2 + z*(S3 + z*(S4 + z*(S5 + z*S6))))); }
+		inline double cos_polynomial(double z) noexcept{ return (1.0 - 0.5*z) + (z*z)*(C1 + z*(C2 + z*(C3 + z*(C4 + z*(C5 + z*C6))))); }
+		inline double asin_ratio(double z) noexcept{
+			return (z*(P0 + z*(P1 + z*(P2 + z*(P3 + z*(P4 + z*P5))))))/(1.0 + z*(Q1 + z*(Q2 + z*(Q3 + z*Q4))));
+		}
+	}
+
+	bool supported(Kernel k) noexcept; // by the processor and the compiler
+	Kernel best(void) noexcept; // the fastest supported kernel
+	void select(Kernel k); // for the whole program, throws if k is not supported
+	inline Kernel selected(void) noexcept{ return detail::selection.load(std::memory_order_relaxed); }
+	inline bool is_fast(void) noexcept{ return selected() != Kernel::LIBM; }
+
+	const char* name(Kernel k) noexcept;
+	Kernel find(const std::string &name); // "libm", "scalar", "avx2", "avx512", or "fast" for best()
+
+	// the approximations, which every kernel but LIBM computes
+	namespace approx{
+		inline double rsqrt(double x) noexcept{
+			if(not (x >= DBL_MIN and x <= DBL_MAX)) return 1.0/std::sqrt(x); // zero, subnormal, negative, infinite or not a number
+			const double h(0.5*x);
+			double y(detail::rsqrt_estimate(x));
+			for(int k(0); k < 4; ++k) y = y*(1.5 - (h*y)*y); // the relative error e becomes 1.5e^2
+			return y;
+		}
+
+		inline double inverse_cube(double x) noexcept{
+			const double y(rsqrt(x));
+			return (y*y)*y;
+		}
+
+		inline void sincos(double x, double &s, double &c) noexcept{
+			if(not (std::abs(x) <= SINCOS_RANGE)){
+				s = std::sin(x);
+				c = std::cos(x);
+				return;
+			}
+			const double t(x*detail::TWO_OVER_PI + detail::SHIFTER);
+			const double n(t - detail::SHIFTER);
+			const double r(((x - n*detail::PIO2_1) - n*detail::PIO2_2) - n*detail::PIO2_3);
+			const double z(r*r);
+			const double sr(detail::sin_polynomial(r, z));
+			const double cr(detail::cos_polynomial(z));
+
+			std::uint64_t q;
+			std::memcpy(&q, &t, sizeof(q)); // the low bits of n
+			switch(q & 3){
+				case 0: s = sr; c = cr; break;
+				case 1: s = cr; c = -sr; break;
+				case 2: s = -sr; c = -cr; break;
+				default: s = -cr; c = sr; break;
+			}
+		}
+
+		inline double sin(double x) noexcept{
+			double s, c;
+			sincos(x, s, c);
+			return s;
+		}
+
+		inline double asin(double x) noexcept{
+			const double a(std::abs(x));
+			if(a <= 0.5) return x + x*detail::asin_ratio(x*x);
+			const double z(0.5*(1.0 - a)); // not a number beyond 1
+			const double s(std::sqrt(z));
+			return std::copysign(detail::PIO2 - 2.0*(s + s*detail::asin_ratio(z)), x);
+		}
+	}
+
+	// with the selected kernel
+	inline double rsqrt(double x) noexcept{ return is_fast() ? approx::rsqrt(x) : 1.0/std::sqrt(x); }
+	inline double sin(double x) noexcept{ return is_fast() ? approx::sin(x) : std::sin(x); }
+	inline double asin(double x) noexcept{ return is_fast() ? approx::asin(x) : std::asin(x); }
+
+	// n values at once with kernel k (the scalar approximations if k is not supported)
+	void inverse_cube(const double* x, double* y, size_t n, Kernel k = selected()) noexcept;
+	void sincos(const double* x, double* s, double* c, size_t n, Kernel k = selected()) noexcept;
+	void asin(const double* x, double* y, size_t n, Kernel k = selected()) noexcept;
+}
@@ -2,78 +2,197 @@
 
 #include <array> // for Vector3D::getCoords()
 #include <random> // for distributions
-#include <functional>
+#include <type_traits> // for common_type
+#include <cmath>
+#include <iostream>
+
+#include "../misc/exceptions.h"
+#include "../misc/constants.h"
 
 #include "../color/rgb.h"
 #include "../general/drawable.h"
 #include "../general/canvas.h"
 
-class Vector3D{
+// Vector3DT<T> holds its coordinates in the scalar type T: Vector3D (double) is used throughout, and Vector3Df (float)
+// by the computations that may run in single precision (see Precision).
+// Everything is defined here, so that the vector algebra of the hot loops is inlined, and the algebra is constexpr.
+template<typename T>
+class Vector3DT{
+	template<typename U> friend class Vector3DT;
+
 	private:
-		double x;
-		double y;
-		double z;
+		T c[3]; // x, y and z
 	public:
 		// Constructor, getters, setters:
-		explicit Vector3D(double a, double b, double c = 0) : x(a), y(b), z(c){}
-		Vector3D(void) : Vector3D(0,0,0){}
+		constexpr explicit Vector3DT(T a, T b, T d = 0) noexcept : c{a, b, d}{}
+		constexpr Vector3DT(void) noexcept : c{0, 0, 0}{}
+		template<typename U> constexpr explicit Vector3DT(const Vector3DT<U> &v) noexcept : c{T(v.c[0]), T(v.c[1]), T(v.c[2])}{} // conversion between precisions
 
-		std::array<double,3> getCoords(void) const; // return coords in an array
-		double operator[](int i) const; // overload of index operator allows easy access to individual coordinates
+		std::array<T,3> getCoords(void) const noexcept{ return {{c[0], c[1], c[2]}}; } // return coords in an array
+		constexpr T operator[](int i) const noexcept{ return c[i]; } // i-th coordinate, for i = 0, 1 or 2 (unchecked)
+		T at(int i) const{ if(i < 0 or i > 2) throw excptn::BAD_VECTOR3D_ACCESS; return c[i]; } // same, checked
 
 		// Algebraic operators:
-		Vector3D operator+(Vector3D v) const; // vector addition
-		Vector3D& operator+=(const Vector3D &); // for optimization purposes
+		constexpr Vector3DT operator+(const Vector3DT &v) const noexcept{ return Vector3DT(c[0] + v.c[0], c[1] + v.c[1], c[2] + v.c[2]); } // vector addition
+		Vector3DT& operator+=(const Vector3DT &v) noexcept{ c[0] += v.c[0]; c[1] += v.c[1]; c[2] += v.c[2]; return *this; }
 
-		Vector3D operator-(const Vector3D &v) const; // vector subtraction
-		Vector3D& operator-=(const Vector3D &v);
-		Vector3D operator-(void) const; // additive inverse
+		constexpr Vector3DT operator-(const Vector3DT &v) const noexcept{ return Vector3DT(c[0] - v.c[0], c[1] - v.c[1], c[2] - v.c[2]); } // vector subtraction
+		Vector3DT& operator-=(const Vector3DT &v) noexcept{ c[0] -= v.c[0]; c[1] -= v.c[1]; c[2] -= v.c[2]; return *this; }
+		constexpr Vector3DT operator-(void) const noexcept{ return Vector3DT(-c[0], -c[1], -c[2]); } // additive inverse
 
-		Vector3D operator*(const double &lambda) const; // scalar multiplication. note that the scalar comes AFTER the vector (i.e. u*lambda). we define lambda*u as a non-member operator
-		Vector3D& operator*=(const double &lambda);
+		// scalar multiplication. note that the scalar comes AFTER the vector (i.e. u*lambda). we define lambda*u as a non-member operator
+		constexpr Vector3DT operator*(const T &lambda) const noexcept{ return Vector3DT(c[0]*lambda, c[1]*lambda, c[2]*lambda); }
+		Vector3DT& operator*=(const T &lambda) noexcept{ c[0] *= lambda; c[1] *= lambda; c[2] *= lambda; return *this; }
 
-		double operator|(const Vector3D &v) const; // dot product
-		Vector3D operator^(const Vector3D &v) const; // cross product
+		constexpr T operator|(const Vector3DT &v) const noexcept{ return c[0]*v.c[0] + c[1]*v.c[1] + c[2]*v.c[2]; } // dot product
+		constexpr Vector3DT operator^(const Vector3DT &v) const noexcept{ // cross product
+			return Vector3DT(c[1]*v.c[2] - c[2]*v.c[1], v.c[0]*c[2] - v.c[2]*c[0], c[0]*v.c[1] - c[1]*v.c[0]);
+		}
 
 		// Zero-test and boolean operators
-		bool is_zero(void) const; // returns true iff square of norm is "zero" i.e. less than a small constant
-		bool operator ==(const Vector3D &v) const; // returns (*this - v).is_zero()
-		bool operator !=(const Vector3D &v) const; // returns the logical negation of ==
+		// returns true iff square of norm is "zero" i.e. less than a small constant
+		constexpr bool is_zero(void) const noexcept{
+			return not (c[0]*c[0] >= simcst::ZERO_VECTOR_NORM2) and not (c[1]*c[1] >= simcst::ZERO_VECTOR_NORM2) and not (c[2]*c[2] >= simcst::ZERO_VECTOR_NORM2);
+		}
+		constexpr bool operator ==(const Vector3DT &v) const noexcept{ return (*this - v).is_zero(); }
+		constexpr bool operator !=(const Vector3DT &v) const noexcept{ return not (*this == v); }
 
 		// Norm and distance
-		double norm2(void) const; // square of Euclidian norm
-		double norm(void) const; // Euclidian norm
-		static double distance2(const Vector3D& u, const Vector3D& v);
-		static double distance(const Vector3D& u, const Vector3D& v);
+		constexpr T norm2(void) const noexcept{ return (*this)|(*this); } // square of Euclidian norm
+		T norm(void) const noexcept{ return std::sqrt(norm2()); } // Euclidian norm
+		static constexpr T distance2(const Vector3DT& u, const Vector3DT& v) noexcept{ return (u - v).norm2(); }
+		static T distance(const Vector3DT& u, const Vector3DT& v) noexcept{ return (u - v).norm(); }
 
 		// Various
-		Vector3D normalize(void); // divides by the norm to get a unit vector and returns the result. undefined behavior if norm() == 0.0
-		Vector3D unitary(void) const; // same as normalize(), but returns the result
-		Vector3D rotated(Vector3D u, double alpha) const; // returns result of rotating around a given axis by a given angle angle
-		Vector3D orthogonal(void) const; // returns a unitary orthogonal vector
-		static double mixed_prod(const Vector3D &u, const Vector3D &v, const Vector3D &w){ return u|(v^w); }
-		static bool are_orthogonal(const Vector3D &u, const Vector3D &v);
-
-		std::ostream& print(std::ostream& output) const;
+		Vector3DT normalize(void); // divides by the norm to get a unit vector and returns the result. throws if the vector is zero
+		Vector3DT unitary(void) const{ Vector3DT copy(*this); return copy.normalize(); } // same as normalize(), but returns the result
+		Vector3DT unitary_or(const Vector3DT &fallback) const noexcept{ return is_zero() ? fallback : (*this)*(T(1.0)/norm()); } // same as unitary(), or fallback for a zero vector
+		Vector3DT rotated(Vector3DT u, T alpha) const noexcept; // returns result of rotating around a given axis by a given angle angle (none if the axis is zero)
+		Vector3DT orthogonal(void) const noexcept; // returns a unitary orthogonal vector
+		static constexpr T mixed_prod(const Vector3DT &u, const Vector3DT &v, const Vector3DT &w) noexcept{ return u|(v^w); }
+		static bool are_orthogonal(const Vector3DT &u, const Vector3DT &v) noexcept{ return std::abs(u|v) <= simcst::ZERO_VECTOR_NORM2; }
+
+		std::ostream& print(std::ostream& output) const{ output << c[0] << "  " << c[1] << "  " << c[2]; return output; }
 };
 
+template<typename T>
+inline Vector3DT<T> Vector3DT<T>::normalize(void){
+	if(is_zero()) throw excptn::ZERO_VECTOR_UNITARY;
+	return (*this) *= T(1.0)/norm();
+}
+
+template<typename T>
+inline Vector3DT<T> Vector3DT<T>::orthogonal(void) const noexcept{
+	// the candidates all have a unit coordinate, hence never fall back
+	if(c[0]*c[0] > simcst::ZERO_VECTOR_NORM2) return Vector3DT(-c[1]/c[0], 1.0, 0.0).unitary_or(Vector3DT(0, 1, 0));
+	if(c[1]*c[1] > simcst::ZERO_VECTOR_NORM2) return Vector3DT(1.0, -c[0]/c[1], 0.0).unitary_or(Vector3DT(1, 0, 0));
+	if(c[2]*c[2] > simcst::ZERO_VECTOR_NORM2) return Vector3DT(1.0, 0.0, -c[0]/c[2]).unitary_or(Vector3DT(1, 0, 0));
+	return Vector3DT(1, 0, 0); // (is zero vector)
+}
+
+template<typename T>
+inline Vector3DT<T> Vector3DT<T>::rotated(Vector3DT u, T alpha) const noexcept{
+	if(u.is_zero()) return *this; // nothing happens
+	u *= T(1.0)/u.norm();
+	return (std::cos(alpha)*(*this)) + (T(1.0)-std::cos(alpha))*((*this)|u)*u + std::sin(alpha)*(u^(*this));
+}
+
+typedef Vector3DT<double> Vector3D;
+typedef Vector3DT<float> Vector3Df;
+
+enum class Precision : unsigned char { DOUBLE, SINGLE }; // scalar type of a computation, see e.g. Accelerator::setSpace_charge_precision
+
+// scalar multiplication, but here the scalar is written before (T is deduced from the vector only, so that e.g. 2*u compiles)
+template<typename T> constexpr Vector3DT<T> operator*(const typename std::common_type<T>::type &lambda, const Vector3DT<T> &u) noexcept{ return u * lambda; }
+template<typename T> std::ostream& operator<<(std::ostream& output, const Vector3DT<T> &v){ return v.print(output); } // prints to output (e.g. std::cout or std::ofstream)
+
+// W vectors stored coordinate by coordinate, for kernels that process W particles at once: the loops over the lanes
+// below have no dependency between iterations and compile to packed instructions (e.g. W = 4 doubles with AVX2),
+// as in the space charge computed with the approximations of fastmath (see ForceBatch in physics/node.cpp)
+template<typename T, size_t W>
+struct Vector3DBatch{
+	typedef std::array<T,W> Scalars;
+
+	alignas(sizeof(T)*W <= 64 ? sizeof(T)*W : 64) T x[W];
+	alignas(sizeof(T)*W <= 64 ? sizeof(T)*W : 64) T y[W];
+	alignas(sizeof(T)*W <= 64 ? sizeof(T)*W : 64) T z[W];
+
+	static constexpr size_t width(void){ return W; }
+
+	static Vector3DBatch broadcast(const Vector3DT<T> &v){
+		Vector3DBatch b;
+		for(size_t i(0); i < W; ++i){ b.x[i] = v[0]; b.y[i] = v[1]; b.z[i] = v[2]; }
+		return b;
+	}
+
+	void set(size_t i, const Vector3DT<T> &v){ x[i] = v[0]; y[i] = v[1]; z[i] = v[2]; }
+	Vector3DT<T> get(size_t i) const{ return Vector3DT<T>(x[i], y[i], z[i]); }
+
+	Vector3DBatch& operator+=(const Vector3DBatch &b){
+		for(size_t i(0); i < W; ++i){ x[i] += b.x[i]; y[i] += b.y[i]; z[i] += b.z[i]; }
+		return *this;
+	}
+	Vector3DBatch& operator-=(const Vector3DBatch &b){
+		for(size_t i(0); i < W; ++i){ x[i] -= b.x[i]; y[i] -= b.y[i]; z[i] -= b.z[i]; }
+		return *this;
+	}
+	Vector3DBatch& operator*=(const T &lambda){
+		for(size_t i(0); i < W; ++i){ x[i] *= lambda; y[i] *= lambda; z[i] *= lambda; }
+		return *this;
+	}
+	Vector3DBatch& operator*=(const Scalars &lambda){ // lane by lane
+		for(size_t i(0); i < W; ++i){ x[i] *= lambda[i]; y[i] *= lambda[i]; z[i] *= lambda[i]; }
+		return *this;
+	}
+
+	Vector3DBatch operator+(const Vector3DBatch &b) const{ Vector3DBatch r(*this); return r += b; }
+	Vector3DBatch operator-(const Vector3DBatch &b) const{ Vector3DBatch r(*this); return r -= b; }
+	Vector3DBatch operator*(const T &lambda) const{ Vector3DBatch r(*this); return r *= lambda; }
+	Vector3DBatch operator*(const Scalars &lambda) const{ Vector3DBatch r(*this); return r *= lambda; }
+
+	Scalars operator|(const Vector3DBatch &b) const{ // dot products
+		Scalars r;
+		for(size_t i(0); i < W; ++i) r[i] = x[i]*b.x[i] + y[i]*b.y[i] + z[i]*b.z[i];
+		return r;
+	}
+	Vector3DBatch operator^(const Vector3DBatch &b) const{ // cross products
+		Vector3DBatch r;
+		for(size_t i(0); i < W; ++i){
+			r.x[i] = y[i]*b.z[i] - z[i]*b.y[i];
+			r.y[i] = b.x[i]*z[i] - b.z[i]*x[i];
+			r.z[i] = x[i]*b.y[i] - y[i]*b.x[i];
+		}
+		return r;
+	}
+	Scalars norm2(void) const{ return (*this)|(*this); }
+};
+
+typedef std::mt19937_64 RandomEngine; // seedable, so that runs can be reproduced
+
 class RandomVector3D{
 	// this class allows the creation of Vector3D-type random distributions around the origin using real distributions from the standard library
+	// (held by value rather than behind a std::function, so that neither drawing nor copying allocates)
+	protected:
+		enum Shape : unsigned char { UNIFORM, GAUSSIAN };
+
+		RandomVector3D(Shape my_shape, double spread) :
+			shape(my_shape),
+			uniform(my_shape == UNIFORM ? -spread : 0.0, my_shape == UNIFORM ? spread : 1.0),
+			normal(0.0, my_shape == GAUSSIAN ? spread : 1.0)
+		{}
 	private:
-		std::function<double(std::random_device&)> distr;
+		Shape shape;
+		std::uniform_real_distribution<double> uniform;
+		std::normal_distribution<double> normal;
 	public:
-		RandomVector3D(const std::function<double(std::random_device&)> &my_distr) :
-			distr(my_distr)
-		{}
-
-		Vector3D operator()(std::random_device &gen); // overloaded call operator
+		Vector3D operator()(RandomEngine &gen); // overloaded call operator
 };
 
 class UniformVector3D : public RandomVector3D{
 	// Uniformly-distributed Vector3D along 3 axes
 	public:
 		explicit UniformVector3D(double my_r) :
-			RandomVector3D(std::uniform_real_distribution<double>(-my_r, my_r))
+			RandomVector3D(UNIFORM, my_r)
 		{}
 };
 
@@ -81,17 +200,14 @@ class GaussianVector3D : public RandomVector3D{
 	// Gaussian-distributed Vector3D along 3 axes
 	public:
 		explicit GaussianVector3D(double my_sigma) :
-			RandomVector3D(std::normal_distribution<double>(0.0, my_sigma))
+			RandomVector3D(GAUSSIAN, my_sigma)
 		{}
 };
 
-Vector3D operator*(const double &, const Vector3D&); // scalar multiplication, but here the scalar is written before
-std::ostream& operator<<(std::ostream& output, Vector3D const& v); // prints to output (e.g. std::cout or std::ofstream)
-
 namespace vctr{
 	// some useful vectors for general use
-	const Vector3D ZERO_VECTOR(0,0,0);
-	const Vector3D X_VECTOR(1,0,0);
-	const Vector3D Y_VECTOR(0,1,0);
-	const Vector3D Z_VECTOR(0,0,1);
+	constexpr Vector3D ZERO_VECTOR(0,0,0);
+	constexpr Vector3D X_VECTOR(1,0,0);
+	constexpr Vector3D Y_VECTOR(0,1,0);
+	constexpr Vector3D Z_VECTOR(0,0,1);
 }
@@ -7,6 +7,10 @@ INCLUDEPATH += \
 
 SOURCES += \
 	vector3d.cpp \
+	fast_math.cpp \
 
 HEADERS += \
 	vector3d.h \
+	fast_math.h \
+
+include(../cernjunior.pri)